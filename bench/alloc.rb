@@ -0,0 +1,73 @@
+#*************************************************************************#
+#                                                                         #
+# alloc.rb - per-call latency of allocating operations on small operands  #
+# Copyright (C) 2015 Paolo Bosetti                                        #
+# paolo[dot]bosetti[at]unitn.it                                           #
+# Department of Industrial Engineering, University of Trento              #
+#                                                                         #
+# This library is free software.  You can redistribute it and/or          #
+# modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        #
+#                                                                         #
+# This library is distributed in the hope that it will be useful,         #
+# but WITHOUT ANY WARRANTY; without even the implied warranty of          #
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           #
+# Artistic License 2.0 for more details.                                  #
+#                                                                         #
+# See the file LICENSE                                                    #
+#                                                                         #
+#*************************************************************************#
+# Run with: tmp/mruby/bin/mruby bench/alloc.rb
+# Compare the output against the same script run on an older checkout.
+
+N = 200_000
+
+def bench(label, n = N)
+  t0 = Time.now
+  n.times { yield }
+  dt = Time.now - t0
+  puts "%-28s %10.3f us/call" % [label, dt * 1E6 / n]
+end
+
+[3, 6].each do |n|
+  puts "--- size #{n} ---"
+  v = Vector.new(n).rnd_fill
+  m = Matrix.new(n, n).rnd_fill
+  m.add!(Matrix.new(n, n).identity.mul!(n))
+  tall = Matrix.new(n + 2, n).rnd_fill
+  b = Vector.new(n + 2).rnd_fill
+  lu = m.lu
+  qr = tall.qr
+  bench("Vector#dup") { v.dup }
+  bench("Vector#+") { v + v }
+  bench("Matrix#dup") { m.dup }
+  bench("Matrix#^ (Matrix)") { m ^ m }
+  bench("Matrix#^ (Vector)") { m ^ v }
+  bench("Matrix#t") { m.t }
+  bench("Matrix#row") { m.row(0) }
+  bench("LUDecomp.new") { LUDecomp.new m }
+  bench("LUDecomp#update!") { lu.update! m }
+  bench("LUDecomp#solve") { lu.solve v }
+  bench("Matrix#det (cached)") { m.det }
+  bench("QRDecomp#lssolve") { qr.lssolve b }
+end
+
+puts "--- quantiles ---"
+[100, 100_000].each do |n|
+  v = Vector.new(n).rnd_fill
+  scratch = Vector.new(n)
+  reps = [N / n, 10].max
+  bench("Vector#median #{n}", reps) { v.median }
+  bench("Vector#median scratch #{n}", reps) { v.median scratch }
+  bench("Vector#quantiles x3 #{n}", reps) { v.quantiles [0.05, 0.5, 0.95], scratch }
+end
+
+puts "--- moving median ---"
+[9, 101].each do |k|
+  v = Vector.new(10_000).rnd_fill
+  w = MovingWindow.new(k)
+  f = MovingWindow.new(k, stat: :median)
+  b = Buffer.new(k)
+  bench("Vector#moving_median #{k}", 10) { v.moving_median(w) }
+  bench("MovingWindow#push #{k}") { f << 0.5 }
+  bench("Buffer + median #{k}", N / k) { b << 0.5; b.to_vector.median }
+end
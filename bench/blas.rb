@@ -0,0 +1,43 @@
+#*************************************************************************#
+#                                                                         #
+# blas.rb - dgemm/dgemv throughput of the linked BLAS backend             #
+# Copyright (C) 2015 Paolo Bosetti                                        #
+# paolo[dot]bosetti[at]unitn.it                                           #
+# Department of Industrial Engineering, University of Trento              #
+#                                                                         #
+# This library is free software.  You can redistribute it and/or          #
+# modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        #
+#                                                                         #
+# This library is distributed in the hope that it will be useful,         #
+# but WITHOUT ANY WARRANTY; without even the implied warranty of          #
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           #
+# Artistic License 2.0 for more details.                                  #
+#                                                                         #
+# See the file LICENSE                                                    #
+#                                                                         #
+#*************************************************************************#
+# Run with: tmp/mruby/bin/mruby bench/blas.rb
+# Rebuild with MRUBY_GSL_BLAS=openblas (or blis, ...) and compare, e.g.:
+#   make clean; MRUBY_GSL_BLAS=openblas make bench
+
+SIZES = [8, 16, 32, 64, 128, 256, 512, 1024, 2048]
+FLOPS = 2E8 # approximate work per measurement
+
+def gflops(label, flops)
+  n = [(FLOPS / flops).to_i, 1].max
+  t0 = Time.now
+  n.times { yield }
+  dt = Time.now - t0
+  puts "%-20s %10.3f GFLOP/s" % [label, flops * n / dt / 1E9]
+end
+
+puts "backend: #{GSL.blas_backend}, threads: #{GSL.blas_threads}"
+SIZES.each do |n|
+  a = Matrix.new(n, n).rnd_fill
+  b = Matrix.new(n, n).rnd_fill
+  c = Matrix.new(n, n)
+  x = Vector.new(n).rnd_fill
+  y = Vector.new(n)
+  gflops("dgemm #{n}", 2.0 * n * n * n) { c.gemm!(1, a, b, 0) }
+  gflops("dgemv #{n}", 2.0 * n * n) { y.gemv!(1, a, x, 0) }
+end
@@ -0,0 +1,78 @@
+#*************************************************************************#
+#                                                                         #
+# convert.rb - Array <-> Vector/Matrix conversions                        #
+# Copyright (C) 2015 Paolo Bosetti                                        #
+# paolo[dot]bosetti[at]unitn.it                                           #
+# Department of Industrial Engineering, University of Trento              #
+#                                                                         #
+# This library is free software.  You can redistribute it and/or          #
+# modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        #
+#                                                                         #
+# This library is distributed in the hope that it will be useful,         #
+# but WITHOUT ANY WARRANTY; without even the implied warranty of          #
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           #
+# Artistic License 2.0 for more details.                                  #
+#                                                                         #
+# See the file LICENSE                                                    #
+#                                                                         #
+#*************************************************************************#
+# Run with: tmp/mruby/bin/mruby bench/convert.rb
+# Compares the native constructors and converters with the element-by-
+# element Ruby implementations they replaced.
+
+def ms(n)
+  t0 = Time.now
+  n.times { yield }
+  (Time.now - t0) * 1E3 / n
+end
+
+def compare(label, n)
+  native = ms(n) { yield true }
+  ruby = ms(n) { yield false }
+  puts "%-24s %10.3f ms %10.3f ms %8.1fx" % [label, native, ruby, ruby / native]
+end
+
+def ruby_vector(ary)
+  v = Vector.new(ary.size)
+  ary.each_with_index {|e,i| v[i] = e.to_f}
+  return v
+end
+
+def ruby_matrix(ary)
+  m = Matrix.new(ary.size, ary[0].size)
+  ary.each_with_index do |row,i|
+    row.each_with_index {|e,j| m[i,j] = e.to_f}
+  end
+  return m
+end
+
+def ruby_to_a(m)
+  rows = []
+  m.nrows.times do |i|
+    cols = []
+    m.ncols.times {|j| cols << m[i,j]}
+    rows << cols
+  end
+  return rows
+end
+
+def ruby_to_mat(v)
+  m = Matrix.new(v.length, 1)
+  v.each_with_index {|e,i| m[i,0] = e}
+  return m
+end
+
+puts "%-24s %13s %13s %9s" % %w(operation native ruby speedup)
+[10, 100, 1000].each do |n|
+  reps = [1_000_000 / (n * n), 1].max
+  ary = Array.new(n) { |i| Array.new(n) { |j| (i * n + j).to_f } }
+  flat = ary.flatten
+  m = Matrix[*ary]
+  v = Vector[*flat[0, n]]
+  rows = Array.new(n) { |i| m.row(i) }
+  compare("Vector[] #{n}", reps * n) { |c| c ? Vector[*flat[0, n]] : ruby_vector(flat[0, n]) }
+  compare("Matrix[] #{n}x#{n}", reps) { |c| c ? Matrix[*ary] : ruby_matrix(ary) }
+  compare("Matrix.from_rows #{n}", reps) { |c| c ? Matrix.from_rows(rows) : ruby_matrix(rows.map { |r| r.to_a }) }
+  compare("Matrix#to_a #{n}x#{n}", reps) { |c| c ? m.to_a : ruby_to_a(m) }
+  compare("Vector#to_mat #{n}", reps * n) { |c| c ? v.to_mat : ruby_to_mat(v) }
+end
@@ -0,0 +1,60 @@
+#*************************************************************************#
+#                                                                         #
+# decomp.rb - GSL vs LAPACK decompositions over matrix size               #
+# Copyright (C) 2015 Paolo Bosetti                                        #
+# paolo[dot]bosetti[at]unitn.it                                           #
+# Department of Industrial Engineering, University of Trento              #
+#                                                                         #
+# This library is free software.  You can redistribute it and/or          #
+# modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        #
+#                                                                         #
+# This library is distributed in the hope that it will be useful,         #
+# but WITHOUT ANY WARRANTY; without even the implied warranty of          #
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           #
+# Artistic License 2.0 for more details.                                  #
+#                                                                         #
+# See the file LICENSE                                                    #
+#                                                                         #
+#*************************************************************************#
+# Run with: tmp/mruby/bin/mruby bench/decomp.rb
+# The crossover is the smallest size where the LAPACK column beats the GSL
+# one: use it for GSL.lapack_threshold.
+
+SIZES = [16, 32, 64, 96, 128, 192, 256, 384, 512, 1024]
+WORK = 1E9 # approximate flops per measurement
+
+def ms(flops)
+  n = [(WORK / flops).to_i, 1].max
+  t0 = Time.now
+  n.times { yield }
+  (Time.now - t0) * 1E3 / n
+end
+
+def sweep(label, flops)
+  SIZES.each do |n|
+    m = yield(n)
+    GSL.lapack_threshold = n + 1
+    gsl = ms(flops.call(n)) { m.send(label) }
+    if GSL.lapack? then
+      GSL.lapack_threshold = 0
+      lapack = ms(flops.call(n)) { m.send(label) }
+      puts "%-6s %5d %12.3f ms %12.3f ms %8.2fx" % [label, n, gsl, lapack, gsl / lapack]
+    else
+      puts "%-6s %5d %12.3f ms" % [label, n, gsl]
+    end
+  end
+end
+
+threshold = GSL.lapack_threshold
+puts "backend: #{GSL.blas_backend}, LAPACK: #{GSL.lapack?}"
+puts "%-6s %5s %15s %15s %9s" % %w(decomp size GSL LAPACK speedup)
+spd = lambda do |n|
+  a = Matrix.new(n, n).rnd_fill
+  b = Matrix.new(n, n)
+  b.gemm!(1, a, a, 0, trans_b: true)
+  b.add!(Matrix.new(n, n).identity.mul!(n))
+end
+sweep(:lu, lambda { |n| 2.0 / 3 * n ** 3 }) { |n| Matrix.new(n, n).rnd_fill }
+sweep(:qr, lambda { |n| 4.0 / 3 * n ** 3 }) { |n| Matrix.new(n, n).rnd_fill }
+sweep(:chol, lambda { |n| 1.0 / 3 * n ** 3 }, &spd)
+GSL.lapack_threshold = threshold
@@ -0,0 +1,49 @@
+#*************************************************************************#
+#                                                                         #
+# elementwise.rb - memory throughput of the elementwise math              #
+# Copyright (C) 2015 Paolo Bosetti                                        #
+# paolo[dot]bosetti[at]unitn.it                                           #
+# Department of Industrial Engineering, University of Trento              #
+#                                                                         #
+# This library is free software.  You can redistribute it and/or          #
+# modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        #
+#                                                                         #
+# This library is distributed in the hope that it will be useful,         #
+# but WITHOUT ANY WARRANTY; without even the implied warranty of          #
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           #
+# Artistic License 2.0 for more details.                                  #
+#                                                                         #
+# See the file LICENSE                                                    #
+#                                                                         #
+#*************************************************************************#
+# Run with: tmp/mruby/bin/mruby bench/elementwise.rb
+# Throughput counts the bytes read and written by each in-place op
+
+N = 1_000_000
+BYTES = 2E9 # approximate traffic per measurement
+
+def gbps(label, bytes)
+  n = [(BYTES / bytes).to_i, 1].max
+  t0 = Time.now
+  n.times { yield }
+  dt = Time.now - t0
+  puts "%-20s %10.3f GB/s" % [label, bytes * n / dt / 1E9]
+end
+
+v = Vector.new(N).rnd_fill
+w = Vector.new(N).rnd_fill
+s = Matrix.new(N / 1000, 2000).rnd_fill.submatrix(0, 0, N / 1000, 1000)
+b = 8.0 * N
+{ 'abs!' => [], 'sqrt!' => [], 'square!' => [], 'sign!' => [],
+  'sin!' => [], 'exp!' => [], 'log!' => [], 'pow!' => [2.5],
+  'clamp!' => [0.25, 0.75] }.each do |op, args|
+  gbps("#{op} #{N}", 2 * b) { v.send(op, *args) }
+end
+gbps("atan2! #{N}", 3 * b) { v.atan2!(w) }
+gbps("hypot! #{N}", 3 * b) { v.hypot!(w) }
+gbps("fma! #{N}", 4 * b) { v.fma!(w, w) }
+gbps("fma! scalars #{N}", 2 * b) { v.fma!(0.5, 0.25) }
+gbps("sqrt! view #{N}", 2 * b) { s.sqrt! }
+m = Matrix.new(N / 1000, 1000).rnd_fill
+gbps("sqrt! matrix #{N}", 2 * b) { m.sqrt! }
+gbps("map! matrix #{N}", 2 * b) { m.map! { |e| Math.sqrt(e) } }
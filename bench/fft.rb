@@ -0,0 +1,44 @@
+#*************************************************************************#
+#                                                                         #
+# fft.rb - transforms and convolutions per second, by length              #
+# Copyright (C) 2015 Paolo Bosetti                                        #
+# paolo[dot]bosetti[at]unitn.it                                           #
+# Department of Industrial Engineering, University of Trento              #
+#                                                                         #
+# This library is free software.  You can redistribute it and/or          #
+# modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        #
+#                                                                         #
+# This library is distributed in the hope that it will be useful,         #
+# but WITHOUT ANY WARRANTY; without even the implied warranty of          #
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           #
+# Artistic License 2.0 for more details.                                  #
+#                                                                         #
+# See the file LICENSE                                                    #
+#                                                                         #
+#*************************************************************************#
+# Run with: tmp/mruby/bin/mruby bench/fft.rb
+
+def bench(label, n)
+  t0 = Time.now
+  n.times { yield }
+  dt = Time.now - t0
+  puts "%-32s %10.3f us/call" % [label, dt * 1E6 / n]
+end
+
+[1000, 1024, 65536].each do |n|
+  v = Vector.new(n).rnd_fill
+  hc = Vector.new(n)
+  fft = FFT.new(n)
+  reps = [1_000_000 / n, 10].max
+  bench("FFT.new #{n}", reps) { FFT.new(n) }
+  bench("FFT#forward_into #{n}", reps) { fft.forward_into(v, hc) }
+  bench("FFT#inverse_into #{n}", reps) { fft.inverse_into(hc, hc) }
+  bench("FFT#power_spectrum #{n}", reps) { fft.power_spectrum(v) }
+end
+
+x = Vector.new(10_000).rnd_fill
+[16, 64, 256, 1024].each do |m|
+  k = Vector.new(m).rnd_fill
+  bench("convolve direct 10000 x #{m}", 20) { x.convolve(k, method: :direct) }
+  bench("convolve fft 10000 x #{m}", 20) { x.convolve(k, method: :fft) }
+end
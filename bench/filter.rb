@@ -0,0 +1,44 @@
+#*************************************************************************#
+#                                                                         #
+# filter.rb - samples per second of Filter on blocks and single samples   #
+# Copyright (C) 2015 Paolo Bosetti                                        #
+# paolo[dot]bosetti[at]unitn.it                                           #
+# Department of Industrial Engineering, University of Trento              #
+#                                                                         #
+# This library is free software.  You can redistribute it and/or          #
+# modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        #
+#                                                                         #
+# This library is distributed in the hope that it will be useful,         #
+# but WITHOUT ANY WARRANTY; without even the implied warranty of          #
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           #
+# Artistic License 2.0 for more details.                                  #
+#                                                                         #
+# See the file LICENSE                                                    #
+#                                                                         #
+#*************************************************************************#
+# Run with: tmp/mruby/bin/mruby bench/filter.rb
+
+N = 100_000
+SAMPLES = 2E7 # approximate samples per measurement
+
+def msps(label, n)
+  reps = [(SAMPLES / n).to_i, 1].max
+  t0 = Time.now
+  reps.times { yield }
+  dt = Time.now - t0
+  puts "%-28s %10.3f Msamples/s" % [label, n * reps / dt / 1E6]
+end
+
+v = Vector.new(N).rnd_fill
+[4, 32].each do |n|
+  fir = Filter.new(Vector.new(n).all(1.0 / n))
+  msps("FIR #{n} taps filter!", N) { fir.filter!(v) }
+end
+[1, 4].each do |n|
+  sos = Matrix.new(n, 6)
+  n.times { |i| sos.set_row(i, Vector[0.2, 0.4, 0.2, 1, -0.4, 0.2]) }
+  iir = Filter.new(sos: sos)
+  msps("SOS #{n} sections filter!", N) { iir.filter!(v) }
+  msps("SOS #{n} sections filtfilt", N) { iir.filtfilt(v) }
+  msps("SOS #{n} sections step", 1) { iir.step(0.5) }
+end
@@ -0,0 +1,40 @@
+#*************************************************************************#
+#                                                                         #
+# reduce.rb - throughput of the Matrix axis reductions                    #
+# Copyright (C) 2015 Paolo Bosetti                                        #
+# paolo[dot]bosetti[at]unitn.it                                           #
+# Department of Industrial Engineering, University of Trento              #
+#                                                                         #
+# This library is free software.  You can redistribute it and/or          #
+# modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        #
+#                                                                         #
+# This library is distributed in the hope that it will be useful,         #
+# but WITHOUT ANY WARRANTY; without even the implied warranty of          #
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           #
+# Artistic License 2.0 for more details.                                  #
+#                                                                         #
+# See the file LICENSE                                                    #
+#                                                                         #
+#*************************************************************************#
+# Run with: tmp/mruby/bin/mruby bench/reduce.rb
+
+BYTES = 2E9 # approximate traffic per measurement
+
+def gbps(label, bytes)
+  n = [(BYTES / bytes).to_i, 1].max
+  t0 = Time.now
+  n.times { yield }
+  dt = Time.now - t0
+  puts "%-28s %10.3f GB/s" % [label, bytes * n / dt / 1E9]
+end
+
+[[1000, 1000], [100, 10000], [10000, 100]].each do |r, c|
+  m = Matrix.new(r, c).rnd_fill
+  b = 8.0 * r * c
+  gbps("sum axis: 0 #{r}x#{c}", b) { m.sum(axis: 0) }
+  gbps("sum axis: 1 #{r}x#{c}", b) { m.sum(axis: 1) }
+  gbps("variance axis: 0 #{r}x#{c}", 2 * b) { m.variance(axis: 0) }
+  gbps("norm axis: 1 #{r}x#{c}", b) { m.norm(axis: 1) }
+  gbps("max axis: 0 #{r}x#{c}", b) { m.max(axis: 0) }
+  gbps("each_col mean #{r}x#{c}", b) { m.each_col { |v, j| v.mean } }
+end
@@ -0,0 +1,41 @@
+#*************************************************************************#
+#                                                                         #
+# rng.rb - samples per second of the RNG bulk fills                       #
+# Copyright (C) 2015 Paolo Bosetti                                        #
+# paolo[dot]bosetti[at]unitn.it                                           #
+# Department of Industrial Engineering, University of Trento              #
+#                                                                         #
+# This library is free software.  You can redistribute it and/or          #
+# modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        #
+#                                                                         #
+# This library is distributed in the hope that it will be useful,         #
+# but WITHOUT ANY WARRANTY; without even the implied warranty of          #
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           #
+# Artistic License 2.0 for more details.                                  #
+#                                                                         #
+# See the file LICENSE                                                    #
+#                                                                         #
+#*************************************************************************#
+# Run with: tmp/mruby/bin/mruby bench/rng.rb
+
+N = 1_000_000
+SAMPLES = 2E7 # approximate draws per measurement
+
+def msps(label, n)
+  reps = [(SAMPLES / n).to_i, 1].max
+  t0 = Time.now
+  reps.times { yield }
+  dt = Time.now - t0
+  puts "%-28s %10.3f Msamples/s" % [label, n * reps / dt / 1E6]
+end
+
+v = Vector.new(N)
+RNG.types.select { |t| %w|mt19937 taus2 ranlxd2 gfsr4|.include? t }.each do |t|
+  msps("uniform! #{t}", N) { RNG.new(type: t).uniform!(v) }
+end
+rng = RNG.new
+msps("gaussian!", N) { rng.gaussian!(v) }
+msps("exponential!", N) { rng.exponential!(v) }
+msps("poisson! mu = 3", N) { rng.poisson!(v, 3) }
+msps("rnd_fill", N) { v.rnd_fill }
+msps("rnd_fill 10 elements", 10) { Vector.new(10).rnd_fill }
@@ -1,6 +1,6 @@
 #*************************************************************************#
 #                                                                         #
-# buffer.rb - Circular buffer class for mruby                             #
+# complex.rb - ComplexVector and ComplexMatrix classes for mruby          #
 # Copyright (C) 2015 Paolo Bosetti                                        #
 # paolo[dot]bosetti[at]unitn.it                                           #
 # Department of Industrial Engineering, University of Trento              #
@@ -17,31 +17,18 @@
 #                                                                         #
 #*************************************************************************#
 
-class Buffer < Vector
-  attr_reader :head
-  
-  def initialize(args)
-    super args
-    @head = 0
+class ComplexVector
+  def inspect
+    "CV#{self.to_a}"
   end
-  
-  def <<(v)
-    raise ArgumentError unless v.respond_to? :to_f
-    self[@head] = v.to_f
-    @head += 1
-    @head = 0 if @head >= self.size
-    return v
-  end
-  
-  def [](i)
-    i += @head
-    i -= self.size if i >= self.size
-    i += self.size if i < 0
-    super i
+end
+
+class ComplexMatrix
+  def size
+    [self.nrows, self.ncols]
   end
-  
-  def each
-    0.upto(self.size-1) {|i| yield self[i]}
+
+  def inspect
+    "CM#{self.to_a}"
   end
-  
-end
\ No newline at end of file
+end
@@ -20,97 +20,35 @@
 class Matrix
   include Enumerable
   include Comparable
-  attr_reader :ncols, :nrows
-  attr_accessor :format
+  FORMAT = "%10.3f"
+  attr_writer :format
   
   alias mmul ^
   
-  def self.[](*ary)
-    raise ArgumentError unless ary.kind_of? Array
-    m = Matrix.new(ary.size, ary[0].size)
-    ary.each_with_index do |row,i|
-      row.each_with_index {|e,j| m[i,j] = e.to_f}
-    end
-    return m
-  end
-  
-  def +(o); return self.dup.add! o; end
-  def -(o); return self.dup.sub! o; end
-  def *(o); return self.dup.mul! o; end
-  def /(o); return self.dup.div! o; end
-  
-  def to_a
-    rows = []
-    cols = []
-    @nrows.times do |i|
-      cols = []
-      @ncols.times do |j|
-        cols << self[i,j]
-      end
-      rows << cols
-    end
-    return rows
-  end
+  def format; return @format || FORMAT; end
   
   def <=>(other)
-    (@nrows * @ncols) <=> (other.rows * other.cols)
+    (self.nrows * self.ncols) <=> (other.nrows * other.ncols)
   end
   
   def size
-    [@nrows, @ncols]
-  end
-  
-  def each
-    raise ArgumentError, "Need a block" unless block_given?
-    @nrows.times do |i|
-      @ncols.times do |j|
-        yield self[i,j]
-      end
-    end
-  end
-  
-  def each_with_indexes
-    raise ArgumentError, "Need a block" unless block_given?
-    @nrows.times do |i|
-      @ncols.times do |j|
-        yield self[i,j], i, j
-      end
-    end
-  end
-  
-  def map!
-    raise ArgumentError, "Need a block" unless block_given?
-    @nrows.times do |i|
-      @ncols.times do |j|
-        self[i,j] = yield self[i,j]
-      end
-    end
-    return self
-  end
-  
-  def each_col
-    raise ArgumentError, "Need a block" unless block_given?
-    @ncols.times do |j|
-      yield self.col(j), j
-    end
-  end
-  
-  def each_row
-    raise ArgumentError, "Need a block" unless block_given?
-    @nrows.times do |i|
-      yield self.row(i), i
-    end
+    [self.nrows, self.ncols]
   end
   
   def lu; return LUDecomp.new self; end
   def qr; return QRDecomp.new self; end
+  def chol; return CholeskyDecomp.new self; end
   
   def det
-    return LUDecomp.new(self).det
+    return cached_lu.det
   end
   
   def inv
-    return LUDecomp.new(self).inv
+    return cached_lu.inv
+  end
+  
+  def solve(b)
+    return cached_lu.solve(b)
   end
   
   def inspect
@@ -119,11 +57,24 @@ class Matrix
   
   def to_s
     lines = []
-    mask = "⎜ #{(@format + ' ') * @ncols}⎟"
+    mask = "⎜ #{(self.format + ' ') * self.ncols}⎟"
     self.each_row do |r|
       lines << (mask % r.to_a)
     end
     return "⎡#{' ' * (lines[0].length-6)}⎤\n" + lines.join("\n") + "\n⎣#{' ' * (lines[0].length-6)}⎦\n"
   end
+  
+  private
+  # LU factorization, computed on first use and kept until the matrix is
+  # written (see mrb_gsl_touch). Views are not cached, as writes into their
+  # parent can't be tracked. Kept private: the LUDecomp is mutable, and
+  # handing it out would let callers corrupt the cache
+  def cached_lu
+    return LUDecomp.new(self) if self.kind_of? MatrixView
+    return @lu ||= LUDecomp.new(self)
+  end
 end
 
+class MatrixView < Matrix
+  attr_reader :parent
+end
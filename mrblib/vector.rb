@@ -20,44 +20,19 @@
 class Vector
   include Enumerable
   include Comparable
-  attr_reader :length
-  attr_accessor :format
-  
-  def self.[](*ary)
-    raise ArgumentError unless ary.kind_of? Array
-    v = Vector.new(ary.size)
-    ary.each_with_index {|e,i| v[i] = e.to_f}
-    return v
-  end
-  
-  alias :size :length
-  
-  def +(o); return self.dup.add! o; end
-  def -(o); return self.dup.sub! o; end
-  def *(o); return self.dup.mul! o; end
-  def /(o); return self.dup.div! o; end
+  FORMAT = "%10.3f"
+  attr_writer :format
   
   def t; return self.to_mat.t; end
   
-  def to_mat
-    m = Matrix.new(@length, 1)
-    self.each_with_index {|e,i| m[i,0] = e}
-    return m
-  end
-    
+  def format; return @format || FORMAT; end
+  
   def <=>(other)
     self.length <=> other.length
   end
   
-  def each
-    raise ArgumentError, "Need a block" unless block_given?
-    self.length.times do |i|
-      yield self[i]
-    end
-  end
-  
-  def median
-    self.quantile
+  def median(scratch = nil)
+    self.quantile(0.5, scratch)
   end
   
   def inspect
@@ -66,7 +41,7 @@ class Vector
   
   def to_s
     lines = []
-    mask = "⎜ #{@format} ⎟"
+    mask = "⎜ #{self.format} ⎟"
     self.each do |e|
       lines << (mask % e)
     end
@@ -75,3 +50,6 @@ class Vector
   
 end
 
+class VectorView < Vector
+  attr_reader :parent
+end
@@ -17,10 +17,12 @@
 /*                                                                         */
 /***************************************************************************/
 
+#include <gsl/gsl_errno.h>
 #include <gsl/gsl_linalg.h>
 #include <stdio.h>
 #include "matrix.h"
 #include "vector.h"
+#include "lapack.h"
 #include "LU_decomp.h"
 
 
@@ -32,6 +34,8 @@
 // Check it with GC.start
 void lu_decomp_destructor(mrb_state *mrb, void *p_) {
   lu_decomp_data_s *lu = (lu_decomp_data_s *)p_;
+  if (!lu)
+    return;
   gsl_matrix_free(lu->mat);
   gsl_permutation_free(lu->p);
   free(lu);
@@ -41,32 +45,26 @@ void lu_decomp_destructor(mrb_state *mrb, void *p_) {
 const struct mrb_data_type lu_decomp_data_type = {"lu_decomp_data",
                                                   lu_decomp_destructor};
 
-// Utility function for getting the struct out of the wrapping IV @data
+// Utility function for getting the struct out of self
 void mrb_lu_decomp_get_data(mrb_state *mrb, mrb_value self,
                             lu_decomp_data_s **data) {
-  mrb_value data_value;
-  data_value = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@data"));
-
-  // Loading data from data_value into p_data:
-  Data_Get_Struct(mrb, data_value, &lu_decomp_data_type, *data);
+  *data = (lu_decomp_data_s *)mrb_data_get_ptr(mrb, self, &lu_decomp_data_type);
   if (!*data)
-    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access @data");
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access decomposition data");
 }
 
-
 #pragma mark -
 #pragma mark • Initializations
 
-// Data Initializer C function (not exposed!)
-static mrb_value mrb_lu_initialize(mrb_state *mrb, mrb_value self) {
-  mrb_value data_value;            // this IV holds the data
+// Copies matrix into the decomposition data and factorizes it in place. The
+// existing buffers are reused when the size matches, so that refactoring a
+// same-sized matrix does not allocate
+static void lu_factorize(mrb_state *mrb, mrb_value self, mrb_value matrix) {
   lu_decomp_data_s *p_data = NULL; // pointer to the C struct
-  mrb_value matrix;
   gsl_matrix *p_mat = NULL;
   mrb_int n;
 
-  mrb_get_args(mrb, "o", &matrix);
-  if (!mrb_obj_is_kind_of(mrb, matrix, mrb_class_get(mrb, "Matrix"))) {
+  if (!mrb_obj_is_kind_of(mrb, matrix, mrb_gsl_matrix_class)) {
     mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a Matrix");
   }
 
@@ -76,44 +74,66 @@ static mrb_value mrb_lu_initialize(mrb_state *mrb, mrb_value self) {
   }
   n = p_mat->size1;
 
-  data_value = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@data"));
-  // if @data already exists, free its content:
-  if (!mrb_nil_p(data_value)) {
-    Data_Get_Struct(mrb, data_value, &lu_decomp_data_type, p_data);
-    free(p_data);
-  }
-  // Allocate and zero-out the data struct:
-  p_data = (lu_decomp_data_s *)malloc(sizeof(lu_decomp_data_s));
-  if (!p_data) {
-    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate @data");
-  }
-  p_data->mat = gsl_matrix_calloc(n, n);
-  p_data->p = gsl_permutation_calloc(n);
-  p_data->size = n;
-  // copy argument matrix into local object data
+  p_data = (lu_decomp_data_s *)DATA_PTR(self);
+  if (!p_data || p_data->size != (size_t)n) {
+    // if data already exists, free its content:
+    if (p_data) {
+      lu_decomp_destructor(mrb, p_data);
+    }
+    mrb_data_init(self, NULL, &lu_decomp_data_type);
+    p_data = (lu_decomp_data_s *)malloc(sizeof(lu_decomp_data_s));
+    if (!p_data) {
+      mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate decomposition data");
+    }
+    p_data->mat = gsl_matrix_alloc(n, n);
+    p_data->p = gsl_permutation_alloc(n);
+    p_data->size = n;
+    if (!p_data->mat || !p_data->p) {
+      lu_decomp_destructor(mrb, p_data);
+      mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate decomposition data");
+    }
+    // Attach struct to self:
+    mrb_data_init(self, p_data, &lu_decomp_data_type);
+  }
+  // copy argument matrix into local object data, then decompose in-place
   gsl_matrix_memcpy(p_data->mat, p_mat);
-  // invert in-place
-  gsl_linalg_LU_decomp(p_data->mat, p_data->p, &p_data->sgn);
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@size"), mrb_fixnum_value(n));
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@sign"), mrb_fixnum_value(p_data->sgn));
-
-  // Wrap struct into @data:
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@data"), // set @data
-             mrb_obj_value( // with value hold in struct
-                 Data_Wrap_Struct(mrb, mrb->object_class, &lu_decomp_data_type,
-                                  p_data)));
+  if (mrb_gsl_LU_decomp(p_data->mat, p_data->p, &p_data->sgn)) {
+    // the half-factorized data is dropped, so that self can't be used
+    // until it is updated with a valid matrix
+    lu_decomp_destructor(mrb, p_data);
+    mrb_data_init(self, NULL, &lu_decomp_data_type);
+    mrb_raise(mrb, E_LU_DECOMP_ERROR, "Decomposition failed");
+  }
+}
+
+// Data Initializer C function (not exposed!)
+static mrb_value mrb_lu_initialize(mrb_state *mrb, mrb_value self) {
+  mrb_value matrix;
+  mrb_get_args(mrb, "o", &matrix);
+  lu_factorize(mrb, self, matrix);
   return mrb_nil_value();
 }
 
+static mrb_value mrb_lu_update(mrb_state *mrb, mrb_value self) {
+  mrb_value matrix;
+  mrb_get_args(mrb, "o", &matrix);
+  lu_factorize(mrb, self, matrix);
+  return self;
+}
+
 #pragma mark -
 #pragma mark • Accessors
 
 static mrb_value mrb_lu_sgn(mrb_state *mrb, mrb_value self) {
-  return mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@sign"));
+  lu_decomp_data_s *p_data = NULL;
+  mrb_lu_decomp_get_data(mrb, self, &p_data);
+  return mrb_fixnum_value(p_data->sgn);
 }
 
 static mrb_value mrb_lu_size(mrb_state *mrb, mrb_value self) {
-  return mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@size"));
+  lu_decomp_data_s *p_data = NULL;
+  mrb_lu_decomp_get_data(mrb, self, &p_data);
+  return mrb_fixnum_value(p_data->size);
 }
 
 
@@ -121,12 +141,10 @@ static mrb_value mrb_lu_matrix(mrb_state *mrb, mrb_value self) {
   mrb_value result;
   lu_decomp_data_s *p_data = NULL;
   gsl_matrix *p_res = NULL;
-  mrb_value args[2];
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_data:
   mrb_lu_decomp_get_data(mrb, self, &p_data);
-  args[0] = args[1] = mrb_fixnum_value(p_data->size);
-  result = mrb_obj_new(mrb, mrb_class_get(mrb, "Matrix"), 2, args);
+  result = mrb_gsl_matrix_new_uninit(mrb, p_data->size, p_data->size);
   mrb_matrix_get_data(mrb, result, &p_res);
   gsl_matrix_memcpy(p_res, p_data->mat);
   return result;
@@ -156,12 +174,10 @@ static mrb_value mrb_lu_invert(mrb_state *mrb, mrb_value self) {
   mrb_value result;
   lu_decomp_data_s *p_data = NULL;
   gsl_matrix *p_res = NULL;
-  mrb_value args[2];
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_data:
   mrb_lu_decomp_get_data(mrb, self, &p_data);
-  args[0] = args[1] = mrb_fixnum_value(p_data->size);
-  result = mrb_obj_new(mrb, mrb_class_get(mrb, "Matrix"), 2, args);
+  result = mrb_gsl_matrix_new_uninit(mrb, p_data->size, p_data->size);
   mrb_matrix_get_data(mrb, result, &p_res);
   if (gsl_linalg_LU_invert(p_data->mat, p_data->p, p_res)) {
     mrb_raise(mrb, E_LU_DECOMP_ERROR, "Singular matrix");
@@ -174,35 +190,83 @@ static mrb_value mrb_lu_det(mrb_state *mrb, mrb_value self) {
   double result = 0;
   lu_decomp_data_s *p_data = NULL;
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_data:
   mrb_lu_decomp_get_data(mrb, self, &p_data);
   result = gsl_linalg_LU_det(p_data->mat, p_data->sgn);
   return mrb_float_value(mrb, result);
 }
 
+// Permutes the rows of m in place, so that row i becomes old row p[i] (as
+// gsl_permute_vector does on elements). Each cycle of the permutation is
+// walked once, swapping whole rows
+static void lu_permute_rows(const gsl_permutation *p, gsl_matrix *m) {
+  size_t i, k, pk, n = p->size;
+  for (i = 0; i < n; i++) {
+    k = p->data[i];
+    while (k > i)
+      k = p->data[k];
+    if (k < i)
+      continue;
+    // now k == i, the least index in its cycle
+    for (pk = p->data[k]; pk != i; k = pk, pk = p->data[k]) {
+      gsl_matrix_swap_rows(m, k, pk);
+    }
+  }
+}
+
+// Solves for all the columns of X at once, in place: X = P X, then two
+// blocked triangular solves with L and U, so that the factor is streamed
+// through the cache once for all the right hand sides
+static int lu_solve_matrix(const lu_decomp_data_s *p_data, gsl_matrix *X) {
+  size_t i;
+  for (i = 0; i < p_data->size; i++) {
+    if (gsl_matrix_get(p_data->mat, i, i) == 0.0)
+      return GSL_EDOM;
+  }
+  lu_permute_rows(p_data->p, X);
+  gsl_blas_dtrsm(CblasLeft, CblasLower, CblasNoTrans, CblasUnit, 1.0,
+                 p_data->mat, X);
+  gsl_blas_dtrsm(CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, 1.0,
+                 p_data->mat, X);
+  return GSL_SUCCESS;
+}
+
 // int gsl_linalg_LU_solve (const gsl_matrix * LU, const gsl_permutation * p,
 // const gsl_vector * b, gsl_vector * x)
+// With a Matrix argument, solves for each of its columns
 static mrb_value mrb_lu_solve(mrb_state *mrb, mrb_value self) {
   mrb_value result, x_vec;
   lu_decomp_data_s *p_data = NULL;
   gsl_vector *p_res = NULL, *p_x = NULL;
-  mrb_value args[1];
+  gsl_matrix *p_b = NULL, *p_resm = NULL;
 
   mrb_get_args(mrb, "o", &x_vec);
-  if (!mrb_obj_is_kind_of(mrb, x_vec, mrb_class_get(mrb, "Vector"))) {
-    mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a Vector");
-  }
-
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_data:
   mrb_lu_decomp_get_data(mrb, self, &p_data);
-  args[0] = mrb_fixnum_value(p_data->size);
+
+  if (mrb_obj_is_kind_of(mrb, x_vec, mrb_gsl_matrix_class)) {
+    mrb_matrix_get_data(mrb, x_vec, &p_b);
+    if (p_b->size1 != p_data->size) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Matrix sizes don't match");
+    }
+    result = mrb_gsl_matrix_new_uninit(mrb, p_b->size1, p_b->size2);
+    mrb_matrix_get_data(mrb, result, &p_resm);
+    gsl_matrix_memcpy(p_resm, p_b);
+    if (lu_solve_matrix(p_data, p_resm)) {
+      mrb_raise(mrb, E_LU_DECOMP_ERROR, "Singular matrix");
+    }
+    return result;
+  }
+  if (!mrb_obj_is_kind_of(mrb, x_vec, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a Vector or a Matrix");
+  }
 
   mrb_vector_get_data(mrb, x_vec, &p_x);
   if (p_x->size != p_data->size) {
     mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a square Matrix");
   }
 
-  result = mrb_obj_new(mrb, mrb_class_get(mrb, "Vector"), 1, args);
+  result = mrb_gsl_vector_new_uninit(mrb, p_data->size);
   mrb_vector_get_data(mrb, result, &p_res);
   if (gsl_linalg_LU_solve(p_data->mat, p_data->p, p_x, p_res)) {
     mrb_raise(mrb, E_LU_DECOMP_ERROR, "Singular matrix");
@@ -210,7 +274,83 @@ static mrb_value mrb_lu_solve(mrb_state *mrb, mrb_value self) {
   return result;
 }
 
+// int gsl_linalg_LU_svx (const gsl_matrix * LU, const gsl_permutation * p,
+// gsl_vector * x)
+// Overwrites the argument (a Vector or a Matrix of right hand sides) with
+// the solution
+static mrb_value mrb_lu_solve_bang(mrb_state *mrb, mrb_value self) {
+  mrb_value b;
+  lu_decomp_data_s *p_data = NULL;
+  gsl_vector *p_b = NULL;
+  gsl_matrix *p_bm = NULL;
+  int status;
+
+  mrb_get_args(mrb, "o", &b);
+  mrb_lu_decomp_get_data(mrb, self, &p_data);
+  if (mrb_obj_is_kind_of(mrb, b, mrb_gsl_matrix_class)) {
+    mrb_matrix_get_data(mrb, b, &p_bm);
+    if (p_bm->size1 != p_data->size) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Matrix sizes don't match");
+    }
+    status = lu_solve_matrix(p_data, p_bm);
+  } else if (mrb_obj_is_kind_of(mrb, b, mrb_gsl_vector_class)) {
+    mrb_vector_get_data(mrb, b, &p_b);
+    if (p_b->size != p_data->size) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Vector sizes don't match");
+    }
+    status = gsl_linalg_LU_svx(p_data->mat, p_data->p, p_b);
+  } else {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a Vector or a Matrix");
+  }
+  if (status) {
+    mrb_raise(mrb, E_LU_DECOMP_ERROR, "Singular matrix");
+  }
+  mrb_gsl_touch(mrb, b);
+  return b;
+}
+
+static mrb_value mrb_lu_solve_into(mrb_state *mrb, mrb_value self) {
+  mrb_value b_vec, x_vec;
+  lu_decomp_data_s *p_data = NULL;
+  gsl_vector *p_b = NULL, *p_x = NULL;
+  gsl_matrix *p_bm = NULL, *p_xm = NULL;
 
+  mrb_get_args(mrb, "oo", &b_vec, &x_vec);
+  // call utility for unwrapping data into p_data:
+  mrb_lu_decomp_get_data(mrb, self, &p_data);
+  if (mrb_obj_is_kind_of(mrb, b_vec, mrb_gsl_matrix_class) &&
+      mrb_obj_is_kind_of(mrb, x_vec, mrb_gsl_matrix_class)) {
+    mrb_matrix_get_data(mrb, b_vec, &p_bm);
+    mrb_matrix_get_data(mrb, x_vec, &p_xm);
+    if (p_bm->size1 != p_data->size || p_xm->size1 != p_bm->size1 ||
+        p_xm->size2 != p_bm->size2) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Matrix sizes don't match");
+    }
+    if (p_xm->data != p_bm->data) {
+      gsl_matrix_memcpy(p_xm, p_bm);
+    }
+    if (lu_solve_matrix(p_data, p_xm)) {
+      mrb_raise(mrb, E_LU_DECOMP_ERROR, "Singular matrix");
+    }
+    mrb_gsl_touch(mrb, x_vec);
+    return x_vec;
+  }
+  if (!mrb_obj_is_kind_of(mrb, b_vec, mrb_gsl_vector_class) ||
+      !mrb_obj_is_kind_of(mrb, x_vec, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Arguments must be Vectors or Matrices");
+  }
+
+  mrb_vector_get_data(mrb, b_vec, &p_b);
+  mrb_vector_get_data(mrb, x_vec, &p_x);
+  if (p_b->size != p_data->size || p_x->size != p_data->size) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Vector sizes don't match");
+  }
+  if (gsl_linalg_LU_solve(p_data->mat, p_data->p, p_b, p_x)) {
+    mrb_raise(mrb, E_LU_DECOMP_ERROR, "Singular matrix");
+  }
+  mrb_gsl_touch(mrb, x_vec);
+  return x_vec;
+}
 
 #pragma mark -
 #pragma mark • Gem setup
@@ -221,7 +361,9 @@ void mrb_gsl_lu_decomp_init(mrb_state *mrb) {
   mrb_load_string(mrb, "class LUDecompError < Exception; end");
 
   lu = mrb_define_class(mrb, "LUDecomp", mrb->object_class);
+  MRB_SET_INSTANCE_TT(lu, MRB_TT_DATA);
   mrb_define_method(mrb, lu, "initialize", mrb_lu_initialize, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, lu, "update!", mrb_lu_update, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, lu, "size", mrb_lu_size, MRB_ARGS_NONE());
   mrb_define_method(mrb, lu, "sign", mrb_lu_sgn, MRB_ARGS_NONE());
   mrb_define_method(mrb, lu, "matrix", mrb_lu_matrix, MRB_ARGS_NONE());
@@ -229,4 +371,6 @@ void mrb_gsl_lu_decomp_init(mrb_state *mrb) {
   mrb_define_method(mrb, lu, "inv", mrb_lu_invert, MRB_ARGS_NONE());
   mrb_define_method(mrb, lu, "det", mrb_lu_det, MRB_ARGS_NONE());
   mrb_define_method(mrb, lu, "solve", mrb_lu_solve, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, lu, "solve!", mrb_lu_solve_bang, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, lu, "solve_into", mrb_lu_solve_into, MRB_ARGS_REQ(2));
 }
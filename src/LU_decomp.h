@@ -62,7 +62,7 @@ typedef struct {
 // Check it with GC.start
 void lu_decomp_destructor(mrb_state *mrb, void *p_);
 
-// Utility function for getting the struct out of the wrapping IV @data
+// Utility function for getting the struct out of self (an MRB_TT_DATA object)
 void mrb_lu_decomp_get_data(mrb_state *mrb, mrb_value self, lu_decomp_data_s **data);
 
 void mrb_gsl_lu_decomp_init(mrb_state *mrb);
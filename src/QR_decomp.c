@@ -17,10 +17,12 @@
 /*                                                                         */
 /***************************************************************************/
 
+#include <gsl/gsl_errno.h>
 #include <gsl/gsl_linalg.h>
 #include <stdio.h>
 #include "matrix.h"
 #include "vector.h"
+#include "lapack.h"
 #include "QR_decomp.h"
 
 #ifndef MIN
@@ -40,6 +42,8 @@
 // Check it with GC.start
 void qr_decomp_destructor(mrb_state *mrb, void *p_) {
   qr_decomp_data_s *lu = (qr_decomp_data_s *)p_;
+  if (!lu)
+    return;
   gsl_matrix_free(lu->mat);
   gsl_vector_free(lu->tau);
   free(lu);
@@ -49,76 +53,83 @@ void qr_decomp_destructor(mrb_state *mrb, void *p_) {
 const struct mrb_data_type qr_decomp_data_type = {"qr_decomp_data",
                                                   qr_decomp_destructor};
 
-// Utility function for getting the struct out of the wrapping IV @data
+// Utility function for getting the struct out of self
 void mrb_qr_decomp_get_data(mrb_state *mrb, mrb_value self,
                             qr_decomp_data_s **data) {
-  mrb_value data_value;
-  data_value = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@data"));
-
-  // Loading data from data_value into p_data:
-  Data_Get_Struct(mrb, data_value, &qr_decomp_data_type, *data);
+  *data = (qr_decomp_data_s *)mrb_data_get_ptr(mrb, self, &qr_decomp_data_type);
   if (!*data)
-    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access @data");
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access decomposition data");
 }
 
 #pragma mark -
 #pragma mark • Initializations
 
-// Data Initializer C function (not exposed!)
-static mrb_value mrb_qr_initialize(mrb_state *mrb, mrb_value self) {
-  mrb_value data_value;            // this IV holds the data
+// Copies matrix into the decomposition data and factorizes it in place. The
+// existing buffers are reused when the dimensions match
+static void qr_factorize(mrb_state *mrb, mrb_value self, mrb_value matrix) {
   qr_decomp_data_s *p_data = NULL; // pointer to the C struct
-  mrb_value matrix;
   gsl_matrix *p_mat = NULL;
   mrb_int size1, size2;
 
-  mrb_get_args(mrb, "o", &matrix);
-  if (!mrb_obj_is_kind_of(mrb, matrix, mrb_class_get(mrb, "Matrix"))) {
+  if (!mrb_obj_is_kind_of(mrb, matrix, mrb_gsl_matrix_class)) {
     mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a Matrix");
   }
 
   mrb_matrix_get_data(mrb, matrix, &p_mat);
-  // if (p_mat->size1 < p_mat->size2) {
-  //   mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be square or horizontal
-  //   Matrix");
-  // }
   size1 = p_mat->size1;
   size2 = p_mat->size2;
 
-  data_value = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@data"));
-  // if @data already exists, free its content:
-  if (!mrb_nil_p(data_value)) {
-    Data_Get_Struct(mrb, data_value, &qr_decomp_data_type, p_data);
-    free(p_data);
+  p_data = (qr_decomp_data_s *)DATA_PTR(self);
+  if (!p_data || p_data->size1 != (size_t)size1 ||
+      p_data->size2 != (size_t)size2) {
+    // if data already exists, free its content:
+    if (p_data) {
+      qr_decomp_destructor(mrb, p_data);
+    }
+    mrb_data_init(self, NULL, &qr_decomp_data_type);
+    p_data = (qr_decomp_data_s *)malloc(sizeof(qr_decomp_data_s));
+    if (!p_data) {
+      mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate decomposition data");
+    }
+    p_data->size1 = size1;
+    p_data->size2 = size2;
+    p_data->minsize = MIN(size1, size2);
+    p_data->mat = gsl_matrix_alloc(size1, size2);
+    p_data->tau = gsl_vector_alloc(p_data->minsize);
+    if (!p_data->mat || !p_data->tau) {
+      qr_decomp_destructor(mrb, p_data);
+      mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate decomposition data");
+    }
+    // Attach struct to self:
+    mrb_data_init(self, p_data, &qr_decomp_data_type);
   }
-  // Allocate and zero-out the data struct:
-  p_data = (qr_decomp_data_s *)malloc(sizeof(qr_decomp_data_s));
-  if (!p_data) {
-    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate @data");
+  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@residuals"), mrb_nil_value());
+  // copy argument matrix into local object data, then decompose in-place
+  gsl_matrix_memcpy(p_data->mat, p_mat);
+  if (mrb_gsl_QR_decomp(p_data->mat, p_data->tau)) {
+    // the half-factorized data is dropped, so that self can't be used
+    // until it is updated with a valid matrix
+    qr_decomp_destructor(mrb, p_data);
+    mrb_data_init(self, NULL, &qr_decomp_data_type);
+    mrb_raise(mrb, E_QR_DECOMP_ERROR, "Decomposition failed");
   }
-  p_data->size1 = size1;
-  p_data->size2 = size2;
-  p_data->minsize = MIN(size1, size2);
-  p_data->mat = gsl_matrix_calloc(size1, size2);
-  p_data->tau = gsl_vector_calloc(p_data->minsize);
+}
 
-  // copy argument matrix into local object data
-  gsl_matrix_memcpy(p_data->mat, p_mat);
-  // invert in-place
-  gsl_linalg_QR_decomp(p_data->mat, p_data->tau);
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@size1"), mrb_fixnum_value(size1));
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@size2"), mrb_fixnum_value(size2));
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@minsize"),
-             mrb_fixnum_value(p_data->minsize));
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@residuals"), mrb_nil_value());
-  // Wrap struct into @data:
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@data"), // set @data
-             mrb_obj_value( // with value hold in struct
-                 Data_Wrap_Struct(mrb, mrb->object_class, &qr_decomp_data_type,
-                                  p_data)));
+// Data Initializer C function (not exposed!)
+static mrb_value mrb_qr_initialize(mrb_state *mrb, mrb_value self) {
+  mrb_value matrix;
+  mrb_get_args(mrb, "o", &matrix);
+  qr_factorize(mrb, self, matrix);
   return mrb_nil_value();
 }
 
+static mrb_value mrb_qr_update(mrb_state *mrb, mrb_value self) {
+  mrb_value matrix;
+  mrb_get_args(mrb, "o", &matrix);
+  qr_factorize(mrb, self, matrix);
+  return self;
+}
+
 #pragma mark -
 #pragma mark • Accessors
 
@@ -127,28 +138,31 @@ static mrb_value mrb_qr_residuals(mrb_state *mrb, mrb_value self) {
 }
 
 static mrb_value mrb_qr_minsize(mrb_state *mrb, mrb_value self) {
-  return mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@minsize"));
+  qr_decomp_data_s *p_data = NULL;
+  mrb_qr_decomp_get_data(mrb, self, &p_data);
+  return mrb_fixnum_value(p_data->minsize);
 }
 
 static mrb_value mrb_qr_size1(mrb_state *mrb, mrb_value self) {
-  return mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@size1"));
+  qr_decomp_data_s *p_data = NULL;
+  mrb_qr_decomp_get_data(mrb, self, &p_data);
+  return mrb_fixnum_value(p_data->size1);
 }
 
 static mrb_value mrb_qr_size2(mrb_state *mrb, mrb_value self) {
-  return mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@size2"));
+  qr_decomp_data_s *p_data = NULL;
+  mrb_qr_decomp_get_data(mrb, self, &p_data);
+  return mrb_fixnum_value(p_data->size2);
 }
 
 static mrb_value mrb_qr_matrix(mrb_state *mrb, mrb_value self) {
   mrb_value result;
   qr_decomp_data_s *p_data = NULL;
   gsl_matrix *p_res = NULL;
-  mrb_value args[2];
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_data:
   mrb_qr_decomp_get_data(mrb, self, &p_data);
-  args[0] = mrb_fixnum_value(p_data->size1);
-  args[1] = mrb_fixnum_value(p_data->size2);
-  result = mrb_obj_new(mrb, mrb_class_get(mrb, "Matrix"), 2, args);
+  result = mrb_gsl_matrix_new_uninit(mrb, p_data->size1, p_data->size2);
   mrb_matrix_get_data(mrb, result, &p_res);
   gsl_matrix_memcpy(p_res, p_data->mat);
   return result;
@@ -158,12 +172,10 @@ static mrb_value mrb_qr_tau(mrb_state *mrb, mrb_value self) {
   mrb_value result;
   qr_decomp_data_s *p_data = NULL;
   gsl_vector *p_res = NULL;
-  mrb_value args[1];
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_data:
   mrb_qr_decomp_get_data(mrb, self, &p_data);
-  args[0] = mrb_fixnum_value(p_data->minsize);
-  result = mrb_obj_new(mrb, mrb_class_get(mrb, "Vector"), 1, args);
+  result = mrb_gsl_vector_new_uninit(mrb, p_data->minsize);
   mrb_vector_get_data(mrb, result, &p_res);
   gsl_vector_memcpy(p_res, p_data->tau);
   return result;
@@ -172,27 +184,62 @@ static mrb_value mrb_qr_tau(mrb_state *mrb, mrb_value self) {
 #pragma mark -
 #pragma mark • Operations
 
+// Solves R X = Q' B for all the columns of B at once, in place: B is
+// overwritten with Q' B, whose first size2 rows are then solved with a
+// blocked triangular solve. Returns the view of the solution rows
+static int qr_solve_matrix(const qr_decomp_data_s *p_data, gsl_matrix *B,
+                           gsl_matrix_view *X) {
+  gsl_matrix_const_view R =
+      gsl_matrix_const_submatrix(p_data->mat, 0, 0, p_data->size2,
+                                 p_data->size2);
+  size_t i;
+  for (i = 0; i < p_data->size2; i++) {
+    if (gsl_matrix_get(p_data->mat, i, i) == 0.0)
+      return GSL_EDOM;
+  }
+  gsl_linalg_QR_QTmat(p_data->mat, p_data->tau, B);
+  *X = gsl_matrix_submatrix(B, 0, 0, p_data->size2, B->size2);
+  gsl_blas_dtrsm(CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, 1.0,
+                 &R.matrix, &X->matrix);
+  return GSL_SUCCESS;
+}
+
 // int gsl_linalg_QR_solve (const gsl_matrix * QR, const gsl_vector * tau, const
 // gsl_vector * b, gsl_vector * x)
+// With a Matrix argument, solves for each of its columns
 static mrb_value mrb_qr_solve(mrb_state *mrb, mrb_value self) {
   mrb_value result, b_vec;
   qr_decomp_data_s *p_data = NULL;
   gsl_vector *p_result = NULL, *p_b = NULL;
-  mrb_value args[1];
+  gsl_matrix *p_bm = NULL, *p_resm = NULL;
+  gsl_matrix_view x;
 
   mrb_get_args(mrb, "o", &b_vec);
-  if (!mrb_obj_is_kind_of(mrb, b_vec, mrb_class_get(mrb, "Vector"))) {
-    mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a Vector");
-  }
-
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_data:
   mrb_qr_decomp_get_data(mrb, self, &p_data);
   if (p_data->size1 != p_data->size2) {
     mrb_raise(mrb, E_QR_DECOMP_ERROR, "Matrix must be square");
   }
 
-  args[0] = mrb_fixnum_value(p_data->tau->size);
-  result = mrb_obj_new(mrb, mrb_class_get(mrb, "Vector"), 1, args);
+  if (mrb_obj_is_kind_of(mrb, b_vec, mrb_gsl_matrix_class)) {
+    mrb_matrix_get_data(mrb, b_vec, &p_bm);
+    if (p_bm->size1 != p_data->size1) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Matrix sizes don't match");
+    }
+    result = mrb_gsl_matrix_new_uninit(mrb, p_bm->size1, p_bm->size2);
+    mrb_matrix_get_data(mrb, result, &p_resm);
+    gsl_matrix_memcpy(p_resm, p_bm);
+    if (qr_solve_matrix(p_data, p_resm, &x)) {
+      mrb_raise(mrb, E_QR_DECOMP_ERROR, "Singular matrix");
+    }
+    mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@residuals"), mrb_nil_value());
+    return result;
+  }
+  if (!mrb_obj_is_kind_of(mrb, b_vec, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a Vector or a Matrix");
+  }
+
+  result = mrb_gsl_vector_new_uninit(mrb, p_data->tau->size);
   mrb_vector_get_data(mrb, result, &p_result);
   mrb_vector_get_data(mrb, b_vec, &p_b);
 
@@ -203,33 +250,109 @@ static mrb_value mrb_qr_solve(mrb_state *mrb, mrb_value self) {
   return result;
 }
 
+// int gsl_linalg_QR_svx (const gsl_matrix * QR, const gsl_vector * tau,
+// gsl_vector * x)
+// Overwrites the argument (a Vector or a Matrix of right hand sides) with
+// the solution
+static mrb_value mrb_qr_solve_bang(mrb_state *mrb, mrb_value self) {
+  mrb_value b;
+  qr_decomp_data_s *p_data = NULL;
+  gsl_vector *p_b = NULL;
+  gsl_matrix *p_bm = NULL;
+  gsl_matrix_view x;
+  int status;
+
+  mrb_get_args(mrb, "o", &b);
+  mrb_qr_decomp_get_data(mrb, self, &p_data);
+  if (p_data->size1 != p_data->size2) {
+    mrb_raise(mrb, E_QR_DECOMP_ERROR, "Matrix must be square");
+  }
+  if (mrb_obj_is_kind_of(mrb, b, mrb_gsl_matrix_class)) {
+    mrb_matrix_get_data(mrb, b, &p_bm);
+    if (p_bm->size1 != p_data->size1) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Matrix sizes don't match");
+    }
+    status = qr_solve_matrix(p_data, p_bm, &x);
+  } else if (mrb_obj_is_kind_of(mrb, b, mrb_gsl_vector_class)) {
+    mrb_vector_get_data(mrb, b, &p_b);
+    if (p_b->size != p_data->size1) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Vector sizes don't match");
+    }
+    status = gsl_linalg_QR_svx(p_data->mat, p_data->tau, p_b);
+  } else {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a Vector or a Matrix");
+  }
+  if (status) {
+    mrb_raise(mrb, E_QR_DECOMP_ERROR, "Singular matrix");
+  }
+  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@residuals"), mrb_nil_value());
+  mrb_gsl_touch(mrb, b);
+  return b;
+}
+
+// Least squares for all the columns of B: the residuals (a Matrix) are
+// Q times Q' B with its first size2 rows zeroed
+static mrb_value qr_lssolve_matrix(mrb_state *mrb, mrb_value self,
+                                   qr_decomp_data_s *p_data,
+                                   mrb_value b_mat) {
+  mrb_value result, residuals;
+  gsl_matrix *p_b = NULL, *p_res = NULL, *p_r = NULL;
+  gsl_matrix_view x, top;
+  gsl_vector_view col;
+  size_t j;
+
+  mrb_matrix_get_data(mrb, b_mat, &p_b);
+  if (p_b->size1 != p_data->size1) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Matrix sizes don't match");
+  }
+  residuals = mrb_gsl_matrix_new_uninit(mrb, p_b->size1, p_b->size2);
+  mrb_matrix_get_data(mrb, residuals, &p_r);
+  gsl_matrix_memcpy(p_r, p_b);
+  if (qr_solve_matrix(p_data, p_r, &x)) {
+    mrb_raise(mrb, E_QR_DECOMP_ERROR, "Singular matrix");
+  }
+  result = mrb_gsl_matrix_new_uninit(mrb, p_data->size2, p_b->size2);
+  mrb_matrix_get_data(mrb, result, &p_res);
+  gsl_matrix_memcpy(p_res, &x.matrix);
+
+  top = gsl_matrix_submatrix(p_r, 0, 0, p_data->size2, p_r->size2);
+  gsl_matrix_set_zero(&top.matrix);
+  for (j = 0; j < p_r->size2; j++) {
+    col = gsl_matrix_column(p_r, j);
+    gsl_linalg_QR_Qvec(p_data->mat, p_data->tau, &col.vector);
+  }
+  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@residuals"), residuals);
+  return result;
+}
+
 // int gsl_linalg_QR_lssolve (const gsl_matrix * QR, const gsl_vector * tau,
 // const gsl_vector * b, gsl_vector * x, gsl_vector * residual)
+// With a Matrix argument, solves for each of its columns
 static mrb_value mrb_qr_lssolve(mrb_state *mrb, mrb_value self) {
   mrb_value result, b_vec, residuals;
   qr_decomp_data_s *p_data = NULL;
   gsl_vector *p_result = NULL, *p_b = NULL, *p_residuals;
-  mrb_value args[1];
 
   mrb_get_args(mrb, "o", &b_vec);
-  if (!mrb_obj_is_kind_of(mrb, b_vec, mrb_class_get(mrb, "Vector"))) {
-    mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a Vector");
-  }
-
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_data:
   mrb_qr_decomp_get_data(mrb, self, &p_data);
   if (p_data->size1 <= p_data->size2) {
     mrb_raise(mrb, E_QR_DECOMP_ERROR,
               "Matrix must have more rows than columns");
   }
 
-  args[0] = mrb_fixnum_value(p_data->size2);
-  result = mrb_obj_new(mrb, mrb_class_get(mrb, "Vector"), 1, args);
+  if (mrb_obj_is_kind_of(mrb, b_vec, mrb_gsl_matrix_class)) {
+    return qr_lssolve_matrix(mrb, self, p_data, b_vec);
+  }
+  if (!mrb_obj_is_kind_of(mrb, b_vec, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a Vector or a Matrix");
+  }
+
+  result = mrb_gsl_vector_new_uninit(mrb, p_data->size2);
   mrb_vector_get_data(mrb, result, &p_result);
   mrb_vector_get_data(mrb, b_vec, &p_b);
 
-  args[0] = mrb_fixnum_value(p_b->size);
-  residuals = mrb_obj_new(mrb, mrb_class_get(mrb, "Vector"), 1, args);
+  residuals = mrb_gsl_vector_new_uninit(mrb, p_b->size);
   mrb_vector_get_data(mrb, residuals, &p_residuals);
   mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@residuals"), residuals);
 
@@ -240,6 +363,67 @@ static mrb_value mrb_qr_lssolve(mrb_state *mrb, mrb_value self) {
   return result;
 }
 
+static mrb_value mrb_qr_solve_into(mrb_state *mrb, mrb_value self) {
+  mrb_value b_vec, x_vec;
+  qr_decomp_data_s *p_data = NULL;
+  gsl_vector *p_b = NULL, *p_x = NULL;
+
+  mrb_get_args(mrb, "oo", &b_vec, &x_vec);
+  if (!mrb_obj_is_kind_of(mrb, b_vec, mrb_gsl_vector_class) ||
+      !mrb_obj_is_kind_of(mrb, x_vec, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Arguments must be Vectors");
+  }
+
+  // call utility for unwrapping data into p_data:
+  mrb_qr_decomp_get_data(mrb, self, &p_data);
+  if (p_data->size1 != p_data->size2) {
+    mrb_raise(mrb, E_QR_DECOMP_ERROR, "Matrix must be square");
+  }
+  mrb_vector_get_data(mrb, b_vec, &p_b);
+  mrb_vector_get_data(mrb, x_vec, &p_x);
+  if (p_b->size != p_data->size1 || p_x->size != p_data->size2) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Vector sizes don't match");
+  }
+  if (gsl_linalg_QR_solve(p_data->mat, p_data->tau, p_b, p_x)) {
+    mrb_raise(mrb, E_QR_DECOMP_ERROR, "Singular matrix");
+  }
+  mrb_gsl_touch(mrb, x_vec);
+  return x_vec;
+}
+
+static mrb_value mrb_qr_lssolve_into(mrb_state *mrb, mrb_value self) {
+  mrb_value b_vec, x_vec, r_vec;
+  qr_decomp_data_s *p_data = NULL;
+  gsl_vector *p_b = NULL, *p_x = NULL, *p_r = NULL;
+
+  mrb_get_args(mrb, "ooo", &b_vec, &x_vec, &r_vec);
+  if (!mrb_obj_is_kind_of(mrb, b_vec, mrb_gsl_vector_class) ||
+      !mrb_obj_is_kind_of(mrb, x_vec, mrb_gsl_vector_class) ||
+      !mrb_obj_is_kind_of(mrb, r_vec, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Arguments must be Vectors");
+  }
+
+  // call utility for unwrapping data into p_data:
+  mrb_qr_decomp_get_data(mrb, self, &p_data);
+  if (p_data->size1 <= p_data->size2) {
+    mrb_raise(mrb, E_QR_DECOMP_ERROR,
+              "Matrix must have more rows than columns");
+  }
+  mrb_vector_get_data(mrb, b_vec, &p_b);
+  mrb_vector_get_data(mrb, x_vec, &p_x);
+  mrb_vector_get_data(mrb, r_vec, &p_r);
+  if (p_b->size != p_data->size1 || p_x->size != p_data->size2 ||
+      p_r->size != p_data->size1) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Vector sizes don't match");
+  }
+  if (gsl_linalg_QR_lssolve(p_data->mat, p_data->tau, p_b, p_x, p_r)) {
+    mrb_raise(mrb, E_QR_DECOMP_ERROR, "Singular matrix");
+  }
+  mrb_gsl_touch(mrb, r_vec);
+  mrb_gsl_touch(mrb, x_vec);
+  return x_vec;
+}
+
 #pragma mark -
 #pragma mark • Gem setup
 
@@ -249,6 +433,7 @@ void mrb_gsl_qr_decomp_init(mrb_state *mrb) {
   mrb_load_string(mrb, "class QRDecompError < Exception; end");
 
   lu = mrb_define_class(mrb, "QRDecomp", mrb->object_class);
+  MRB_SET_INSTANCE_TT(lu, MRB_TT_DATA);
   mrb_define_method(mrb, lu, "residuals", mrb_qr_residuals, MRB_ARGS_NONE());
   mrb_define_method(mrb, lu, "matrix", mrb_qr_matrix, MRB_ARGS_NONE());
   mrb_define_method(mrb, lu, "tau", mrb_qr_tau, MRB_ARGS_NONE());
@@ -257,6 +442,11 @@ void mrb_gsl_qr_decomp_init(mrb_state *mrb) {
   mrb_define_method(mrb, lu, "minsize", mrb_qr_minsize, MRB_ARGS_NONE());
 
   mrb_define_method(mrb, lu, "initialize", mrb_qr_initialize, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, lu, "update!", mrb_qr_update, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, lu, "solve", mrb_qr_solve, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, lu, "solve!", mrb_qr_solve_bang, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, lu, "lssolve", mrb_qr_lssolve, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, lu, "solve_into", mrb_qr_solve_into, MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, lu, "lssolve_into", mrb_qr_lssolve_into,
+                    MRB_ARGS_REQ(3));
 }
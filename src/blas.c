@@ -0,0 +1,327 @@
+/***************************************************************************/
+/*                                                                         */
+/* blas.c - BLAS level 1-3 methods for Vector and Matrix                   */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#include "matrix.h"
+#include "vector.h"
+#include "blas.h"
+
+#pragma mark -
+#pragma mark • Utilities
+
+// Options are passed as a trailing Hash, e.g.
+// c.gemm!(1.0, a, b, 0.0, trans_a: true)
+static mrb_value blas_opt(mrb_state *mrb, mrb_value opts, const char *key) {
+  if (!mrb_hash_p(opts))
+    return mrb_nil_value();
+  return mrb_hash_get(mrb, opts, mrb_symbol_value(mrb_intern_cstr(mrb, key)));
+}
+
+// Whether the output c shares storage with the operand a, views included
+static mrb_bool blas_overlap(const gsl_matrix *c, const gsl_matrix *a) {
+  return mrb_gsl_overlap(c->data, mrb_gsl_matrix_span(c), a->data,
+                         mrb_gsl_matrix_span(a));
+}
+
+static CBLAS_TRANSPOSE_t blas_trans(mrb_state *mrb, mrb_value opts,
+                                    const char *key) {
+  return mrb_test(blas_opt(mrb, opts, key)) ? CblasTrans : CblasNoTrans;
+}
+
+// uplo: :upper (default) or :lower
+static CBLAS_UPLO_t blas_uplo(mrb_state *mrb, mrb_value opts) {
+  mrb_value v = blas_opt(mrb, opts, "uplo");
+  if (mrb_nil_p(v) || (mrb_symbol_p(v) &&
+                        mrb_symbol(v) == mrb_intern_lit(mrb, "upper")))
+    return CblasUpper;
+  if (mrb_symbol_p(v) && mrb_symbol(v) == mrb_intern_lit(mrb, "lower"))
+    return CblasLower;
+  mrb_raise(mrb, E_ARGUMENT_ERROR, "uplo must be :upper or :lower");
+}
+
+// side: :left (default) or :right
+static CBLAS_SIDE_t blas_side(mrb_state *mrb, mrb_value opts) {
+  mrb_value v = blas_opt(mrb, opts, "side");
+  if (mrb_nil_p(v) || (mrb_symbol_p(v) &&
+                        mrb_symbol(v) == mrb_intern_lit(mrb, "left")))
+    return CblasLeft;
+  if (mrb_symbol_p(v) && mrb_symbol(v) == mrb_intern_lit(mrb, "right"))
+    return CblasRight;
+  mrb_raise(mrb, E_ARGUMENT_ERROR, "side must be :left or :right");
+}
+
+// unit: true means that the diagonal of the triangular matrix is all ones
+static CBLAS_DIAG_t blas_diag(mrb_state *mrb, mrb_value opts) {
+  return mrb_test(blas_opt(mrb, opts, "unit")) ? CblasUnit : CblasNonUnit;
+}
+
+#pragma mark -
+#pragma mark • Level 1
+
+// y = alpha * x + y
+static mrb_value mrb_vector_axpy(mrb_state *mrb, mrb_value self) {
+  mrb_float alpha;
+  mrb_value x;
+  gsl_vector *p_vec, *p_x;
+
+  mrb_get_args(mrb, "fo", &alpha, &x);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  mrb_vector_get_data(mrb, x, &p_x);
+  if (gsl_blas_daxpy(alpha, p_x, p_vec)) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Vector dimensions don't match!");
+  }
+  mrb_gsl_touch(mrb, self);
+  return self;
+}
+
+// x = alpha * x
+static mrb_value mrb_vector_scal(mrb_state *mrb, mrb_value self) {
+  mrb_float alpha;
+  gsl_vector *p_vec;
+
+  mrb_get_args(mrb, "f", &alpha);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  gsl_blas_dscal(alpha, p_vec);
+  mrb_gsl_touch(mrb, self);
+  return self;
+}
+
+// Givens rotation of the points (self[i], other[i]):
+// self = c * self + s * other, other = -s * self + c * other
+static mrb_value mrb_vector_rot(mrb_state *mrb, mrb_value self) {
+  mrb_float c, s;
+  mrb_value other;
+  gsl_vector *p_vec, *p_other;
+
+  mrb_get_args(mrb, "off", &other, &c, &s);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  mrb_vector_get_data(mrb, other, &p_other);
+  if (gsl_blas_drot(p_vec, p_other, c, s)) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Vector dimensions don't match!");
+  }
+  mrb_gsl_touch(mrb, self);
+  mrb_gsl_touch(mrb, other);
+  return self;
+}
+
+#pragma mark -
+#pragma mark • Level 2
+
+// y = alpha * op(A) * x + beta * y
+static mrb_value mrb_vector_gemv(mrb_state *mrb, mrb_value self) {
+  mrb_float alpha, beta;
+  mrb_value a, x, opts = mrb_nil_value();
+  gsl_vector *p_vec, *p_x;
+  gsl_matrix *p_a;
+
+  mrb_get_args(mrb, "foof|H", &alpha, &a, &x, &beta, &opts);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  mrb_matrix_get_data(mrb, a, &p_a);
+  mrb_vector_get_data(mrb, x, &p_x);
+  if (mrb_gsl_overlap(p_vec->data, mrb_gsl_vector_span(p_vec), p_x->data,
+                      mrb_gsl_vector_span(p_x)) ||
+      mrb_gsl_overlap(p_vec->data, mrb_gsl_vector_span(p_vec), p_a->data,
+                      mrb_gsl_matrix_span(p_a))) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Output must not alias an operand");
+  }
+  if (gsl_blas_dgemv(blas_trans(mrb, opts, "trans"), alpha, p_a, p_x, beta,
+                     p_vec)) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Vector dimensions don't match!");
+  }
+  mrb_gsl_touch(mrb, self);
+  return self;
+}
+
+// x = op(A) * x, A triangular
+static mrb_value mrb_vector_trmv(mrb_state *mrb, mrb_value self) {
+  mrb_value a, opts = mrb_nil_value();
+  gsl_vector *p_vec;
+  gsl_matrix *p_a;
+
+  mrb_get_args(mrb, "o|H", &a, &opts);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  mrb_matrix_get_data(mrb, a, &p_a);
+  if (gsl_blas_dtrmv(blas_uplo(mrb, opts), blas_trans(mrb, opts, "trans"),
+                     blas_diag(mrb, opts), p_a, p_vec)) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Vector dimensions don't match!");
+  }
+  mrb_gsl_touch(mrb, self);
+  return self;
+}
+
+// x = inv(op(A)) * x, A triangular
+static mrb_value mrb_vector_trsv(mrb_state *mrb, mrb_value self) {
+  mrb_value a, opts = mrb_nil_value();
+  gsl_vector *p_vec;
+  gsl_matrix *p_a;
+
+  mrb_get_args(mrb, "o|H", &a, &opts);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  mrb_matrix_get_data(mrb, a, &p_a);
+  if (gsl_blas_dtrsv(blas_uplo(mrb, opts), blas_trans(mrb, opts, "trans"),
+                     blas_diag(mrb, opts), p_a, p_vec)) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Vector dimensions don't match!");
+  }
+  mrb_gsl_touch(mrb, self);
+  return self;
+}
+
+// A = alpha * x * y' + A (rank-1 update)
+static mrb_value mrb_matrix_ger(mrb_state *mrb, mrb_value self) {
+  mrb_float alpha;
+  mrb_value x, y;
+  gsl_matrix *p_mat;
+  gsl_vector *p_x, *p_y;
+
+  mrb_get_args(mrb, "foo", &alpha, &x, &y);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  mrb_vector_get_data(mrb, x, &p_x);
+  mrb_vector_get_data(mrb, y, &p_y);
+  if (gsl_blas_dger(alpha, p_x, p_y, p_mat)) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+  }
+  mrb_gsl_touch(mrb, self);
+  return self;
+}
+
+#pragma mark -
+#pragma mark • Level 3
+
+// C = alpha * op(A) * op(B) + beta * C
+static mrb_value mrb_matrix_gemm(mrb_state *mrb, mrb_value self) {
+  mrb_float alpha, beta;
+  mrb_value a, b, opts = mrb_nil_value();
+  gsl_matrix *p_mat, *p_a, *p_b;
+
+  mrb_get_args(mrb, "foof|H", &alpha, &a, &b, &beta, &opts);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  mrb_matrix_get_data(mrb, a, &p_a);
+  mrb_matrix_get_data(mrb, b, &p_b);
+  if (blas_overlap(p_mat, p_a) || blas_overlap(p_mat, p_b)) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "Output must not alias an operand");
+  }
+  if (gsl_blas_dgemm(blas_trans(mrb, opts, "trans_a"),
+                     blas_trans(mrb, opts, "trans_b"), alpha, p_a, p_b, beta,
+                     p_mat)) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+  }
+  mrb_gsl_touch(mrb, self);
+  return self;
+}
+
+// C = alpha * A * B + beta * C (side: :left) or
+// C = alpha * B * A + beta * C (side: :right), A symmetric
+static mrb_value mrb_matrix_symm(mrb_state *mrb, mrb_value self) {
+  mrb_float alpha, beta;
+  mrb_value a, b, opts = mrb_nil_value();
+  gsl_matrix *p_mat, *p_a, *p_b;
+
+  mrb_get_args(mrb, "foof|H", &alpha, &a, &b, &beta, &opts);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  mrb_matrix_get_data(mrb, a, &p_a);
+  mrb_matrix_get_data(mrb, b, &p_b);
+  if (blas_overlap(p_mat, p_a) || blas_overlap(p_mat, p_b)) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "Output must not alias an operand");
+  }
+  if (gsl_blas_dsymm(blas_side(mrb, opts), blas_uplo(mrb, opts), alpha, p_a,
+                     p_b, beta, p_mat)) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+  }
+  mrb_gsl_touch(mrb, self);
+  return self;
+}
+
+// C = alpha * A * A' + beta * C (trans: true gives A' * A). Only the uplo
+// triangle of C is referenced and updated
+static mrb_value mrb_matrix_syrk(mrb_state *mrb, mrb_value self) {
+  mrb_float alpha, beta;
+  mrb_value a, opts = mrb_nil_value();
+  gsl_matrix *p_mat, *p_a;
+
+  mrb_get_args(mrb, "fof|H", &alpha, &a, &beta, &opts);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  mrb_matrix_get_data(mrb, a, &p_a);
+  if (blas_overlap(p_mat, p_a)) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "Output must not alias an operand");
+  }
+  if (gsl_blas_dsyrk(blas_uplo(mrb, opts), blas_trans(mrb, opts, "trans"),
+                     alpha, p_a, beta, p_mat)) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+  }
+  mrb_gsl_touch(mrb, self);
+  return self;
+}
+
+// B = alpha * op(A) * B (side: :left) or B = alpha * B * op(A) (side:
+// :right), A triangular
+static mrb_value mrb_matrix_trmm(mrb_state *mrb, mrb_value self) {
+  mrb_float alpha;
+  mrb_value a, opts = mrb_nil_value();
+  gsl_matrix *p_mat, *p_a;
+
+  mrb_get_args(mrb, "fo|H", &alpha, &a, &opts);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  mrb_matrix_get_data(mrb, a, &p_a);
+  if (gsl_blas_dtrmm(blas_side(mrb, opts), blas_uplo(mrb, opts),
+                     blas_trans(mrb, opts, "trans"), blas_diag(mrb, opts),
+                     alpha, p_a, p_mat)) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+  }
+  mrb_gsl_touch(mrb, self);
+  return self;
+}
+
+// B = alpha * inv(op(A)) * B (side: :left) or B = alpha * B * inv(op(A))
+// (side: :right), A triangular
+static mrb_value mrb_matrix_trsm(mrb_state *mrb, mrb_value self) {
+  mrb_float alpha;
+  mrb_value a, opts = mrb_nil_value();
+  gsl_matrix *p_mat, *p_a;
+
+  mrb_get_args(mrb, "fo|H", &alpha, &a, &opts);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  mrb_matrix_get_data(mrb, a, &p_a);
+  if (gsl_blas_dtrsm(blas_side(mrb, opts), blas_uplo(mrb, opts),
+                     blas_trans(mrb, opts, "trans"), blas_diag(mrb, opts),
+                     alpha, p_a, p_mat)) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+  }
+  mrb_gsl_touch(mrb, self);
+  return self;
+}
+
+#pragma mark -
+#pragma mark • Gem setup
+
+void mrb_gsl_blas_init(mrb_state *mrb) {
+  struct RClass *vec = mrb_gsl_vector_class, *mat = mrb_gsl_matrix_class;
+
+  mrb_define_method(mrb, vec, "axpy!", mrb_vector_axpy, MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, vec, "scal!", mrb_vector_scal, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, vec, "rot!", mrb_vector_rot, MRB_ARGS_REQ(3));
+  mrb_define_method(mrb, vec, "gemv!", mrb_vector_gemv, MRB_ARGS_ARG(4, 1));
+  mrb_define_method(mrb, vec, "trmv!", mrb_vector_trmv, MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, vec, "trsv!", mrb_vector_trsv, MRB_ARGS_ARG(1, 1));
+
+  mrb_define_method(mrb, mat, "ger!", mrb_matrix_ger, MRB_ARGS_REQ(3));
+  mrb_define_method(mrb, mat, "gemm!", mrb_matrix_gemm, MRB_ARGS_ARG(4, 1));
+  mrb_define_method(mrb, mat, "symm!", mrb_matrix_symm, MRB_ARGS_ARG(4, 1));
+  mrb_define_method(mrb, mat, "syrk!", mrb_matrix_syrk, MRB_ARGS_ARG(3, 1));
+  mrb_define_method(mrb, mat, "trmm!", mrb_matrix_trmm, MRB_ARGS_ARG(2, 1));
+  mrb_define_method(mrb, mat, "trsm!", mrb_matrix_trsm, MRB_ARGS_ARG(2, 1));
+}
@@ -0,0 +1,36 @@
+/***************************************************************************/
+/*                                                                         */
+/* blas.h - BLAS level 1-3 methods for Vector and Matrix                   */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef BLAS_H
+#define BLAS_H
+
+#include <gsl/gsl_blas.h>
+
+#include "mruby.h"
+#include "mruby/hash.h"
+
+/***********************************************\
+ BLAS
+\***********************************************/
+
+// Adds the BLAS methods to Vector and Matrix: it must be called after
+// mrb_gsl_vector_init and mrb_gsl_matrix_init
+void mrb_gsl_blas_init(mrb_state *mrb);
+
+#endif // BLAS_H
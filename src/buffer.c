@@ -0,0 +1,444 @@
+/***************************************************************************/
+/*                                                                         */
+/* buffer.c - Circular buffer class for mruby                              */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#include <math.h>
+#include <gsl/gsl_statistics_double.h>
+#include "vector.h"
+#include "buffer.h"
+
+#pragma mark -
+#pragma mark • Utilities
+
+struct RClass *mrb_gsl_buffer_class = NULL;
+
+// Utility function for getting the struct out of self
+static buffer_data_s *mrb_buffer_get_data(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b =
+      (buffer_data_s *)mrb_data_get_ptr(mrb, self, &vector_data_type);
+  if (!b || !mrb_obj_is_kind_of(mrb, self, mrb_gsl_buffer_class))
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access buffer data");
+  return b;
+}
+
+// Whether self is a Buffer. This runs on every write and every data access,
+// so the data type and the class pointer are compared first: only
+// subclasses of Vector other than VectorView and Buffer need the walk
+static mrb_bool buffer_p(mrb_state *mrb, mrb_value self) {
+  struct RClass *c;
+  if (!mrb_gsl_buffer_class || mrb_type(self) != MRB_TT_DATA ||
+      DATA_TYPE(self) != &vector_data_type)
+    return 0;
+  c = RDATA(self)->c;
+  if (c == mrb_gsl_buffer_class)
+    return 1;
+  if (c == mrb_gsl_vector_class || c == mrb_gsl_vector_view_class)
+    return 0;
+  return mrb_obj_is_kind_of(mrb, self, mrb_gsl_buffer_class);
+}
+
+void mrb_gsl_buffer_dirty(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b;
+  if (!buffer_p(mrb, self))
+    return;
+  b = (buffer_data_s *)DATA_PTR(self);
+  if (b)
+    b->dirty = 1;
+}
+
+static void buffer_reverse(double *x, size_t n) {
+  size_t i;
+  double t;
+  for (i = 0; i < n / 2; i++) {
+    t = x[i];
+    x[i] = x[n - 1 - i];
+    x[n - 1 - i] = t;
+  }
+}
+
+// Rotates the storage in place, so that the oldest sample is at position 0.
+// The sample numbers are all shifted by the same amount, to keep head ==
+// seq % size, so that the deques stay valid; the sums don't depend on the
+// order
+static void buffer_linearize(buffer_data_s *b) {
+  size_t n = b->vec.size, d = n - b->head, i;
+  if (b->head == 0)
+    return;
+  buffer_reverse(b->vec.data, b->head);
+  buffer_reverse(b->vec.data + b->head, d);
+  buffer_reverse(b->vec.data, n);
+  for (i = 0; i < b->max.len; i++)
+    b->max.seq[(b->max.head + i) % n] += d;
+  for (i = 0; i < b->min.len; i++)
+    b->min.seq[(b->min.head + i) % n] += d;
+  b->seq += d;
+  b->head = 0;
+}
+
+void mrb_gsl_buffer_linearize(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b;
+  if (!buffer_p(mrb, self))
+    return;
+  b = (buffer_data_s *)DATA_PTR(self);
+  if (b)
+    buffer_linearize(b);
+}
+
+static double buffer_at(buffer_data_s *b, size_t seq) {
+  return b->vec.data[seq % b->vec.size];
+}
+
+// Appends sample seq, once written, to a monotonic deque: the samples at
+// the back that are not better than the new one can never be the extreme
+// of the window again, so the front is always the extreme
+static void deque_push(buffer_data_s *b, buffer_deque_s *q, size_t seq,
+                       int max) {
+  size_t n = b->vec.size;
+  double x = buffer_at(b, seq), y;
+  while (q->len > 0) {
+    y = buffer_at(b, q->seq[(q->head + q->len - 1) % n]);
+    if (max ? y > x : y < x)
+      break;
+    q->len--;
+  }
+  q->seq[(q->head + q->len) % n] = seq;
+  q->len++;
+}
+
+// Drops the sample that is about to be overwritten by sample seq
+static void deque_expire(buffer_data_s *b, buffer_deque_s *q, size_t seq) {
+  size_t n = b->vec.size;
+  if (q->len > 0 && q->seq[q->head] + n <= seq) {
+    q->head = (q->head + 1) % n;
+    q->len--;
+  }
+}
+
+// Recomputes the sums, shifted by the current mean so that the variance
+// does not suffer from cancellation, and bounding the rounding drift of
+// the running updates
+static void buffer_sync_sums(buffer_data_s *b) {
+  size_t i, n = b->vec.size;
+  double d;
+  b->shift = gsl_stats_mean(b->vec.data, 1, n);
+  b->sum = b->sumsq = 0;
+  for (i = 0; i < n; i++) {
+    d = b->vec.data[i] - b->shift;
+    b->sum += d;
+    b->sumsq += d * d;
+  }
+  b->since_sync = 0;
+}
+
+// Rebuilds all the statistics from the storage, in O(n)
+static void buffer_rebuild(buffer_data_s *b) {
+  size_t s;
+  buffer_sync_sums(b);
+  b->max.head = b->max.len = b->min.head = b->min.len = 0;
+  for (s = b->seq - b->vec.size; s < b->seq; s++) {
+    deque_push(b, &b->max, s, 1);
+    deque_push(b, &b->min, s, 0);
+  }
+  b->dirty = 0;
+}
+
+// Brings the statistics up to date before reading them: O(1), except after
+// Vector methods wrote the storage or every size samples, which is O(n)
+static buffer_data_s *buffer_synced(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b = mrb_buffer_get_data(mrb, self);
+  if (b->dirty)
+    buffer_rebuild(b);
+  else if (b->since_sync >= b->vec.size)
+    buffer_sync_sums(b);
+  return b;
+}
+
+static void buffer_push(buffer_data_s *b, double x) {
+  double old = b->vec.data[b->head], d0, d1;
+
+  if (!b->dirty) {
+    deque_expire(b, &b->max, b->seq);
+    deque_expire(b, &b->min, b->seq);
+  }
+  b->vec.data[b->head] = x;
+  if (!b->dirty) {
+    d0 = old - b->shift;
+    d1 = x - b->shift;
+    b->sum += d1 - d0;
+    b->sumsq += d1 * d1 - d0 * d0;
+    b->since_sync++;
+    deque_push(b, &b->max, b->seq, 1);
+    deque_push(b, &b->min, b->seq, 0);
+  }
+  b->seq++;
+  b->head = b->seq % b->vec.size;
+}
+
+// Index relative to the oldest sample; negative indexes count from the
+// newest one
+static size_t buffer_index(mrb_state *mrb, buffer_data_s *b, mrb_int i) {
+  mrb_int n = (mrb_int)b->vec.size;
+  if (i < 0)
+    i += n;
+  if (i < 0 || i >= n) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Buffer index out of range!");
+  }
+  return (b->head + i) % b->vec.size;
+}
+
+#pragma mark -
+#pragma mark • Init and accessing
+
+// Buffer.new(n): n zeros, the first one being the oldest
+static mrb_value mrb_buffer_initialize(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b;
+  gsl_block *block;
+  mrb_int n;
+
+  mrb_get_args(mrb, "i", &n);
+  if (n <= 0) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Buffer size must be positive");
+  }
+  b = (buffer_data_s *)DATA_PTR(self);
+  if (b && DATA_TYPE(self)) {
+    DATA_TYPE(self)->dfree(mrb, b);
+  }
+  mrb_data_init(self, NULL, &vector_data_type);
+  block = gsl_block_calloc(n);
+  if (!block)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate buffer data");
+  b = (buffer_data_s *)calloc(1, sizeof(buffer_data_s) +
+                                     2 * n * sizeof(size_t));
+  if (!b) {
+    gsl_block_free(block);
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate buffer data");
+  }
+  // owner is 1, so gsl_vector_free() releases the block and then b
+  b->vec.size = n;
+  b->vec.stride = 1;
+  b->vec.data = block->data;
+  b->vec.block = block;
+  b->vec.owner = 1;
+  b->max.seq = (size_t *)(b + 1);
+  b->min.seq = b->max.seq + n;
+  b->seq = n;
+  buffer_rebuild(b);
+  mrb_data_init(self, b, &vector_data_type);
+  return mrb_nil_value();
+}
+
+static mrb_value mrb_buffer_head(mrb_state *mrb, mrb_value self) {
+  return mrb_fixnum_value(mrb_buffer_get_data(mrb, self)->head);
+}
+
+static mrb_value mrb_buffer_get_i(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b = mrb_buffer_get_data(mrb, self);
+  mrb_int i;
+  mrb_get_args(mrb, "i", &i);
+  return mrb_float_value(mrb, b->vec.data[buffer_index(mrb, b, i)]);
+}
+
+static mrb_value mrb_buffer_set_i(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b = mrb_buffer_get_data(mrb, self);
+  mrb_int i;
+  mrb_value v;
+  mrb_get_args(mrb, "io", &i, &v);
+  b->vec.data[buffer_index(mrb, b, i)] = mrb_gsl_to_f(mrb, v);
+  b->dirty = 1;
+  return v;
+}
+
+// Overwrites the oldest sample, in O(1)
+static mrb_value mrb_buffer_push(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b = mrb_buffer_get_data(mrb, self);
+  mrb_value v;
+  mrb_get_args(mrb, "o", &v);
+  if (!mrb_float_p(v) && !mrb_fixnum_p(v) &&
+      !mrb_respond_to(mrb, v, mrb_intern_lit(mrb, "to_f"))) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Numeric");
+  }
+  buffer_push(b, mrb_gsl_to_f(mrb, v));
+  return v;
+}
+
+// Pushes all the elements of a Vector (or an Array), in order. When they
+// are at least as many as the buffer size, only the last ones are copied
+static mrb_value mrb_buffer_push_many(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b = mrb_buffer_get_data(mrb, self);
+  gsl_vector *p_vec;
+  mrb_value v;
+  size_t i, k, n = b->vec.size;
+
+  mrb_get_args(mrb, "o", &v);
+  if (mrb_array_p(v)) {
+    for (i = 0; i < (size_t)RARRAY_LEN(v); i++)
+      buffer_push(b, mrb_gsl_to_f(mrb, mrb_ary_ref(mrb, v, i)));
+    return self;
+  }
+  if (!mrb_obj_is_kind_of(mrb, v, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Vector or an Array");
+  }
+  mrb_vector_get_data(mrb, v, &p_vec);
+  if (mrb_gsl_overlap(p_vec->data, mrb_gsl_vector_span(p_vec), b->vec.data,
+                      b->vec.size)) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Cannot push a Buffer into itself");
+  }
+  k = p_vec->size;
+  if (k < n) {
+    for (i = 0; i < k; i++)
+      buffer_push(b, p_vec->data[i * p_vec->stride]);
+  } else {
+    for (i = 0; i < n; i++)
+      b->vec.data[i] = p_vec->data[(k - n + i) * p_vec->stride];
+    b->seq += k;
+    b->seq -= b->seq % n; // the oldest sample is at position 0
+    b->head = 0;
+    buffer_rebuild(b);
+  }
+  return self;
+}
+
+// The samples from the oldest to the newest, as a new Vector
+static mrb_value mrb_buffer_to_vector(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b = mrb_buffer_get_data(mrb, self);
+  gsl_vector *p_res;
+  size_t n = b->vec.size, tail = n - b->head;
+  mrb_value res = mrb_gsl_vector_new_uninit(mrb, n);
+
+  mrb_vector_get_data(mrb, res, &p_res);
+  memcpy(p_res->data, b->vec.data + b->head, tail * sizeof(double));
+  memcpy(p_res->data + tail, b->vec.data, b->head * sizeof(double));
+  return res;
+}
+
+static mrb_value mrb_buffer_to_a(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b = mrb_buffer_get_data(mrb, self);
+  size_t i, n = b->vec.size;
+  mrb_value res = mrb_ary_new_capa(mrb, n);
+  int ai = mrb_gc_arena_save(mrb);
+  for (i = 0; i < n; i++) {
+    mrb_ary_push(mrb, res,
+                 mrb_float_value(mrb, b->vec.data[(b->head + i) % n]));
+    mrb_gc_arena_restore(mrb, ai);
+  }
+  return res;
+}
+
+// From the oldest sample to the newest. The struct is fetched again at
+// each step, as the block could push into the buffer
+static mrb_value mrb_buffer_each(mrb_state *mrb, mrb_value self) {
+  mrb_value blk;
+  buffer_data_s *b;
+  size_t i, first;
+  int ai;
+
+  mrb_get_args(mrb, "&", &blk);
+  if (mrb_nil_p(blk)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a block");
+  }
+  ai = mrb_gc_arena_save(mrb);
+  b = mrb_buffer_get_data(mrb, self);
+  first = b->head;
+  for (i = 0; i < b->vec.size; i++) {
+    mrb_yield(mrb, blk, mrb_float_value(mrb, b->vec.data[(first + i) %
+                                                          b->vec.size]));
+    mrb_gc_arena_restore(mrb, ai);
+    b = mrb_buffer_get_data(mrb, self);
+  }
+  return self;
+}
+
+#pragma mark -
+#pragma mark • Statistics
+
+// Signed sum of the window, unlike Vector#sum (the BLAS dasum, i.e. the sum
+// of the absolute values)
+static mrb_value mrb_buffer_sum(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b = buffer_synced(mrb, self);
+  return mrb_float_value(mrb, b->sum + b->shift * b->vec.size);
+}
+
+static mrb_value mrb_buffer_mean(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b = buffer_synced(mrb, self);
+  return mrb_float_value(mrb, b->shift + b->sum / b->vec.size);
+}
+
+// Sample variance of the window; with a given mean it falls back to a scan
+static double buffer_variance(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b;
+  mrb_float m;
+  double var;
+  size_t n;
+
+  if (mrb_get_args(mrb, "|f", &m) == 1) {
+    b = mrb_buffer_get_data(mrb, self);
+    return gsl_stats_variance_m(b->vec.data, 1, b->vec.size, m);
+  }
+  b = buffer_synced(mrb, self);
+  n = b->vec.size;
+  var = (b->sumsq - b->sum * b->sum / n) / (n - 1);
+  return var > 0 ? var : 0;
+}
+
+static mrb_value mrb_buffer_variance(mrb_state *mrb, mrb_value self) {
+  return mrb_float_value(mrb, buffer_variance(mrb, self));
+}
+
+static mrb_value mrb_buffer_sd(mrb_state *mrb, mrb_value self) {
+  return mrb_float_value(mrb, sqrt(buffer_variance(mrb, self)));
+}
+
+static mrb_value mrb_buffer_max(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b = buffer_synced(mrb, self);
+  return mrb_float_value(mrb, buffer_at(b, b->max.seq[b->max.head]));
+}
+
+static mrb_value mrb_buffer_min(mrb_state *mrb, mrb_value self) {
+  buffer_data_s *b = buffer_synced(mrb, self);
+  return mrb_float_value(mrb, buffer_at(b, b->min.seq[b->min.head]));
+}
+
+#pragma mark -
+#pragma mark • Gem setup
+
+void mrb_gsl_buffer_init(mrb_state *mrb) {
+  struct RClass *buf;
+
+  buf = mrb_define_class(mrb, "Buffer", mrb_gsl_vector_class);
+  mrb_gsl_buffer_class = buf;
+  MRB_SET_INSTANCE_TT(buf, MRB_TT_DATA);
+  mrb_define_method(mrb, buf, "initialize", mrb_buffer_initialize,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, buf, "head", mrb_buffer_head, MRB_ARGS_NONE());
+  mrb_define_method(mrb, buf, "[]", mrb_buffer_get_i, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, buf, "[]=", mrb_buffer_set_i, MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, buf, "<<", mrb_buffer_push, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, buf, "push_many", mrb_buffer_push_many,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, buf, "to_vector", mrb_buffer_to_vector,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, buf, "to_a", mrb_buffer_to_a, MRB_ARGS_NONE());
+  mrb_define_method(mrb, buf, "each", mrb_buffer_each, MRB_ARGS_BLOCK());
+  mrb_define_method(mrb, buf, "sum", mrb_buffer_sum, MRB_ARGS_NONE());
+  mrb_define_method(mrb, buf, "mean", mrb_buffer_mean, MRB_ARGS_NONE());
+  mrb_define_method(mrb, buf, "variance", mrb_buffer_variance,
+                    MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, buf, "sd", mrb_buffer_sd, MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, buf, "max", mrb_buffer_max, MRB_ARGS_NONE());
+  mrb_define_method(mrb, buf, "min", mrb_buffer_min, MRB_ARGS_NONE());
+}
@@ -0,0 +1,68 @@
+/***************************************************************************/
+/*                                                                         */
+/* buffer.h - Circular buffer class for mruby                              */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef BUFFER_H
+#define BUFFER_H
+
+#include <gsl/gsl_vector.h>
+
+#include "mruby.h"
+#include "mruby/class.h"
+#include "mruby/value.h"
+
+extern struct RClass *mrb_gsl_buffer_class;
+
+/***********************************************\
+ CIRCULAR BUFFER
+\***********************************************/
+
+// A monotonic deque of sample numbers, for the running min and max
+typedef struct {
+  size_t *seq;
+  size_t head, len;
+} buffer_deque_s;
+
+// A Buffer is a Vector whose storage is used as a ring. The gsl_vector
+// comes first, so that the struct can be passed to the Vector methods (and
+// to gsl_vector_free, which releases the whole allocation). The deques are
+// allocated in the same block, after the struct
+typedef struct {
+  gsl_vector vec;
+  size_t head;         // position of the oldest sample, where << writes
+  size_t seq;          // number of the next sample; head == seq % size
+  double shift;        // the running sums are of (x - shift)
+  double sum, sumsq;
+  size_t since_sync;   // samples pushed since the sums were recomputed
+  int dirty;           // storage written by Vector methods
+  buffer_deque_s max, min;
+} buffer_data_s;
+
+// Marks the running statistics of self as stale, if it is a Buffer
+void mrb_gsl_buffer_dirty(mrb_state *mrb, mrb_value self);
+
+// Rotates the storage of self, if it is a Buffer, so that it goes from the
+// oldest sample to the newest: called by mrb_vector_get_data, so that every
+// Vector method reads (and writes) a Buffer in order. Views of a Buffer are
+// only meaningful until the next push
+void mrb_gsl_buffer_linearize(mrb_state *mrb, mrb_value self);
+
+// Must be called after mrb_gsl_vector_init
+void mrb_gsl_buffer_init(mrb_state *mrb);
+
+#endif // BUFFER_H
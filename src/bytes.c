@@ -0,0 +1,272 @@
+/***************************************************************************/
+/*                                                                         */
+/* bytes.c - packed binary import/export for Vector and Matrix             */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include "matrix.h"
+#include "vector.h"
+#include "bytes.h"
+
+#pragma mark -
+#pragma mark • Utilities
+
+// Constant-folded by the compiler
+static int host_is_le(void) {
+  const uint16_t one = 1;
+  return *(const uint8_t *)&one == 1;
+}
+
+static uint64_t swap64(uint64_t x) {
+  x = ((x & 0x00000000FFFFFFFFULL) << 32) | (x >> 32);
+  x = ((x & 0x0000FFFF0000FFFFULL) << 16) | ((x >> 16) & 0x0000FFFF0000FFFFULL);
+  return ((x & 0x00FF00FF00FF00FFULL) << 8) | ((x >> 8) & 0x00FF00FF00FF00FFULL);
+}
+
+static uint32_t swap32(uint32_t x) {
+  x = (x << 16) | (x >> 16);
+  return ((x & 0x00FF00FFU) << 8) | ((x >> 8) & 0x00FF00FFU);
+}
+
+// String bytes need not be aligned: elements are moved with memcpy, which
+// compiles to plain loads and stores
+void mrb_gsl_pack(const double *src, size_t stride, size_t n, char *dst,
+                  mrb_bool f32) {
+  size_t i;
+  if (!f32 && stride == 1 && host_is_le()) {
+    memcpy(dst, src, n * sizeof(double));
+    return;
+  }
+  for (i = 0; i < n; i++) {
+    if (f32) {
+      float f = (float)src[i * stride];
+      uint32_t u;
+      memcpy(&u, &f, 4);
+      if (!host_is_le())
+        u = swap32(u);
+      memcpy(dst + i * 4, &u, 4);
+    } else {
+      uint64_t u;
+      memcpy(&u, src + i * stride, 8);
+      if (!host_is_le())
+        u = swap64(u);
+      memcpy(dst + i * 8, &u, 8);
+    }
+  }
+}
+
+void mrb_gsl_unpack(const char *src, size_t n, double *dst, size_t stride,
+                    mrb_bool f32) {
+  size_t i;
+  if (!f32 && stride == 1 && host_is_le()) {
+    memcpy(dst, src, n * sizeof(double));
+    return;
+  }
+  for (i = 0; i < n; i++) {
+    if (f32) {
+      float f;
+      uint32_t u;
+      memcpy(&u, src + i * 4, 4);
+      if (!host_is_le())
+        u = swap32(u);
+      memcpy(&f, &u, 4);
+      dst[i * stride] = f;
+    } else {
+      uint64_t u;
+      memcpy(&u, src + i * 8, 8);
+      if (!host_is_le())
+        u = swap64(u);
+      memcpy(dst + i * stride, &u, 8);
+    }
+  }
+}
+
+// Element type, given as an optional :f64 (default) or :f32 argument
+mrb_bool mrb_gsl_bytes_f32(mrb_state *mrb, mrb_value dtype) {
+  if (mrb_nil_p(dtype) || (mrb_symbol_p(dtype) &&
+                           mrb_symbol(dtype) == mrb_intern_lit(mrb, "f64")))
+    return 0;
+  if (mrb_symbol_p(dtype) && mrb_symbol(dtype) == mrb_intern_lit(mrb, "f32"))
+    return 1;
+  mrb_raise(mrb, E_ARGUMENT_ERROR, "Element type must be :f64 or :f32");
+}
+
+mrb_bool mrb_gsl_bytes_fit(mrb_int len, mrb_int rows, mrb_int cols,
+                           size_t w) {
+  // cols is bounded first, so that the product can't wrap around
+  if (rows <= 0 || cols <= 0 || len <= 0 ||
+      (uint64_t)cols > (uint64_t)len / w / (uint64_t)rows)
+    return 0;
+  return (uint64_t)len == (uint64_t)rows * (uint64_t)cols * w;
+}
+
+mrb_value mrb_gsl_bytes_str_new(mrb_state *mrb, size_t len) {
+  mrb_value str = mrb_str_buf_new(mrb, len);
+  mrb_str_resize(mrb, str, len);
+  return str;
+}
+
+#pragma mark -
+#pragma mark • Vector
+
+// Vector.from_bytes(str, dtype = :f64)
+static mrb_value mrb_vector_s_from_bytes(mrb_state *mrb, mrb_value klass) {
+  mrb_value str, dtype = mrb_nil_value(), result;
+  gsl_vector *p_vec = NULL;
+  mrb_bool f32;
+  size_t w, n;
+
+  mrb_get_args(mrb, "S|o", &str, &dtype);
+  f32 = mrb_gsl_bytes_f32(mrb, dtype);
+  w = f32 ? 4 : 8;
+  n = RSTRING_LEN(str) / w;
+  if (n == 0 || RSTRING_LEN(str) % w) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "String length is not a multiple of "
+                                     "the element size");
+  }
+  result = mrb_gsl_vector_new_uninit(mrb, n);
+  mrb_vector_get_data(mrb, result, &p_vec);
+  mrb_gsl_unpack(RSTRING_PTR(str), n, p_vec->data, 1, f32);
+  return result;
+}
+
+// Vector#to_bytes(dtype = :f64)
+static mrb_value mrb_vector_to_bytes(mrb_state *mrb, mrb_value self) {
+  mrb_value dtype = mrb_nil_value(), str;
+  gsl_vector *p_vec = NULL;
+  mrb_bool f32;
+
+  mrb_get_args(mrb, "|o", &dtype);
+  f32 = mrb_gsl_bytes_f32(mrb, dtype);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  str = mrb_gsl_bytes_str_new(mrb, p_vec->size * (f32 ? 4 : 8));
+  mrb_gsl_pack(p_vec->data, p_vec->stride, p_vec->size, RSTRING_PTR(str),
+               f32);
+  return str;
+}
+
+// Vector#load_bytes!(str, dtype = :f64), str must match the vector size
+static mrb_value mrb_vector_load_bytes(mrb_state *mrb, mrb_value self) {
+  mrb_value str, dtype = mrb_nil_value();
+  gsl_vector *p_vec = NULL;
+  mrb_bool f32;
+
+  mrb_get_args(mrb, "S|o", &str, &dtype);
+  f32 = mrb_gsl_bytes_f32(mrb, dtype);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  if (RSTRING_LEN(str) != p_vec->size * (f32 ? 4 : 8)) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "String length does not match the size");
+  }
+  mrb_gsl_unpack(RSTRING_PTR(str), p_vec->size, p_vec->data, p_vec->stride,
+                 f32);
+  mrb_gsl_touch(mrb, self);
+  return self;
+}
+
+#pragma mark -
+#pragma mark • Matrix
+
+// Matrix.from_bytes(str, rows, cols, dtype = :f64), row-major
+static mrb_value mrb_matrix_s_from_bytes(mrb_state *mrb, mrb_value klass) {
+  mrb_value str, dtype = mrb_nil_value(), result;
+  gsl_matrix *p_mat = NULL;
+  mrb_int rows, cols;
+  mrb_bool f32;
+
+  mrb_get_args(mrb, "Sii|o", &str, &rows, &cols, &dtype);
+  f32 = mrb_gsl_bytes_f32(mrb, dtype);
+  if (!mrb_gsl_bytes_fit(RSTRING_LEN(str), rows, cols, f32 ? 4 : 8)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "String length does not match the size");
+  }
+  result = mrb_gsl_matrix_new_uninit(mrb, rows, cols);
+  mrb_matrix_get_data(mrb, result, &p_mat);
+  mrb_gsl_unpack(RSTRING_PTR(str), rows * cols, p_mat->data, 1, f32);
+  return result;
+}
+
+// Matrix#to_bytes(dtype = :f64), row-major
+static mrb_value mrb_matrix_to_bytes(mrb_state *mrb, mrb_value self) {
+  mrb_value dtype = mrb_nil_value(), str;
+  gsl_matrix *p_mat = NULL;
+  size_t i, w;
+  mrb_bool f32;
+
+  mrb_get_args(mrb, "|o", &dtype);
+  f32 = mrb_gsl_bytes_f32(mrb, dtype);
+  w = f32 ? 4 : 8;
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  str = mrb_gsl_bytes_str_new(mrb, p_mat->size1 * p_mat->size2 * w);
+  if (p_mat->tda == p_mat->size2) {
+    mrb_gsl_pack(p_mat->data, 1, p_mat->size1 * p_mat->size2,
+                 RSTRING_PTR(str), f32);
+  } else {
+    for (i = 0; i < p_mat->size1; i++) {
+      mrb_gsl_pack(p_mat->data + i * p_mat->tda, 1, p_mat->size2,
+                   RSTRING_PTR(str) + i * p_mat->size2 * w, f32);
+    }
+  }
+  return str;
+}
+
+// Matrix#load_bytes!(str, dtype = :f64), str must match the matrix size
+static mrb_value mrb_matrix_load_bytes(mrb_state *mrb, mrb_value self) {
+  mrb_value str, dtype = mrb_nil_value();
+  gsl_matrix *p_mat = NULL;
+  size_t i, w;
+  mrb_bool f32;
+
+  mrb_get_args(mrb, "S|o", &str, &dtype);
+  f32 = mrb_gsl_bytes_f32(mrb, dtype);
+  w = f32 ? 4 : 8;
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  if (RSTRING_LEN(str) != p_mat->size1 * p_mat->size2 * w) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "String length does not match the size");
+  }
+  if (p_mat->tda == p_mat->size2) {
+    mrb_gsl_unpack(RSTRING_PTR(str), p_mat->size1 * p_mat->size2,
+                   p_mat->data, 1, f32);
+  } else {
+    for (i = 0; i < p_mat->size1; i++) {
+      mrb_gsl_unpack(RSTRING_PTR(str) + i * p_mat->size2 * w, p_mat->size2,
+                     p_mat->data + i * p_mat->tda, 1, f32);
+    }
+  }
+  mrb_gsl_touch(mrb, self);
+  return self;
+}
+
+#pragma mark -
+#pragma mark • Gem setup
+
+void mrb_gsl_bytes_init(mrb_state *mrb) {
+  struct RClass *vec = mrb_gsl_vector_class, *mat = mrb_gsl_matrix_class;
+
+  mrb_define_class_method(mrb, vec, "from_bytes", mrb_vector_s_from_bytes,
+                          MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, vec, "to_bytes", mrb_vector_to_bytes,
+                    MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, vec, "load_bytes!", mrb_vector_load_bytes,
+                    MRB_ARGS_ARG(1, 1));
+
+  mrb_define_class_method(mrb, mat, "from_bytes", mrb_matrix_s_from_bytes,
+                          MRB_ARGS_ARG(3, 1));
+  mrb_define_method(mrb, mat, "to_bytes", mrb_matrix_to_bytes,
+                    MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, mat, "load_bytes!", mrb_matrix_load_bytes,
+                    MRB_ARGS_ARG(1, 1));
+}
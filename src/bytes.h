@@ -0,0 +1,57 @@
+/***************************************************************************/
+/*                                                                         */
+/* bytes.h - packed binary import/export for Vector and Matrix             */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef BYTES_H
+#define BYTES_H
+
+#include <stddef.h>
+
+#include "mruby.h"
+
+/***********************************************\
+ Binary strings
+\***********************************************/
+
+// Packs n doubles, read with stride from src, into dst as little-endian
+// float64 (or float32 when f32 is true)
+void mrb_gsl_pack(const double *src, size_t stride, size_t n, char *dst,
+                  mrb_bool f32);
+
+// Unpacks n little-endian float64 (or float32) from src into dst, written
+// with stride
+void mrb_gsl_unpack(const char *src, size_t n, double *dst, size_t stride,
+                    mrb_bool f32);
+
+// Element type of an optional dtype argument: false for nil or :f64, true
+// for :f32. Raises ArgumentError otherwise
+mrb_bool mrb_gsl_bytes_f32(mrb_state *mrb, mrb_value dtype);
+
+// Whether a String of len bytes holds exactly rows x cols elements of w
+// bytes each, without overflowing the product
+mrb_bool mrb_gsl_bytes_fit(mrb_int len, mrb_int rows, mrb_int cols,
+                           size_t w);
+
+// A new String of len bytes, to be filled by mrb_gsl_pack
+mrb_value mrb_gsl_bytes_str_new(mrb_state *mrb, size_t len);
+
+// Adds from_bytes, to_bytes and load_bytes! to Vector and Matrix: it must
+// be called after mrb_gsl_vector_init and mrb_gsl_matrix_init
+void mrb_gsl_bytes_init(mrb_state *mrb);
+
+#endif // BYTES_H
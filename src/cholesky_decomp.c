@@ -0,0 +1,299 @@
+/***************************************************************************/
+/*                                                                         */
+/* cholesky_decomp.c - Cholesky Decomposition class for mruby              */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_linalg.h>
+#include <stdio.h>
+#include "matrix.h"
+#include "vector.h"
+#include "lapack.h"
+#include "cholesky_decomp.h"
+
+#pragma mark -
+#pragma mark • Utilities
+
+// Garbage collector handler
+void cholesky_decomp_destructor(mrb_state *mrb, void *p_) {
+  cholesky_decomp_data_s *ch = (cholesky_decomp_data_s *)p_;
+  if (!ch)
+    return;
+  gsl_matrix_free(ch->mat);
+  free(ch);
+};
+
+// Creating data type and reference for GC, in a const struct
+const struct mrb_data_type cholesky_decomp_data_type = {
+    "cholesky_decomp_data", cholesky_decomp_destructor};
+
+// Utility function for getting the struct out of self
+void mrb_cholesky_decomp_get_data(mrb_state *mrb, mrb_value self,
+                                  cholesky_decomp_data_s **data) {
+  *data = (cholesky_decomp_data_s *)mrb_data_get_ptr(
+      mrb, self, &cholesky_decomp_data_type);
+  if (!*data)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access decomposition data");
+}
+
+#pragma mark -
+#pragma mark • Initializations
+
+// Copies matrix into the decomposition data and factorizes it in place. The
+// existing buffer is reused when the size matches
+static void cholesky_factorize(mrb_state *mrb, mrb_value self,
+                               mrb_value matrix) {
+  cholesky_decomp_data_s *p_data = NULL;
+  gsl_matrix *p_mat = NULL;
+  mrb_int n;
+
+  if (!mrb_obj_is_kind_of(mrb, matrix, mrb_gsl_matrix_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a Matrix");
+  }
+
+  mrb_matrix_get_data(mrb, matrix, &p_mat);
+  if (p_mat->size1 != p_mat->size2) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a square Matrix");
+  }
+  n = p_mat->size1;
+
+  p_data = (cholesky_decomp_data_s *)DATA_PTR(self);
+  if (!p_data || p_data->size != (size_t)n) {
+    // if data already exists, free its content:
+    if (p_data) {
+      cholesky_decomp_destructor(mrb, p_data);
+    }
+    mrb_data_init(self, NULL, &cholesky_decomp_data_type);
+    p_data = (cholesky_decomp_data_s *)malloc(sizeof(cholesky_decomp_data_s));
+    if (!p_data) {
+      mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate decomposition data");
+    }
+    p_data->mat = gsl_matrix_alloc(n, n);
+    p_data->size = n;
+    if (!p_data->mat) {
+      free(p_data);
+      mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate decomposition data");
+    }
+    // Attach struct to self before factorizing, so that it is freed on error
+    mrb_data_init(self, p_data, &cholesky_decomp_data_type);
+  }
+  gsl_matrix_memcpy(p_data->mat, p_mat);
+  if (mrb_gsl_cholesky_decomp(p_data->mat)) {
+    // the half-factorized data is dropped, so that self can't be used
+    // until it is updated with a valid matrix
+    cholesky_decomp_destructor(mrb, p_data);
+    mrb_data_init(self, NULL, &cholesky_decomp_data_type);
+    mrb_raise(mrb, E_CHOLESKY_DECOMP_ERROR,
+              "Matrix is not positive definite");
+  }
+}
+
+// Data Initializer C function (not exposed!)
+static mrb_value mrb_cholesky_initialize(mrb_state *mrb, mrb_value self) {
+  mrb_value matrix;
+  mrb_get_args(mrb, "o", &matrix);
+  cholesky_factorize(mrb, self, matrix);
+  return mrb_nil_value();
+}
+
+static mrb_value mrb_cholesky_update(mrb_state *mrb, mrb_value self) {
+  mrb_value matrix;
+  mrb_get_args(mrb, "o", &matrix);
+  cholesky_factorize(mrb, self, matrix);
+  return self;
+}
+
+#pragma mark -
+#pragma mark • Accessors
+
+static mrb_value mrb_cholesky_size(mrb_state *mrb, mrb_value self) {
+  cholesky_decomp_data_s *p_data = NULL;
+  mrb_cholesky_decomp_get_data(mrb, self, &p_data);
+  return mrb_fixnum_value(p_data->size);
+}
+
+// Packed factor: L in the lower triangle, L' in the upper one
+static mrb_value mrb_cholesky_matrix(mrb_state *mrb, mrb_value self) {
+  mrb_value result;
+  cholesky_decomp_data_s *p_data = NULL;
+  gsl_matrix *p_res = NULL;
+
+  mrb_cholesky_decomp_get_data(mrb, self, &p_data);
+  result = mrb_gsl_matrix_new_uninit(mrb, p_data->size, p_data->size);
+  mrb_matrix_get_data(mrb, result, &p_res);
+  gsl_matrix_memcpy(p_res, p_data->mat);
+  return result;
+}
+
+#pragma mark -
+#pragma mark • Operations
+
+// det(A) = prod(L(i,i))^2
+static mrb_value mrb_cholesky_det(mrb_state *mrb, mrb_value self) {
+  cholesky_decomp_data_s *p_data = NULL;
+  double det = 1;
+  size_t i;
+
+  mrb_cholesky_decomp_get_data(mrb, self, &p_data);
+  for (i = 0; i < p_data->size; i++) {
+    det *= gsl_matrix_get(p_data->mat, i, i);
+  }
+  return mrb_float_value(mrb, det * det);
+}
+
+// int gsl_linalg_cholesky_invert (gsl_matrix * cholesky)
+static mrb_value mrb_cholesky_invert(mrb_state *mrb, mrb_value self) {
+  mrb_value result;
+  cholesky_decomp_data_s *p_data = NULL;
+  gsl_matrix *p_res = NULL;
+
+  mrb_cholesky_decomp_get_data(mrb, self, &p_data);
+  result = mrb_gsl_matrix_new_uninit(mrb, p_data->size, p_data->size);
+  mrb_matrix_get_data(mrb, result, &p_res);
+  gsl_matrix_memcpy(p_res, p_data->mat);
+  if (gsl_linalg_cholesky_invert(p_res)) {
+    mrb_raise(mrb, E_CHOLESKY_DECOMP_ERROR, "Singular matrix");
+  }
+  return result;
+}
+
+// Solves L L' X = B for all the columns of B at once, in place, with two
+// blocked triangular solves
+static void cholesky_solve_matrix(const cholesky_decomp_data_s *p_data,
+                                  gsl_matrix *B) {
+  gsl_blas_dtrsm(CblasLeft, CblasLower, CblasNoTrans, CblasNonUnit, 1.0,
+                 p_data->mat, B);
+  gsl_blas_dtrsm(CblasLeft, CblasLower, CblasTrans, CblasNonUnit, 1.0,
+                 p_data->mat, B);
+}
+
+// int gsl_linalg_cholesky_solve (const gsl_matrix * cholesky,
+// const gsl_vector * b, gsl_vector * x)
+// With a Matrix argument, solves for each of its columns
+static mrb_value mrb_cholesky_solve(mrb_state *mrb, mrb_value self) {
+  mrb_value result, b_vec;
+  cholesky_decomp_data_s *p_data = NULL;
+  gsl_vector *p_res = NULL, *p_b = NULL;
+  gsl_matrix *p_bm = NULL, *p_resm = NULL;
+
+  mrb_get_args(mrb, "o", &b_vec);
+  mrb_cholesky_decomp_get_data(mrb, self, &p_data);
+  if (mrb_obj_is_kind_of(mrb, b_vec, mrb_gsl_matrix_class)) {
+    mrb_matrix_get_data(mrb, b_vec, &p_bm);
+    if (p_bm->size1 != p_data->size) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Matrix sizes don't match");
+    }
+    result = mrb_gsl_matrix_new_uninit(mrb, p_bm->size1, p_bm->size2);
+    mrb_matrix_get_data(mrb, result, &p_resm);
+    gsl_matrix_memcpy(p_resm, p_bm);
+    cholesky_solve_matrix(p_data, p_resm);
+    return result;
+  }
+  if (!mrb_obj_is_kind_of(mrb, b_vec, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a Vector or a Matrix");
+  }
+  mrb_vector_get_data(mrb, b_vec, &p_b);
+  if (p_b->size != p_data->size) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Vector sizes don't match");
+  }
+
+  result = mrb_gsl_vector_new_uninit(mrb, p_data->size);
+  mrb_vector_get_data(mrb, result, &p_res);
+  if (gsl_linalg_cholesky_solve(p_data->mat, p_b, p_res)) {
+    mrb_raise(mrb, E_CHOLESKY_DECOMP_ERROR, "Singular matrix");
+  }
+  return result;
+}
+
+// int gsl_linalg_cholesky_svx (const gsl_matrix * cholesky, gsl_vector * x)
+// Overwrites the argument (a Vector or a Matrix of right hand sides) with
+// the solution
+static mrb_value mrb_cholesky_solve_bang(mrb_state *mrb, mrb_value self) {
+  mrb_value b;
+  cholesky_decomp_data_s *p_data = NULL;
+  gsl_vector *p_b = NULL;
+  gsl_matrix *p_bm = NULL;
+
+  mrb_get_args(mrb, "o", &b);
+  mrb_cholesky_decomp_get_data(mrb, self, &p_data);
+  if (mrb_obj_is_kind_of(mrb, b, mrb_gsl_matrix_class)) {
+    mrb_matrix_get_data(mrb, b, &p_bm);
+    if (p_bm->size1 != p_data->size) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Matrix sizes don't match");
+    }
+    cholesky_solve_matrix(p_data, p_bm);
+  } else if (mrb_obj_is_kind_of(mrb, b, mrb_gsl_vector_class)) {
+    mrb_vector_get_data(mrb, b, &p_b);
+    if (p_b->size != p_data->size) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Vector sizes don't match");
+    }
+    if (gsl_linalg_cholesky_svx(p_data->mat, p_b)) {
+      mrb_raise(mrb, E_CHOLESKY_DECOMP_ERROR, "Singular matrix");
+    }
+  } else {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Argument must be a Vector or a Matrix");
+  }
+  mrb_gsl_touch(mrb, b);
+  return b;
+}
+
+static mrb_value mrb_cholesky_solve_into(mrb_state *mrb, mrb_value self) {
+  mrb_value b_vec, x_vec;
+  cholesky_decomp_data_s *p_data = NULL;
+  gsl_vector *p_b = NULL, *p_x = NULL;
+
+  mrb_get_args(mrb, "oo", &b_vec, &x_vec);
+  if (!mrb_obj_is_kind_of(mrb, b_vec, mrb_gsl_vector_class) ||
+      !mrb_obj_is_kind_of(mrb, x_vec, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Arguments must be Vectors");
+  }
+  mrb_cholesky_decomp_get_data(mrb, self, &p_data);
+  mrb_vector_get_data(mrb, b_vec, &p_b);
+  mrb_vector_get_data(mrb, x_vec, &p_x);
+  if (p_b->size != p_data->size || p_x->size != p_data->size) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Vector sizes don't match");
+  }
+  if (gsl_linalg_cholesky_solve(p_data->mat, p_b, p_x)) {
+    mrb_raise(mrb, E_CHOLESKY_DECOMP_ERROR, "Singular matrix");
+  }
+  mrb_gsl_touch(mrb, x_vec);
+  return x_vec;
+}
+
+#pragma mark -
+#pragma mark • Gem setup
+
+void mrb_gsl_cholesky_decomp_init(mrb_state *mrb) {
+  struct RClass *ch;
+
+  mrb_load_string(mrb, "class CholeskyDecompError < Exception; end");
+
+  ch = mrb_define_class(mrb, "CholeskyDecomp", mrb->object_class);
+  MRB_SET_INSTANCE_TT(ch, MRB_TT_DATA);
+  mrb_define_method(mrb, ch, "initialize", mrb_cholesky_initialize,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, ch, "update!", mrb_cholesky_update, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, ch, "size", mrb_cholesky_size, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ch, "matrix", mrb_cholesky_matrix, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ch, "inv", mrb_cholesky_invert, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ch, "det", mrb_cholesky_det, MRB_ARGS_NONE());
+  mrb_define_method(mrb, ch, "solve", mrb_cholesky_solve, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, ch, "solve!", mrb_cholesky_solve_bang,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, ch, "solve_into", mrb_cholesky_solve_into,
+                    MRB_ARGS_REQ(2));
+}
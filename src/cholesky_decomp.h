@@ -0,0 +1,54 @@
+/***************************************************************************/
+/*                                                                         */
+/* cholesky_decomp.h - Cholesky Decomposition class for mruby              */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef CHOLESKY_DECOMP_H
+#define CHOLESKY_DECOMP_H
+
+#include <stdlib.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+
+#include "mruby.h"
+#include "mruby/variable.h"
+#include "mruby/data.h"
+#include "mruby/class.h"
+#include "mruby/value.h"
+#include "mruby/compile.h"
+
+#define E_CHOLESKY_DECOMP_ERROR (mrb_class_get(mrb, "CholeskyDecompError"))
+
+/***********************************************\
+ Cholesky Decomposition
+\***********************************************/
+
+typedef struct {
+  gsl_matrix *mat;
+  size_t size;
+} cholesky_decomp_data_s;
+
+// Garbage collector handler
+void cholesky_decomp_destructor(mrb_state *mrb, void *p_);
+
+// Utility function for getting the struct out of self (an MRB_TT_DATA object)
+void mrb_cholesky_decomp_get_data(mrb_state *mrb, mrb_value self,
+                                  cholesky_decomp_data_s **data);
+
+void mrb_gsl_cholesky_decomp_init(mrb_state *mrb);
+
+#endif // CHOLESKY_DECOMP_H
@@ -0,0 +1,1159 @@
+/***************************************************************************/
+/*                                                                         */
+/* complex_vector.c - Complex vectors and matrices for mruby               */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#include <math.h>
+#include <gsl/gsl_blas.h>
+#include "mruby/hash.h"
+#include "vector.h"
+#include "matrix.h"
+#include "bytes.h"
+#include "complex_vector.h"
+
+#pragma mark -
+#pragma mark • Utilities
+
+// Garbage collector handlers
+void complex_vector_destructor(mrb_state *mrb, void *p_) {
+  gsl_vector_complex *v = (gsl_vector_complex *)p_;
+  if (v)
+    gsl_vector_complex_free(v);
+};
+
+void complex_matrix_destructor(mrb_state *mrb, void *p_) {
+  gsl_matrix_complex *m = (gsl_matrix_complex *)p_;
+  if (m)
+    gsl_matrix_complex_free(m);
+};
+
+// Creating data types and references for GC, in const structs
+const struct mrb_data_type complex_vector_data_type = {
+    "complex_vector_data", complex_vector_destructor};
+const struct mrb_data_type complex_matrix_data_type = {
+    "complex_matrix_data", complex_matrix_destructor};
+
+struct RClass *mrb_gsl_complex_vector_class = NULL;
+struct RClass *mrb_gsl_complex_matrix_class = NULL;
+
+void mrb_complex_vector_get_data(mrb_state *mrb, mrb_value self,
+                                 gsl_vector_complex **data) {
+  *data = (gsl_vector_complex *)mrb_data_get_ptr(mrb, self,
+                                                 &complex_vector_data_type);
+  if (!*data)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access vector data");
+}
+
+void mrb_complex_matrix_get_data(mrb_state *mrb, mrb_value self,
+                                 gsl_matrix_complex **data) {
+  *data = (gsl_matrix_complex *)mrb_data_get_ptr(mrb, self,
+                                                 &complex_matrix_data_type);
+  if (!*data)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access matrix data");
+}
+
+mrb_value mrb_gsl_complex_vector_new_uninit(mrb_state *mrb, mrb_int n) {
+  struct RData *data;
+  gsl_vector_complex *p_vec;
+
+  // Create the object first, so that the struct can't leak if GC kicks in
+  data = mrb_data_object_alloc(mrb, mrb_gsl_complex_vector_class, NULL,
+                               &complex_vector_data_type);
+  p_vec = gsl_vector_complex_alloc(n);
+  if (!p_vec)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate vector data");
+  data->data = p_vec;
+  return mrb_obj_value(data);
+}
+
+mrb_value mrb_gsl_complex_matrix_new_uninit(mrb_state *mrb, mrb_int n,
+                                            mrb_int m) {
+  struct RData *data;
+  gsl_matrix_complex *p_mat;
+
+  data = mrb_data_object_alloc(mrb, mrb_gsl_complex_matrix_class, NULL,
+                               &complex_matrix_data_type);
+  p_mat = gsl_matrix_complex_alloc(n, m);
+  if (!p_mat)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate matrix data");
+  data->data = p_mat;
+  return mrb_obj_value(data);
+}
+
+gsl_complex mrb_gsl_to_complex(mrb_state *mrb, mrb_value v) {
+  gsl_complex z;
+  if (mrb_float_p(v) || mrb_fixnum_p(v)) {
+    GSL_SET_COMPLEX(&z, mrb_gsl_to_f(mrb, v), 0);
+  } else if (mrb_array_p(v) && RARRAY_LEN(v) == 2) {
+    GSL_SET_COMPLEX(&z, mrb_gsl_to_f(mrb, mrb_ary_ref(mrb, v, 0)),
+                    mrb_gsl_to_f(mrb, mrb_ary_ref(mrb, v, 1)));
+  } else if (mrb_respond_to(mrb, v, mrb_intern_lit(mrb, "imaginary"))) {
+    GSL_SET_COMPLEX(&z, mrb_gsl_to_f(mrb, mrb_funcall(mrb, v, "real", 0)),
+                    mrb_gsl_to_f(mrb, mrb_funcall(mrb, v, "imaginary", 0)));
+  } else {
+    mrb_raise(mrb, E_ARGUMENT_ERROR,
+              "Need a Numeric, a [re, im] Array or a Complex");
+  }
+  return z;
+}
+
+mrb_value mrb_gsl_complex_value(mrb_state *mrb, gsl_complex z) {
+  mrb_value pair[2];
+  pair[0] = mrb_float_value(mrb, GSL_REAL(z));
+  pair[1] = mrb_float_value(mrb, GSL_IMAG(z));
+  return mrb_ary_new_from_values(mrb, 2, pair);
+}
+
+// Element-wise kernel on interleaved complex data: for i in 0...n,
+// out[i*so] = a[i*sa] <op> b[i*sb], with strides counted in doubles and
+// op one of '+', '-', '*', '/'. b is real (no imaginary parts) if b_real;
+// a scalar b has sb = 0. out may alias a or b
+static void complex_elementwise(char op, size_t n, double *out, size_t so,
+                                const double *a, size_t sa, const double *b,
+                                size_t sb, int b_real) {
+  double ar, ai, br, bi, d;
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    ar = a[i * sa];
+    ai = a[i * sa + 1];
+    br = b[i * sb];
+    bi = b_real ? 0 : b[i * sb + 1];
+    switch (op) {
+    case '+':
+      out[i * so] = ar + br;
+      out[i * so + 1] = ai + bi;
+      break;
+    case '-':
+      out[i * so] = ar - br;
+      out[i * so + 1] = ai - bi;
+      break;
+    case '*':
+      out[i * so] = ar * br - ai * bi;
+      out[i * so + 1] = ai * br + ar * bi;
+      break;
+    default:
+      d = br * br + bi * bi;
+      out[i * so] = (ar * br + ai * bi) / d;
+      out[i * so + 1] = (ai * br - ar * bi) / d;
+      break;
+    }
+  }
+}
+
+// Unary kernels: out (real, stride so) = abs or arg of a, or a (complex)
+// conjugated in place
+static void complex_abs(size_t n, double *out, size_t so, const double *a,
+                        size_t sa) {
+  size_t i;
+  for (i = 0; i < n; i++)
+    out[i * so] = hypot(a[i * sa], a[i * sa + 1]);
+}
+
+static void complex_arg(size_t n, double *out, size_t so, const double *a,
+                        size_t sa) {
+  size_t i;
+  for (i = 0; i < n; i++)
+    out[i * so] = atan2(a[i * sa + 1], a[i * sa]);
+}
+
+static void complex_conj(size_t n, double *a, size_t sa) {
+  size_t i;
+  for (i = 0; i < n; i++)
+    a[i * sa + 1] = -a[i * sa + 1];
+}
+
+// trans_a: and trans_b: options of gemm!: true or :conj
+static CBLAS_TRANSPOSE_t complex_trans(mrb_state *mrb, mrb_value opts,
+                                       const char *key) {
+  mrb_value v;
+  if (!mrb_hash_p(opts))
+    return CblasNoTrans;
+  v = mrb_hash_get(mrb, opts, mrb_symbol_value(mrb_intern_cstr(mrb, key)));
+  if (mrb_symbol_p(v) && mrb_symbol(v) == mrb_intern_lit(mrb, "conj"))
+    return CblasConjTrans;
+  return mrb_test(v) ? CblasTrans : CblasNoTrans;
+}
+
+#pragma mark -
+#pragma mark • ComplexVector
+
+static mrb_value mrb_complex_vector_initialize(mrb_state *mrb,
+                                              mrb_value self) {
+  gsl_vector_complex *p_vec;
+  mrb_int n;
+
+  mrb_get_args(mrb, "i", &n);
+  p_vec = (gsl_vector_complex *)DATA_PTR(self);
+  if (p_vec) {
+    complex_vector_destructor(mrb, p_vec);
+  }
+  mrb_data_init(self, NULL, &complex_vector_data_type);
+  p_vec = gsl_vector_complex_calloc(n);
+  if (!p_vec)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate vector data");
+  mrb_data_init(self, p_vec, &complex_vector_data_type);
+  return mrb_nil_value();
+}
+
+// ComplexVector[[1, 2], 3, ...]
+static mrb_value mrb_complex_vector_s_new_from(mrb_state *mrb,
+                                              mrb_value klass) {
+  mrb_value *argv, result;
+  mrb_int argc, i;
+  gsl_vector_complex *p_vec;
+
+  mrb_get_args(mrb, "*", &argv, &argc);
+  result = mrb_gsl_complex_vector_new_uninit(mrb, argc);
+  mrb_complex_vector_get_data(mrb, result, &p_vec);
+  for (i = 0; i < argc; i++) {
+    gsl_vector_complex_set(p_vec, i, mrb_gsl_to_complex(mrb, argv[i]));
+  }
+  return result;
+}
+
+static mrb_value mrb_complex_vector_length(mrb_state *mrb, mrb_value self) {
+  gsl_vector_complex *p_vec;
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  return mrb_fixnum_value(p_vec->size);
+}
+
+static mrb_value mrb_complex_vector_dup(mrb_state *mrb, mrb_value self) {
+  gsl_vector_complex *p_vec, *p_other;
+  mrb_value other;
+
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  other = mrb_gsl_complex_vector_new_uninit(mrb, p_vec->size);
+  mrb_complex_vector_get_data(mrb, other, &p_other);
+  gsl_vector_complex_memcpy(p_other, p_vec);
+  return other;
+}
+
+static mrb_value mrb_complex_vector_equal(mrb_state *mrb, mrb_value self) {
+  gsl_vector_complex *p_vec, *p_other;
+  mrb_value other;
+
+  mrb_get_args(mrb, "o", &other);
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  mrb_complex_vector_get_data(mrb, other, &p_other);
+  return mrb_bool_value(p_vec->size == p_other->size &&
+                        gsl_vector_complex_equal(p_vec, p_other));
+}
+
+static mrb_value mrb_complex_vector_get_i(mrb_state *mrb, mrb_value self) {
+  gsl_vector_complex *p_vec;
+  mrb_int i;
+
+  mrb_get_args(mrb, "i", &i);
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  if (i < 0 || i >= p_vec->size) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Vector index out of range!");
+  }
+  return mrb_gsl_complex_value(mrb, gsl_vector_complex_get(p_vec, i));
+}
+
+static mrb_value mrb_complex_vector_set_i(mrb_state *mrb, mrb_value self) {
+  gsl_vector_complex *p_vec;
+  mrb_value z;
+  mrb_int i;
+
+  mrb_get_args(mrb, "io", &i, &z);
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  if (i < 0 || i >= p_vec->size) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Vector index out of range!");
+  }
+  gsl_vector_complex_set(p_vec, i, mrb_gsl_to_complex(mrb, z));
+  return z;
+}
+
+// Array of [re, im] pairs
+static mrb_value mrb_complex_vector_to_a(mrb_state *mrb, mrb_value self) {
+  gsl_vector_complex *p_vec;
+  mrb_value ary;
+  size_t i;
+  int ai;
+
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  ary = mrb_ary_new_capa(mrb, p_vec->size);
+  ai = mrb_gc_arena_save(mrb);
+  for (i = 0; i < p_vec->size; i++) {
+    mrb_ary_push(mrb, ary,
+                 mrb_gsl_complex_value(mrb, gsl_vector_complex_get(p_vec, i)));
+    mrb_gc_arena_restore(mrb, ai);
+  }
+  return ary;
+}
+
+static mrb_value mrb_complex_vector_zero(mrb_state *mrb, mrb_value self) {
+  gsl_vector_complex *p_vec;
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  gsl_vector_complex_set_zero(p_vec);
+  return self;
+}
+
+static mrb_value mrb_complex_vector_all(mrb_state *mrb, mrb_value self) {
+  gsl_vector_complex *p_vec;
+  mrb_value z;
+
+  mrb_get_args(mrb, "o", &z);
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  gsl_vector_complex_set_all(p_vec, mrb_gsl_to_complex(mrb, z));
+  return self;
+}
+
+// Real and imaginary parts, as VectorViews sharing the storage of self
+static mrb_value mrb_complex_vector_real(mrb_state *mrb, mrb_value self) {
+  gsl_vector_complex *p_vec;
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  return mrb_gsl_vector_view_new(mrb, self, gsl_vector_complex_real(p_vec));
+}
+
+static mrb_value mrb_complex_vector_imag(mrb_state *mrb, mrb_value self) {
+  gsl_vector_complex *p_vec;
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  return mrb_gsl_vector_view_new(mrb, self, gsl_vector_complex_imag(p_vec));
+}
+
+static mrb_value complex_vector_unary(mrb_state *mrb, mrb_value self,
+                                      int arg) {
+  gsl_vector_complex *p_vec;
+  gsl_vector *p_res;
+  mrb_value res;
+
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  res = mrb_gsl_vector_new_uninit(mrb, p_vec->size);
+  mrb_vector_get_data(mrb, res, &p_res);
+  if (arg)
+    complex_arg(p_vec->size, p_res->data, 1, p_vec->data, 2 * p_vec->stride);
+  else
+    complex_abs(p_vec->size, p_res->data, 1, p_vec->data, 2 * p_vec->stride);
+  return res;
+}
+
+// Modulus, as a Vector
+static mrb_value mrb_complex_vector_abs(mrb_state *mrb, mrb_value self) {
+  return complex_vector_unary(mrb, self, 0);
+}
+
+// Phase in (-pi, pi], as a Vector
+static mrb_value mrb_complex_vector_arg(mrb_state *mrb, mrb_value self) {
+  return complex_vector_unary(mrb, self, 1);
+}
+
+static mrb_value mrb_complex_vector_conj_bang(mrb_state *mrb,
+                                             mrb_value self) {
+  gsl_vector_complex *p_vec;
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  complex_conj(p_vec->size, p_vec->data, 2 * p_vec->stride);
+  return self;
+}
+
+static mrb_value mrb_complex_vector_conj(mrb_state *mrb, mrb_value self) {
+  mrb_value res = mrb_complex_vector_dup(mrb, self);
+  return mrb_complex_vector_conj_bang(mrb, res);
+}
+
+// out = a <op> other, with other a ComplexVector, a Vector or a scalar
+static void complex_vector_apply(mrb_state *mrb, char op,
+                                 gsl_vector_complex *out,
+                                 gsl_vector_complex *a, mrb_value other) {
+  gsl_vector_complex *p_other;
+  gsl_vector *p_real;
+  gsl_complex z;
+
+  if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_complex_vector_class)) {
+    mrb_complex_vector_get_data(mrb, other, &p_other);
+    if (p_other->size != a->size) {
+      mrb_raise(mrb, E_VECTOR_ERROR, "Vector dimensions don't match!");
+    }
+    complex_elementwise(op, a->size, out->data, 2 * out->stride, a->data,
+                        2 * a->stride, p_other->data, 2 * p_other->stride, 0);
+  } else if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_vector_class)) {
+    mrb_vector_get_data(mrb, other, &p_real);
+    if (p_real->size != a->size) {
+      mrb_raise(mrb, E_VECTOR_ERROR, "Vector dimensions don't match!");
+    }
+    complex_elementwise(op, a->size, out->data, 2 * out->stride, a->data,
+                        2 * a->stride, p_real->data, p_real->stride, 1);
+  } else {
+    z = mrb_gsl_to_complex(mrb, other);
+    complex_elementwise(op, a->size, out->data, 2 * out->stride, a->data,
+                        2 * a->stride, z.dat, 0, 0);
+  }
+}
+
+static mrb_value complex_vector_op_bang(mrb_state *mrb, mrb_value self,
+                                        char op) {
+  gsl_vector_complex *p_vec;
+  mrb_value other;
+
+  mrb_get_args(mrb, "o", &other);
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  complex_vector_apply(mrb, op, p_vec, p_vec, other);
+  return self;
+}
+
+static mrb_value complex_vector_op(mrb_state *mrb, mrb_value self, char op) {
+  gsl_vector_complex *p_vec, *p_res;
+  mrb_value other, res;
+
+  mrb_get_args(mrb, "o", &other);
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  res = mrb_gsl_complex_vector_new_uninit(mrb, p_vec->size);
+  mrb_complex_vector_get_data(mrb, res, &p_res);
+  complex_vector_apply(mrb, op, p_res, p_vec, other);
+  return res;
+}
+
+static mrb_value mrb_complex_vector_add(mrb_state *mrb, mrb_value self) {
+  return complex_vector_op_bang(mrb, self, '+');
+}
+
+static mrb_value mrb_complex_vector_sub(mrb_state *mrb, mrb_value self) {
+  return complex_vector_op_bang(mrb, self, '-');
+}
+
+static mrb_value mrb_complex_vector_mul(mrb_state *mrb, mrb_value self) {
+  return complex_vector_op_bang(mrb, self, '*');
+}
+
+static mrb_value mrb_complex_vector_div(mrb_state *mrb, mrb_value self) {
+  return complex_vector_op_bang(mrb, self, '/');
+}
+
+static mrb_value mrb_complex_vector_plus(mrb_state *mrb, mrb_value self) {
+  return complex_vector_op(mrb, self, '+');
+}
+
+static mrb_value mrb_complex_vector_minus(mrb_state *mrb, mrb_value self) {
+  return complex_vector_op(mrb, self, '-');
+}
+
+static mrb_value mrb_complex_vector_times(mrb_state *mrb, mrb_value self) {
+  return complex_vector_op(mrb, self, '*');
+}
+
+static mrb_value mrb_complex_vector_over(mrb_state *mrb, mrb_value self) {
+  return complex_vector_op(mrb, self, '/');
+}
+
+static mrb_value complex_vector_dot(mrb_state *mrb, mrb_value self,
+                                    int conj) {
+  gsl_vector_complex *p_vec, *p_other;
+  mrb_value other;
+  gsl_complex z;
+  int status;
+
+  mrb_get_args(mrb, "o", &other);
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  mrb_complex_vector_get_data(mrb, other, &p_other);
+  if (conj)
+    status = gsl_blas_zdotc(p_vec, p_other, &z);
+  else
+    status = gsl_blas_zdotu(p_vec, p_other, &z);
+  if (status) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Vector dimensions don't match!");
+  }
+  return mrb_gsl_complex_value(mrb, z);
+}
+
+// conj(self) . other (zdotc)
+static mrb_value mrb_complex_vector_dotc(mrb_state *mrb, mrb_value self) {
+  return complex_vector_dot(mrb, self, 1);
+}
+
+// self . other, not conjugated (zdotu)
+static mrb_value mrb_complex_vector_dotu(mrb_state *mrb, mrb_value self) {
+  return complex_vector_dot(mrb, self, 0);
+}
+
+static mrb_value mrb_complex_vector_norm(mrb_state *mrb, mrb_value self) {
+  gsl_vector_complex *p_vec;
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  return mrb_float_value(mrb, gsl_blas_dznrm2(p_vec));
+}
+
+// ComplexVector.from_bytes(str, dtype = :f64), interleaved re, im
+static mrb_value mrb_complex_vector_s_from_bytes(mrb_state *mrb,
+                                                mrb_value klass) {
+  mrb_value str, dtype = mrb_nil_value(), result;
+  gsl_vector_complex *p_vec;
+  mrb_bool f32;
+  size_t w, n;
+
+  mrb_get_args(mrb, "S|o", &str, &dtype);
+  f32 = mrb_gsl_bytes_f32(mrb, dtype);
+  w = f32 ? 8 : 16;
+  n = RSTRING_LEN(str) / w;
+  if (n == 0 || RSTRING_LEN(str) % w) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "String length is not a multiple of "
+                                     "the element size");
+  }
+  result = mrb_gsl_complex_vector_new_uninit(mrb, n);
+  mrb_complex_vector_get_data(mrb, result, &p_vec);
+  mrb_gsl_unpack(RSTRING_PTR(str), 2 * n, p_vec->data, 1, f32);
+  return result;
+}
+
+// ComplexVector#to_bytes(dtype = :f64), interleaved re, im
+static mrb_value mrb_complex_vector_to_bytes(mrb_state *mrb, mrb_value self) {
+  mrb_value dtype = mrb_nil_value(), str;
+  gsl_vector_complex *p_vec;
+  mrb_bool f32;
+  size_t i, w;
+
+  mrb_get_args(mrb, "|o", &dtype);
+  f32 = mrb_gsl_bytes_f32(mrb, dtype);
+  w = f32 ? 4 : 8;
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  str = mrb_gsl_bytes_str_new(mrb, 2 * p_vec->size * w);
+  if (p_vec->stride == 1) {
+    mrb_gsl_pack(p_vec->data, 1, 2 * p_vec->size, RSTRING_PTR(str), f32);
+  } else {
+    for (i = 0; i < p_vec->size; i++)
+      mrb_gsl_pack(p_vec->data + 2 * i * p_vec->stride, 1, 2,
+                   RSTRING_PTR(str) + 2 * i * w, f32);
+  }
+  return str;
+}
+
+// ComplexVector#load_bytes!(str, dtype = :f64)
+static mrb_value mrb_complex_vector_load_bytes(mrb_state *mrb,
+                                              mrb_value self) {
+  mrb_value str, dtype = mrb_nil_value();
+  gsl_vector_complex *p_vec;
+  mrb_bool f32;
+  size_t i, w;
+
+  mrb_get_args(mrb, "S|o", &str, &dtype);
+  f32 = mrb_gsl_bytes_f32(mrb, dtype);
+  w = f32 ? 4 : 8;
+  mrb_complex_vector_get_data(mrb, self, &p_vec);
+  if (RSTRING_LEN(str) != 2 * p_vec->size * w) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "String length does not match the size");
+  }
+  if (p_vec->stride == 1) {
+    mrb_gsl_unpack(RSTRING_PTR(str), 2 * p_vec->size, p_vec->data, 1, f32);
+  } else {
+    for (i = 0; i < p_vec->size; i++)
+      mrb_gsl_unpack(RSTRING_PTR(str) + 2 * i * w, 2,
+                     p_vec->data + 2 * i * p_vec->stride, 1, f32);
+  }
+  return self;
+}
+
+// Vector#to_complex(imag = nil)
+static mrb_value mrb_vector_to_complex(mrb_state *mrb, mrb_value self) {
+  mrb_value imag = mrb_nil_value(), res;
+  gsl_vector *p_vec, *p_imag = NULL;
+  gsl_vector_complex *p_res;
+  size_t i;
+
+  mrb_get_args(mrb, "|o", &imag);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  if (!mrb_nil_p(imag)) {
+    mrb_vector_get_data(mrb, imag, &p_imag);
+    if (p_imag->size != p_vec->size) {
+      mrb_raise(mrb, E_VECTOR_ERROR, "Vector dimensions don't match!");
+    }
+  }
+  res = mrb_gsl_complex_vector_new_uninit(mrb, p_vec->size);
+  mrb_complex_vector_get_data(mrb, res, &p_res);
+  for (i = 0; i < p_vec->size; i++) {
+    p_res->data[2 * i] = p_vec->data[i * p_vec->stride];
+    p_res->data[2 * i + 1] = p_imag ? p_imag->data[i * p_imag->stride] : 0;
+  }
+  return res;
+}
+
+#pragma mark -
+#pragma mark • ComplexMatrix
+
+static mrb_value mrb_complex_matrix_initialize(mrb_state *mrb,
+                                              mrb_value self) {
+  gsl_matrix_complex *p_mat;
+  mrb_int n, m;
+
+  mrb_get_args(mrb, "ii", &n, &m);
+  p_mat = (gsl_matrix_complex *)DATA_PTR(self);
+  if (p_mat) {
+    complex_matrix_destructor(mrb, p_mat);
+  }
+  mrb_data_init(self, NULL, &complex_matrix_data_type);
+  p_mat = gsl_matrix_complex_calloc(n, m);
+  if (!p_mat)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate matrix data");
+  mrb_data_init(self, p_mat, &complex_matrix_data_type);
+  return mrb_nil_value();
+}
+
+static mrb_value mrb_complex_matrix_nrows(mrb_state *mrb, mrb_value self) {
+  gsl_matrix_complex *p_mat;
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  return mrb_fixnum_value(p_mat->size1);
+}
+
+static mrb_value mrb_complex_matrix_ncols(mrb_state *mrb, mrb_value self) {
+  gsl_matrix_complex *p_mat;
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  return mrb_fixnum_value(p_mat->size2);
+}
+
+static mrb_value mrb_complex_matrix_dup(mrb_state *mrb, mrb_value self) {
+  gsl_matrix_complex *p_mat, *p_other;
+  mrb_value other;
+
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  other = mrb_gsl_complex_matrix_new_uninit(mrb, p_mat->size1, p_mat->size2);
+  mrb_complex_matrix_get_data(mrb, other, &p_other);
+  gsl_matrix_complex_memcpy(p_other, p_mat);
+  return other;
+}
+
+static mrb_value mrb_complex_matrix_equal(mrb_state *mrb, mrb_value self) {
+  gsl_matrix_complex *p_mat, *p_other;
+  mrb_value other;
+
+  mrb_get_args(mrb, "o", &other);
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  mrb_complex_matrix_get_data(mrb, other, &p_other);
+  return mrb_bool_value(p_mat->size1 == p_other->size1 &&
+                        p_mat->size2 == p_other->size2 &&
+                        gsl_matrix_complex_equal(p_mat, p_other));
+}
+
+static mrb_value mrb_complex_matrix_get_ij(mrb_state *mrb, mrb_value self) {
+  gsl_matrix_complex *p_mat;
+  mrb_int i, j;
+
+  mrb_get_args(mrb, "ii", &i, &j);
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  if (i < 0 || j < 0 || i >= p_mat->size1 || j >= p_mat->size2) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix index out of range!");
+  }
+  return mrb_gsl_complex_value(mrb, gsl_matrix_complex_get(p_mat, i, j));
+}
+
+static mrb_value mrb_complex_matrix_set_ij(mrb_state *mrb, mrb_value self) {
+  gsl_matrix_complex *p_mat;
+  mrb_value z;
+  mrb_int i, j;
+
+  mrb_get_args(mrb, "iio", &i, &j, &z);
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  if (i < 0 || j < 0 || i >= p_mat->size1 || j >= p_mat->size2) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix index out of range!");
+  }
+  gsl_matrix_complex_set(p_mat, i, j, mrb_gsl_to_complex(mrb, z));
+  return z;
+}
+
+// Array of rows, each an Array of [re, im] pairs
+static mrb_value mrb_complex_matrix_to_a(mrb_state *mrb, mrb_value self) {
+  gsl_matrix_complex *p_mat;
+  mrb_value ary, row;
+  size_t i, j;
+  int ai;
+
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  ary = mrb_ary_new_capa(mrb, p_mat->size1);
+  ai = mrb_gc_arena_save(mrb);
+  for (i = 0; i < p_mat->size1; i++) {
+    row = mrb_ary_new_capa(mrb, p_mat->size2);
+    mrb_ary_push(mrb, ary, row);
+    for (j = 0; j < p_mat->size2; j++) {
+      mrb_ary_push(mrb, row, mrb_gsl_complex_value(
+                                 mrb, gsl_matrix_complex_get(p_mat, i, j)));
+    }
+    mrb_gc_arena_restore(mrb, ai);
+  }
+  return ary;
+}
+
+static mrb_value mrb_complex_matrix_zero(mrb_state *mrb, mrb_value self) {
+  gsl_matrix_complex *p_mat;
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  gsl_matrix_complex_set_zero(p_mat);
+  return self;
+}
+
+static mrb_value mrb_complex_matrix_identity(mrb_state *mrb,
+                                            mrb_value self) {
+  gsl_matrix_complex *p_mat;
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  gsl_matrix_complex_set_identity(p_mat);
+  return self;
+}
+
+static mrb_value mrb_complex_matrix_all(mrb_state *mrb, mrb_value self) {
+  gsl_matrix_complex *p_mat;
+  mrb_value z;
+
+  mrb_get_args(mrb, "o", &z);
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  gsl_matrix_complex_set_all(p_mat, mrb_gsl_to_complex(mrb, z));
+  return self;
+}
+
+// Real or imaginary parts (part = 0 or 1), abs (2) or arg (3), as a new
+// Matrix: the parts of a complex matrix are not contiguous along rows, so
+// that they can't be viewed by a Matrix
+static mrb_value complex_matrix_unary(mrb_state *mrb, mrb_value self,
+                                      int part) {
+  gsl_matrix_complex *p_mat;
+  gsl_matrix *p_res;
+  mrb_value res;
+  double *row, *out;
+  size_t i, j, n;
+
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  n = p_mat->size2;
+  res = mrb_gsl_matrix_new_uninit(mrb, p_mat->size1, n);
+  mrb_matrix_get_data(mrb, res, &p_res);
+  for (i = 0; i < p_mat->size1; i++) {
+    row = p_mat->data + 2 * i * p_mat->tda;
+    out = p_res->data + i * p_res->tda;
+    if (part == 2) {
+      complex_abs(n, out, 1, row, 2);
+    } else if (part == 3) {
+      complex_arg(n, out, 1, row, 2);
+    } else {
+      for (j = 0; j < n; j++)
+        out[j] = row[2 * j + part];
+    }
+  }
+  return res;
+}
+
+static mrb_value mrb_complex_matrix_real(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_unary(mrb, self, 0);
+}
+
+static mrb_value mrb_complex_matrix_imag(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_unary(mrb, self, 1);
+}
+
+static mrb_value mrb_complex_matrix_abs(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_unary(mrb, self, 2);
+}
+
+static mrb_value mrb_complex_matrix_arg(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_unary(mrb, self, 3);
+}
+
+static mrb_value mrb_complex_matrix_conj_bang(mrb_state *mrb,
+                                             mrb_value self) {
+  gsl_matrix_complex *p_mat;
+  size_t i;
+
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  for (i = 0; i < p_mat->size1; i++)
+    complex_conj(p_mat->size2, p_mat->data + 2 * i * p_mat->tda, 2);
+  return self;
+}
+
+static mrb_value mrb_complex_matrix_conj(mrb_state *mrb, mrb_value self) {
+  mrb_value res = mrb_complex_matrix_dup(mrb, self);
+  return mrb_complex_matrix_conj_bang(mrb, res);
+}
+
+// Transpose (t) and conjugate transpose (h)
+static mrb_value complex_matrix_transpose(mrb_state *mrb, mrb_value self,
+                                          int conj) {
+  gsl_matrix_complex *p_mat, *p_res;
+  mrb_value res;
+
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  res = mrb_gsl_complex_matrix_new_uninit(mrb, p_mat->size2, p_mat->size1);
+  mrb_complex_matrix_get_data(mrb, res, &p_res);
+  if (conj)
+    gsl_matrix_complex_conjtrans_memcpy(p_res, p_mat);
+  else
+    gsl_matrix_complex_transpose_memcpy(p_res, p_mat);
+  return res;
+}
+
+static mrb_value mrb_complex_matrix_t(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_transpose(mrb, self, 0);
+}
+
+static mrb_value mrb_complex_matrix_h(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_transpose(mrb, self, 1);
+}
+
+// out = a <op> other, with other a ComplexMatrix, a Matrix or a scalar
+static void complex_matrix_apply(mrb_state *mrb, char op,
+                                 gsl_matrix_complex *out,
+                                 gsl_matrix_complex *a, mrb_value other) {
+  gsl_matrix_complex *p_other = NULL;
+  gsl_matrix *p_real = NULL;
+  gsl_complex z;
+  size_t i, n = a->size2;
+
+  if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_complex_matrix_class)) {
+    mrb_complex_matrix_get_data(mrb, other, &p_other);
+    if (p_other->size1 != a->size1 || p_other->size2 != n) {
+      mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+    }
+  } else if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_matrix_class)) {
+    mrb_matrix_get_data(mrb, other, &p_real);
+    if (p_real->size1 != a->size1 || p_real->size2 != n) {
+      mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+    }
+  } else {
+    z = mrb_gsl_to_complex(mrb, other);
+  }
+  for (i = 0; i < a->size1; i++) {
+    if (p_other)
+      complex_elementwise(op, n, out->data + 2 * i * out->tda, 2,
+                          a->data + 2 * i * a->tda, 2,
+                          p_other->data + 2 * i * p_other->tda, 2, 0);
+    else if (p_real)
+      complex_elementwise(op, n, out->data + 2 * i * out->tda, 2,
+                          a->data + 2 * i * a->tda, 2,
+                          p_real->data + i * p_real->tda, 1, 1);
+    else
+      complex_elementwise(op, n, out->data + 2 * i * out->tda, 2,
+                          a->data + 2 * i * a->tda, 2, z.dat, 0, 0);
+  }
+}
+
+static mrb_value complex_matrix_op_bang(mrb_state *mrb, mrb_value self,
+                                        char op) {
+  gsl_matrix_complex *p_mat;
+  mrb_value other;
+
+  mrb_get_args(mrb, "o", &other);
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  complex_matrix_apply(mrb, op, p_mat, p_mat, other);
+  return self;
+}
+
+static mrb_value complex_matrix_op(mrb_state *mrb, mrb_value self, char op) {
+  gsl_matrix_complex *p_mat, *p_res;
+  mrb_value other, res;
+
+  mrb_get_args(mrb, "o", &other);
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  res = mrb_gsl_complex_matrix_new_uninit(mrb, p_mat->size1, p_mat->size2);
+  mrb_complex_matrix_get_data(mrb, res, &p_res);
+  complex_matrix_apply(mrb, op, p_res, p_mat, other);
+  return res;
+}
+
+static mrb_value mrb_complex_matrix_add(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_op_bang(mrb, self, '+');
+}
+
+static mrb_value mrb_complex_matrix_sub(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_op_bang(mrb, self, '-');
+}
+
+static mrb_value mrb_complex_matrix_mul(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_op_bang(mrb, self, '*');
+}
+
+static mrb_value mrb_complex_matrix_div(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_op_bang(mrb, self, '/');
+}
+
+static mrb_value mrb_complex_matrix_plus(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_op(mrb, self, '+');
+}
+
+static mrb_value mrb_complex_matrix_minus(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_op(mrb, self, '-');
+}
+
+static mrb_value mrb_complex_matrix_times(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_op(mrb, self, '*');
+}
+
+static mrb_value mrb_complex_matrix_over(mrb_state *mrb, mrb_value self) {
+  return complex_matrix_op(mrb, self, '/');
+}
+
+// Matrix product with a ComplexMatrix (zgemm) or a ComplexVector (zgemv)
+static mrb_value mrb_complex_matrix_prod(mrb_state *mrb, mrb_value self) {
+  gsl_matrix_complex *p_mat, *p_other, *p_res;
+  gsl_vector_complex *p_vec, *p_vres;
+  gsl_complex one, zero;
+  mrb_value other, res;
+
+  mrb_get_args(mrb, "o", &other);
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  GSL_SET_COMPLEX(&one, 1, 0);
+  GSL_SET_COMPLEX(&zero, 0, 0);
+  if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_complex_vector_class)) {
+    mrb_complex_vector_get_data(mrb, other, &p_vec);
+    if (p_vec->size != p_mat->size2) {
+      mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+    }
+    res = mrb_gsl_complex_vector_new_uninit(mrb, p_mat->size1);
+    mrb_complex_vector_get_data(mrb, res, &p_vres);
+    gsl_blas_zgemv(CblasNoTrans, one, p_mat, p_vec, zero, p_vres);
+    return res;
+  }
+  mrb_complex_matrix_get_data(mrb, other, &p_other);
+  if (p_other->size1 != p_mat->size2) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+  }
+  res = mrb_gsl_complex_matrix_new_uninit(mrb, p_mat->size1, p_other->size2);
+  mrb_complex_matrix_get_data(mrb, res, &p_res);
+  gsl_blas_zgemm(CblasNoTrans, CblasNoTrans, one, p_mat, p_other, zero,
+                 p_res);
+  return res;
+}
+
+// Whether the storage of c and a overlaps: each element spans two doubles
+static mrb_bool complex_matrix_overlap(const gsl_matrix_complex *c,
+                                       const gsl_matrix_complex *a) {
+  size_t nc = c->size1 && c->size2 ? (c->size1 - 1) * c->tda + c->size2 : 0;
+  size_t na = a->size1 && a->size2 ? (a->size1 - 1) * a->tda + a->size2 : 0;
+  return mrb_gsl_overlap(c->data, 2 * nc, a->data, 2 * na);
+}
+
+// C = alpha * op(A) * op(B) + beta * C, with trans_a:/trans_b: true for the
+// transpose and :conj for the conjugate transpose
+static mrb_value mrb_complex_matrix_gemm(mrb_state *mrb, mrb_value self) {
+  mrb_value alpha, a, b, beta, opts = mrb_nil_value();
+  gsl_matrix_complex *p_mat, *p_a, *p_b;
+
+  mrb_get_args(mrb, "oooo|H", &alpha, &a, &b, &beta, &opts);
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  mrb_complex_matrix_get_data(mrb, a, &p_a);
+  mrb_complex_matrix_get_data(mrb, b, &p_b);
+  if (complex_matrix_overlap(p_mat, p_a) ||
+      complex_matrix_overlap(p_mat, p_b)) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "Output must not alias an operand");
+  }
+  if (gsl_blas_zgemm(complex_trans(mrb, opts, "trans_a"),
+                     complex_trans(mrb, opts, "trans_b"),
+                     mrb_gsl_to_complex(mrb, alpha), p_a, p_b,
+                     mrb_gsl_to_complex(mrb, beta), p_mat)) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+  }
+  return self;
+}
+
+// ComplexMatrix.from_bytes(str, rows, cols, dtype = :f64), row-major,
+// interleaved re, im
+static mrb_value mrb_complex_matrix_s_from_bytes(mrb_state *mrb,
+                                                mrb_value klass) {
+  mrb_value str, dtype = mrb_nil_value(), result;
+  gsl_matrix_complex *p_mat;
+  mrb_int rows, cols;
+  mrb_bool f32;
+
+  mrb_get_args(mrb, "Sii|o", &str, &rows, &cols, &dtype);
+  f32 = mrb_gsl_bytes_f32(mrb, dtype);
+  if (!mrb_gsl_bytes_fit(RSTRING_LEN(str), rows, cols, 2 * (f32 ? 4 : 8))) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "String length does not match the size");
+  }
+  result = mrb_gsl_complex_matrix_new_uninit(mrb, rows, cols);
+  mrb_complex_matrix_get_data(mrb, result, &p_mat);
+  mrb_gsl_unpack(RSTRING_PTR(str), 2 * rows * cols, p_mat->data, 1, f32);
+  return result;
+}
+
+// ComplexMatrix#to_bytes(dtype = :f64)
+static mrb_value mrb_complex_matrix_to_bytes(mrb_state *mrb, mrb_value self) {
+  mrb_value dtype = mrb_nil_value(), str;
+  gsl_matrix_complex *p_mat;
+  size_t i, w, row;
+  mrb_bool f32;
+
+  mrb_get_args(mrb, "|o", &dtype);
+  f32 = mrb_gsl_bytes_f32(mrb, dtype);
+  w = f32 ? 4 : 8;
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  row = 2 * p_mat->size2;
+  str = mrb_gsl_bytes_str_new(mrb, p_mat->size1 * row * w);
+  for (i = 0; i < p_mat->size1; i++) {
+    mrb_gsl_pack(p_mat->data + 2 * i * p_mat->tda, 1, row,
+                 RSTRING_PTR(str) + i * row * w, f32);
+  }
+  return str;
+}
+
+// ComplexMatrix#load_bytes!(str, dtype = :f64)
+static mrb_value mrb_complex_matrix_load_bytes(mrb_state *mrb,
+                                              mrb_value self) {
+  mrb_value str, dtype = mrb_nil_value();
+  gsl_matrix_complex *p_mat;
+  size_t i, w, row;
+  mrb_bool f32;
+
+  mrb_get_args(mrb, "S|o", &str, &dtype);
+  f32 = mrb_gsl_bytes_f32(mrb, dtype);
+  w = f32 ? 4 : 8;
+  mrb_complex_matrix_get_data(mrb, self, &p_mat);
+  row = 2 * p_mat->size2;
+  if (RSTRING_LEN(str) != p_mat->size1 * row * w) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "String length does not match the size");
+  }
+  for (i = 0; i < p_mat->size1; i++) {
+    mrb_gsl_unpack(RSTRING_PTR(str) + i * row * w, row,
+                   p_mat->data + 2 * i * p_mat->tda, 1, f32);
+  }
+  return self;
+}
+
+// Matrix#to_complex(imag = nil)
+static mrb_value mrb_matrix_to_complex(mrb_state *mrb, mrb_value self) {
+  mrb_value imag = mrb_nil_value(), res;
+  gsl_matrix *p_mat, *p_imag = NULL;
+  gsl_matrix_complex *p_res;
+  size_t i, j;
+
+  mrb_get_args(mrb, "|o", &imag);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  if (!mrb_nil_p(imag)) {
+    mrb_matrix_get_data(mrb, imag, &p_imag);
+    if (p_imag->size1 != p_mat->size1 || p_imag->size2 != p_mat->size2) {
+      mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+    }
+  }
+  res = mrb_gsl_complex_matrix_new_uninit(mrb, p_mat->size1, p_mat->size2);
+  mrb_complex_matrix_get_data(mrb, res, &p_res);
+  for (i = 0; i < p_mat->size1; i++) {
+    for (j = 0; j < p_mat->size2; j++) {
+      p_res->data[2 * (i * p_res->tda + j)] = p_mat->data[i * p_mat->tda + j];
+      p_res->data[2 * (i * p_res->tda + j) + 1] =
+          p_imag ? p_imag->data[i * p_imag->tda + j] : 0;
+    }
+  }
+  return res;
+}
+
+#pragma mark -
+#pragma mark • Gem setup
+
+void mrb_gsl_complex_init(mrb_state *mrb) {
+  struct RClass *cv, *cm;
+
+  cv = mrb_define_class(mrb, "ComplexVector", mrb->object_class);
+  mrb_gsl_complex_vector_class = cv;
+  MRB_SET_INSTANCE_TT(cv, MRB_TT_DATA);
+  mrb_define_class_method(mrb, cv, "[]", mrb_complex_vector_s_new_from,
+                          MRB_ARGS_ANY());
+  mrb_define_class_method(mrb, cv, "from_bytes",
+                          mrb_complex_vector_s_from_bytes, MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, cv, "initialize", mrb_complex_vector_initialize,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "length", mrb_complex_vector_length,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cv, "size", mrb_complex_vector_length,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cv, "dup", mrb_complex_vector_dup, MRB_ARGS_NONE());
+  mrb_define_method(mrb, cv, "===", mrb_complex_vector_equal,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "[]", mrb_complex_vector_get_i, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "[]=", mrb_complex_vector_set_i,
+                    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, cv, "to_a", mrb_complex_vector_to_a,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cv, "zero", mrb_complex_vector_zero,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cv, "all", mrb_complex_vector_all, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "real", mrb_complex_vector_real,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cv, "imag", mrb_complex_vector_imag,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cv, "abs", mrb_complex_vector_abs, MRB_ARGS_NONE());
+  mrb_define_method(mrb, cv, "arg", mrb_complex_vector_arg, MRB_ARGS_NONE());
+  mrb_define_method(mrb, cv, "conj", mrb_complex_vector_conj,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cv, "conj!", mrb_complex_vector_conj_bang,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cv, "add!", mrb_complex_vector_add, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "sub!", mrb_complex_vector_sub, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "mul!", mrb_complex_vector_mul, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "div!", mrb_complex_vector_div, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "+", mrb_complex_vector_plus, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "-", mrb_complex_vector_minus, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "*", mrb_complex_vector_times, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "/", mrb_complex_vector_over, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "dotc", mrb_complex_vector_dotc,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "dotu", mrb_complex_vector_dotu,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cv, "norm", mrb_complex_vector_norm,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cv, "to_bytes", mrb_complex_vector_to_bytes,
+                    MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, cv, "load_bytes!", mrb_complex_vector_load_bytes,
+                    MRB_ARGS_ARG(1, 1));
+
+  cm = mrb_define_class(mrb, "ComplexMatrix", mrb->object_class);
+  mrb_gsl_complex_matrix_class = cm;
+  MRB_SET_INSTANCE_TT(cm, MRB_TT_DATA);
+  mrb_define_class_method(mrb, cm, "from_bytes",
+                          mrb_complex_matrix_s_from_bytes, MRB_ARGS_ARG(3, 1));
+  mrb_define_method(mrb, cm, "initialize", mrb_complex_matrix_initialize,
+                    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, cm, "nrows", mrb_complex_matrix_nrows,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "ncols", mrb_complex_matrix_ncols,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "dup", mrb_complex_matrix_dup, MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "===", mrb_complex_matrix_equal,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cm, "[]", mrb_complex_matrix_get_ij,
+                    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, cm, "[]=", mrb_complex_matrix_set_ij,
+                    MRB_ARGS_REQ(3));
+  mrb_define_method(mrb, cm, "to_a", mrb_complex_matrix_to_a,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "zero", mrb_complex_matrix_zero,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "identity", mrb_complex_matrix_identity,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "all", mrb_complex_matrix_all, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cm, "real", mrb_complex_matrix_real,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "imag", mrb_complex_matrix_imag,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "abs", mrb_complex_matrix_abs, MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "arg", mrb_complex_matrix_arg, MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "conj", mrb_complex_matrix_conj,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "conj!", mrb_complex_matrix_conj_bang,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "t", mrb_complex_matrix_t, MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "h", mrb_complex_matrix_h, MRB_ARGS_NONE());
+  mrb_define_method(mrb, cm, "add!", mrb_complex_matrix_add, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cm, "sub!", mrb_complex_matrix_sub, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cm, "mul!", mrb_complex_matrix_mul, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cm, "div!", mrb_complex_matrix_div, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cm, "+", mrb_complex_matrix_plus, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cm, "-", mrb_complex_matrix_minus, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cm, "*", mrb_complex_matrix_times, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cm, "/", mrb_complex_matrix_over, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cm, "^", mrb_complex_matrix_prod, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, cm, "gemm!", mrb_complex_matrix_gemm,
+                    MRB_ARGS_ARG(4, 1));
+  mrb_define_method(mrb, cm, "to_bytes", mrb_complex_matrix_to_bytes,
+                    MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, cm, "load_bytes!", mrb_complex_matrix_load_bytes,
+                    MRB_ARGS_ARG(1, 1));
+
+  mrb_define_method(mrb, mrb_gsl_vector_class, "to_complex",
+                    mrb_vector_to_complex, MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, mrb_gsl_matrix_class, "to_complex",
+                    mrb_matrix_to_complex, MRB_ARGS_OPT(1));
+}
@@ -0,0 +1,67 @@
+/***************************************************************************/
+/*                                                                         */
+/* complex_vector.h - Complex vectors and matrices for mruby               */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef COMPLEX_VECTOR_H
+#define COMPLEX_VECTOR_H
+
+#include <gsl/gsl_complex.h>
+#include <gsl/gsl_vector_complex.h>
+#include <gsl/gsl_matrix_complex.h>
+
+#include "mruby.h"
+#include "mruby/data.h"
+#include "mruby/class.h"
+#include "mruby/value.h"
+
+// ComplexVector and ComplexMatrix classes, cached at gem init
+extern struct RClass *mrb_gsl_complex_vector_class;
+extern struct RClass *mrb_gsl_complex_matrix_class;
+
+/***********************************************\
+ COMPLEX VECTORS AND MATRICES
+\***********************************************/
+
+// Garbage collector handlers
+void complex_vector_destructor(mrb_state *mrb, void *p_);
+void complex_matrix_destructor(mrb_state *mrb, void *p_);
+
+// Utility functions for getting the struct out of self
+void mrb_complex_vector_get_data(mrb_state *mrb, mrb_value self,
+                                 gsl_vector_complex **data);
+void mrb_complex_matrix_get_data(mrb_state *mrb, mrb_value self,
+                                 gsl_matrix_complex **data);
+
+// Fast allocation, bypassing #initialize. Content is NOT zeroed
+mrb_value mrb_gsl_complex_vector_new_uninit(mrb_state *mrb, mrb_int n);
+mrb_value mrb_gsl_complex_matrix_new_uninit(mrb_state *mrb, mrb_int n,
+                                            mrb_int m);
+
+// Complex scalar from a Numeric, a [re, im] Array or an object with real
+// and imaginary (e.g. a Complex)
+gsl_complex mrb_gsl_to_complex(mrb_state *mrb, mrb_value v);
+
+// [re, im]
+mrb_value mrb_gsl_complex_value(mrb_state *mrb, gsl_complex z);
+
+// Adds ComplexVector and ComplexMatrix, and to_complex to Vector and
+// Matrix: it must be called after mrb_gsl_vector_init and
+// mrb_gsl_matrix_init
+void mrb_gsl_complex_init(mrb_state *mrb);
+
+#endif // COMPLEX_VECTOR_H
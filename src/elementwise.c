@@ -0,0 +1,288 @@
+/***************************************************************************/
+/*                                                                         */
+/* elementwise.c - Elementwise math for Vector and Matrix                  */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#include "matrix.h"
+#include "vector.h"
+#include "elementwise.h"
+
+// The kernels never read errno, and without it sqrt and friends can be
+// vectorized. The option is set here only, so that the rest of the gem
+// keeps the default errno behavior
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("no-math-errno")
+#endif
+
+#pragma mark -
+#pragma mark • Kernels
+
+// Each kernel computes out[i] = f(a[i], b[i], c[i]) for n elements, where a
+// is self and b, c are the optional arguments. A scalar argument is passed
+// with stride 0. Unused arguments point to a zero with stride 0.
+typedef void (*ew_kernel)(size_t n, double *out, size_t so, const double *a,
+                          size_t sa, const double *b, size_t sb,
+                          const double *c, size_t sc);
+
+// On x86-64 glibc the kernels are also compiled for Haswell (AVX2 + FMA)
+// and the best version is picked at load time, through an ifunc resolver,
+// which e.g. musl does not support; elsewhere the compiler default (SSE2
+// on x86-64) is used
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 6 &&           \
+    defined(__x86_64__) && defined(__linux__) && defined(__GLIBC__)
+#define EW_TARGETS __attribute__((target_clones("arch=haswell", "default")))
+#else
+#define EW_TARGETS
+#endif
+
+// The loop is expanded three times: with unit strides and vector
+// arguments, with unit strides and scalar arguments, and fully strided
+// (views). The first two have constant strides, so they can be vectorized
+#define EW_LOOP(expr, so, sa, sb, sc)                                         \
+  for (i = 0; i < n; i++) {                                                   \
+    x = a[i * (sa)];                                                          \
+    y = b[i * (sb)];                                                          \
+    z = c[i * (sc)];                                                          \
+    out[i * (so)] = (expr);                                                   \
+  }
+
+#define EW_KERNEL(name, expr)                                                 \
+  EW_TARGETS static void ew_##name(size_t n, double *out, size_t so,          \
+                                   const double *a, size_t sa,                \
+                                   const double *b, size_t sb,                \
+                                   const double *c, size_t sc) {              \
+    size_t i;                                                                 \
+    double x, y, z;                                                           \
+    (void)y;                                                                  \
+    (void)z;                                                                  \
+    if (so == 1 && sa == 1 && sb == 1 && sc == 1) {                           \
+      EW_LOOP(expr, 1, 1, 1, 1)                                               \
+    } else if (so == 1 && sa == 1 && sb == 0 && sc == 0) {                    \
+      EW_LOOP(expr, 1, 1, 0, 0)                                               \
+    } else {                                                                  \
+      EW_LOOP(expr, so, sa, sb, sc)                                           \
+    }                                                                         \
+  }
+
+EW_KERNEL(sin, sin(x))
+EW_KERNEL(cos, cos(x))
+EW_KERNEL(tan, tan(x))
+EW_KERNEL(asin, asin(x))
+EW_KERNEL(acos, acos(x))
+EW_KERNEL(atan, atan(x))
+EW_KERNEL(sinh, sinh(x))
+EW_KERNEL(cosh, cosh(x))
+EW_KERNEL(tanh, tanh(x))
+EW_KERNEL(exp, exp(x))
+EW_KERNEL(expm1, expm1(x))
+EW_KERNEL(log, log(x))
+EW_KERNEL(log1p, log1p(x))
+EW_KERNEL(log10, log10(x))
+EW_KERNEL(sqrt, sqrt(x))
+EW_KERNEL(cbrt, cbrt(x))
+EW_KERNEL(abs, fabs(x))
+EW_KERNEL(square, x * x)
+EW_KERNEL(floor, floor(x))
+EW_KERNEL(ceil, ceil(x))
+EW_KERNEL(round, round(x))
+// -1, 0 or 1; zeros and NaNs are kept as they are
+EW_KERNEL(sign, x > 0 ? 1.0 : (x < 0 ? -1.0 : x))
+EW_KERNEL(pow, pow(x, y))
+EW_KERNEL(atan2, atan2(x, y))
+EW_KERNEL(hypot, hypot(x, y))
+EW_KERNEL(clamp, x < y ? y : (x > z ? z : x))
+// self * b + c, with a single rounding
+EW_KERNEL(fma, fma(x, y, z))
+
+#pragma mark -
+#pragma mark • Dispatch
+
+// An argument of an elementwise method: a Vector, a Matrix or a scalar
+typedef struct {
+  const double *data;
+  size_t stride, tda; // tda is 0 for scalars and Vectors
+  double k;
+} ew_arg;
+
+static const double ew_zero = 0.0;
+
+// Numerics become scalars, other arguments must have the same size as self
+static void ew_arg_get(mrb_state *mrb, mrb_value v, ew_arg *arg,
+                       mrb_bool matrix, size_t size1, size_t size2) {
+  gsl_vector *p_vec;
+  gsl_matrix *p_mat;
+
+  if (mrb_float_p(v) || mrb_fixnum_p(v)) {
+    arg->k = mrb_to_flo(mrb, v);
+    arg->data = &arg->k;
+    arg->stride = arg->tda = 0;
+  } else if (matrix) {
+    if (!mrb_obj_is_kind_of(mrb, v, mrb_gsl_matrix_class)) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Matrix or a Numeric!");
+    }
+    mrb_matrix_get_data(mrb, v, &p_mat);
+    if (p_mat->size1 != size1 || p_mat->size2 != size2) {
+      mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+    }
+    arg->data = p_mat->data;
+    arg->stride = 1;
+    arg->tda = p_mat->tda;
+  } else {
+    if (!mrb_obj_is_kind_of(mrb, v, mrb_gsl_vector_class)) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Vector or a Numeric!");
+    }
+    mrb_vector_get_data(mrb, v, &p_vec);
+    if (p_vec->size != size1) {
+      mrb_raise(mrb, E_VECTOR_ERROR, "Vector dimensions don't match!");
+    }
+    arg->data = p_vec->data;
+    arg->stride = p_vec->stride;
+    arg->tda = 0;
+  }
+}
+
+// Applies fn to self and its argc arguments, writing into self (bang) or
+// into a new object of the same size
+static mrb_value ew_call(mrb_state *mrb, mrb_value self, ew_kernel fn,
+                         mrb_int argc, mrb_bool bang) {
+  static const char *formats[] = {"", "o", "oo"};
+  mrb_value argv[2], result;
+  mrb_int j;
+  ew_arg args[2];
+  gsl_vector *p_vec, *p_out_vec;
+  gsl_matrix *p_mat, *p_out_mat;
+  size_t i;
+
+  mrb_get_args(mrb, formats[argc], &argv[0], &argv[1]);
+  for (j = argc; j < 2; j++) {
+    args[j].data = &ew_zero;
+    args[j].stride = args[j].tda = 0;
+  }
+
+  if (mrb_obj_is_kind_of(mrb, self, mrb_gsl_matrix_class)) {
+    mrb_matrix_get_data(mrb, self, &p_mat);
+    for (j = 0; j < argc; j++)
+      ew_arg_get(mrb, argv[j], &args[j], 1, p_mat->size1, p_mat->size2);
+    result = bang ? self : mrb_gsl_matrix_new_uninit(mrb, p_mat->size1,
+                                                     p_mat->size2);
+    mrb_matrix_get_data(mrb, result, &p_out_mat);
+    // contiguous matrices are swept as a single vector
+    if (p_mat->tda == p_mat->size2 && p_out_mat->tda == p_mat->size2 &&
+        (args[0].tda == 0 || args[0].tda == p_mat->size2) &&
+        (args[1].tda == 0 || args[1].tda == p_mat->size2)) {
+      fn(p_mat->size1 * p_mat->size2, p_out_mat->data, 1, p_mat->data, 1,
+         args[0].data, args[0].stride, args[1].data, args[1].stride);
+    } else {
+      for (i = 0; i < p_mat->size1; i++) {
+        fn(p_mat->size2, p_out_mat->data + i * p_out_mat->tda, 1,
+           p_mat->data + i * p_mat->tda, 1, args[0].data + i * args[0].tda,
+           args[0].stride, args[1].data + i * args[1].tda, args[1].stride);
+      }
+    }
+  } else {
+    mrb_vector_get_data(mrb, self, &p_vec);
+    for (j = 0; j < argc; j++)
+      ew_arg_get(mrb, argv[j], &args[j], 0, p_vec->size, 0);
+    result = bang ? self : mrb_gsl_vector_new_uninit(mrb, p_vec->size);
+    mrb_vector_get_data(mrb, result, &p_out_vec);
+    fn(p_vec->size, p_out_vec->data, p_out_vec->stride, p_vec->data,
+       p_vec->stride, args[0].data, args[0].stride, args[1].data,
+       args[1].stride);
+  }
+  if (bang)
+    mrb_gsl_touch(mrb, self);
+  return result;
+}
+
+#define EW_METHODS(name, argc)                                                \
+  static mrb_value mrb_ew_##name##_bang(mrb_state *mrb, mrb_value self) {     \
+    return ew_call(mrb, self, ew_##name, argc, 1);                            \
+  }                                                                           \
+  static mrb_value mrb_ew_##name(mrb_state *mrb, mrb_value self) {            \
+    return ew_call(mrb, self, ew_##name, argc, 0);                            \
+  }
+
+EW_METHODS(sin, 0)
+EW_METHODS(cos, 0)
+EW_METHODS(tan, 0)
+EW_METHODS(asin, 0)
+EW_METHODS(acos, 0)
+EW_METHODS(atan, 0)
+EW_METHODS(sinh, 0)
+EW_METHODS(cosh, 0)
+EW_METHODS(tanh, 0)
+EW_METHODS(exp, 0)
+EW_METHODS(expm1, 0)
+EW_METHODS(log, 0)
+EW_METHODS(log1p, 0)
+EW_METHODS(log10, 0)
+EW_METHODS(sqrt, 0)
+EW_METHODS(cbrt, 0)
+EW_METHODS(abs, 0)
+EW_METHODS(square, 0)
+EW_METHODS(floor, 0)
+EW_METHODS(ceil, 0)
+EW_METHODS(round, 0)
+EW_METHODS(sign, 0)
+EW_METHODS(pow, 1)
+EW_METHODS(atan2, 1)
+EW_METHODS(hypot, 1)
+EW_METHODS(clamp, 2)
+EW_METHODS(fma, 2)
+
+#pragma mark -
+#pragma mark • Gem setup
+
+#define EW_DEFINE(name, argc)                                                 \
+  mrb_define_method(mrb, mrb_gsl_vector_class, #name "!", mrb_ew_##name##_bang, \
+                    MRB_ARGS_REQ(argc));                                      \
+  mrb_define_method(mrb, mrb_gsl_vector_class, #name, mrb_ew_##name,          \
+                    MRB_ARGS_REQ(argc));                                      \
+  mrb_define_method(mrb, mrb_gsl_matrix_class, #name "!", mrb_ew_##name##_bang, \
+                    MRB_ARGS_REQ(argc));                                      \
+  mrb_define_method(mrb, mrb_gsl_matrix_class, #name, mrb_ew_##name,          \
+                    MRB_ARGS_REQ(argc));
+
+void mrb_gsl_elementwise_init(mrb_state *mrb) {
+  EW_DEFINE(sin, 0)
+  EW_DEFINE(cos, 0)
+  EW_DEFINE(tan, 0)
+  EW_DEFINE(asin, 0)
+  EW_DEFINE(acos, 0)
+  EW_DEFINE(atan, 0)
+  EW_DEFINE(sinh, 0)
+  EW_DEFINE(cosh, 0)
+  EW_DEFINE(tanh, 0)
+  EW_DEFINE(exp, 0)
+  EW_DEFINE(expm1, 0)
+  EW_DEFINE(log, 0)
+  EW_DEFINE(log1p, 0)
+  EW_DEFINE(log10, 0)
+  EW_DEFINE(sqrt, 0)
+  EW_DEFINE(cbrt, 0)
+  EW_DEFINE(abs, 0)
+  EW_DEFINE(square, 0)
+  EW_DEFINE(floor, 0)
+  EW_DEFINE(ceil, 0)
+  EW_DEFINE(round, 0)
+  EW_DEFINE(sign, 0)
+  EW_DEFINE(pow, 1)
+  EW_DEFINE(atan2, 1)
+  EW_DEFINE(hypot, 1)
+  EW_DEFINE(clamp, 2)
+  EW_DEFINE(fma, 2)
+}
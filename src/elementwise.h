@@ -0,0 +1,35 @@
+/***************************************************************************/
+/*                                                                         */
+/* elementwise.h - Elementwise math for Vector and Matrix                  */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef ELEMENTWISE_H
+#define ELEMENTWISE_H
+
+#include <math.h>
+
+#include "mruby.h"
+
+/***********************************************\
+ ELEMENTWISE MATH
+\***********************************************/
+
+// Adds sin!, sin, cos!, ... to Vector and Matrix: it must be called after
+// mrb_gsl_vector_init and mrb_gsl_matrix_init
+void mrb_gsl_elementwise_init(mrb_state *mrb);
+
+#endif // ELEMENTWISE_H
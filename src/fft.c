@@ -0,0 +1,495 @@
+/***************************************************************************/
+/*                                                                         */
+/* fft.c - Fast Fourier transforms for mruby                               */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#include <string.h>
+#include <gsl/gsl_errno.h>
+#include "mruby/hash.h"
+#include "vector.h"
+#include "buffer.h"
+#include "complex_vector.h"
+#include "fft.h"
+
+// Below this length (of the shorter operand) convolutions are computed
+// directly, since the three transforms cost more
+#define CONV_DIRECT_MAX 64
+
+struct RClass *mrb_gsl_fft_class = NULL;
+
+#pragma mark -
+#pragma mark • Utilities
+
+// Garbage collector handler
+void fft_destructor(mrb_state *mrb, void *p_) {
+  fft_s *f = (fft_s *)p_;
+  if (!f)
+    return;
+  if (f->rwt)
+    gsl_fft_real_wavetable_free(f->rwt);
+  if (f->hwt)
+    gsl_fft_halfcomplex_wavetable_free(f->hwt);
+  if (f->work)
+    gsl_fft_real_workspace_free(f->work);
+  free(f->scratch);
+  free(f);
+};
+
+// Creating data type and reference for GC, in a const struct
+const struct mrb_data_type fft_data_type = {"fft_data", fft_destructor};
+
+fft_s *mrb_gsl_fft_get(mrb_state *mrb, mrb_value self) {
+  fft_s *f = (fft_s *)mrb_data_get_ptr(mrb, self, &fft_data_type);
+  if (!f)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access FFT data");
+  return f;
+}
+
+static fft_s *fft_alloc(size_t n) {
+  fft_s *f = (fft_s *)calloc(1, sizeof(fft_s));
+  if (!f)
+    return NULL;
+  f->n = n;
+  f->radix2 = (n & (n - 1)) == 0;
+  f->scratch = (double *)malloc(2 * n * sizeof(double));
+  f->buf = f->scratch + n;
+  if (!f->radix2) {
+    f->rwt = gsl_fft_real_wavetable_alloc(n);
+    f->hwt = gsl_fft_halfcomplex_wavetable_alloc(n);
+    f->work = gsl_fft_real_workspace_alloc(n);
+  }
+  if (!f->scratch || (!f->radix2 && (!f->rwt || !f->hwt || !f->work))) {
+    fft_destructor(NULL, f);
+    return NULL;
+  }
+  return f;
+}
+
+int mrb_gsl_fft_forward(fft_s *f, double *data, size_t stride) {
+  size_t n = f->n, k;
+  int status;
+
+  if (!f->radix2)
+    return gsl_fft_real_transform(data, stride, n, f->rwt, f->work);
+  status = gsl_fft_real_radix2_transform(data, stride, n);
+  if (status || n < 2)
+    return status;
+  // radix-2 packing: r0, r1, ..., r(n/2), i(n/2-1), ..., i1
+  f->scratch[0] = data[0];
+  for (k = 1; k < n / 2; k++) {
+    f->scratch[2 * k - 1] = data[k * stride];
+    f->scratch[2 * k] = data[(n - k) * stride];
+  }
+  f->scratch[n - 1] = data[n / 2 * stride];
+  for (k = 0; k < n; k++)
+    data[k * stride] = f->scratch[k];
+  return GSL_SUCCESS;
+}
+
+int mrb_gsl_fft_inverse(fft_s *f, double *data, size_t stride) {
+  size_t n = f->n, k;
+
+  if (!f->radix2)
+    return gsl_fft_halfcomplex_inverse(data, stride, n, f->hwt, f->work);
+  if (n >= 2) {
+    f->scratch[0] = data[0];
+    for (k = 1; k < n / 2; k++) {
+      f->scratch[k] = data[(2 * k - 1) * stride];
+      f->scratch[n - k] = data[2 * k * stride];
+    }
+    f->scratch[n / 2] = data[(n - 1) * stride];
+    for (k = 0; k < n; k++)
+      data[k * stride] = f->scratch[k];
+  }
+  return gsl_fft_halfcomplex_radix2_inverse(data, stride, n);
+}
+
+// Real and imaginary parts of the k-th coefficient, 0 <= k < n, of a
+// packed halfcomplex sequence
+static void fft_coef(const double *hc, size_t stride, size_t n, size_t k,
+                     double *re, double *im) {
+  int conj = 0;
+  if (k > n / 2) {
+    k = n - k;
+    conj = 1;
+  }
+  if (k == 0) {
+    *re = hc[0];
+    *im = 0;
+  } else if (2 * k == n) {
+    *re = hc[(n - 1) * stride];
+    *im = 0;
+  } else {
+    *re = hc[(2 * k - 1) * stride];
+    *im = hc[2 * k * stride];
+    if (conj)
+      *im = -*im;
+  }
+}
+
+// A Buffer stores its samples as a ring: operands are linearized, oldest
+// sample first
+static mrb_value buffer_linearize(mrb_state *mrb, mrb_value v) {
+  if (mrb_obj_is_kind_of(mrb, v, mrb_gsl_buffer_class))
+    return mrb_funcall(mrb, v, "to_vector", 0);
+  return v;
+}
+
+// Checks the Vector operand *v, replacing a Buffer with its linearized copy
+static gsl_vector *fft_vector_arg(mrb_state *mrb, mrb_value *v, size_t n) {
+  gsl_vector *p_vec;
+  if (!mrb_obj_is_kind_of(mrb, *v, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Vector");
+  }
+  *v = buffer_linearize(mrb, *v);
+  mrb_vector_get_data(mrb, *v, &p_vec);
+  if (p_vec->size != n) {
+    mrb_raise(mrb, E_FFT_ERROR, "Vector size does not match the FFT size");
+  }
+  return p_vec;
+}
+
+#pragma mark -
+#pragma mark • Initializations
+
+static mrb_value mrb_fft_initialize(mrb_state *mrb, mrb_value self) {
+  mrb_int n;
+  fft_s *f;
+
+  mrb_get_args(mrb, "i", &n);
+  if (n <= 0) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "FFT size must be positive");
+  }
+  f = (fft_s *)DATA_PTR(self);
+  if (f) {
+    fft_destructor(mrb, f);
+  }
+  mrb_data_init(self, NULL, &fft_data_type);
+  f = fft_alloc(n);
+  if (!f)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate FFT data");
+  mrb_data_init(self, f, &fft_data_type);
+  return mrb_nil_value();
+}
+
+static mrb_value mrb_fft_size(mrb_state *mrb, mrb_value self) {
+  return mrb_fixnum_value(mrb_gsl_fft_get(mrb, self)->n);
+}
+
+static mrb_value mrb_fft_radix2_p(mrb_state *mrb, mrb_value self) {
+  return mrb_bool_value(mrb_gsl_fft_get(mrb, self)->radix2);
+}
+
+#pragma mark -
+#pragma mark • Transforms
+
+// Copies v into out (unless they are the same) and transforms it in place
+static mrb_value fft_into(mrb_state *mrb, fft_s *f, mrb_value v, mrb_value out,
+                          int inverse) {
+  gsl_vector *p_vec, *p_out;
+  int status;
+
+  // the ring order of a Buffer can't be kept by an in-place transform
+  if (mrb_obj_is_kind_of(mrb, out, mrb_gsl_buffer_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Cannot transform into a Buffer");
+  }
+  p_vec = fft_vector_arg(mrb, &v, f->n);
+  p_out = fft_vector_arg(mrb, &out, f->n);
+  if (p_out != p_vec)
+    gsl_vector_memcpy(p_out, p_vec);
+  if (inverse)
+    status = mrb_gsl_fft_inverse(f, p_out->data, p_out->stride);
+  else
+    status = mrb_gsl_fft_forward(f, p_out->data, p_out->stride);
+  if (status) {
+    mrb_raise(mrb, E_FFT_ERROR, "Transform failed");
+  }
+  mrb_gsl_touch(mrb, out);
+  return out;
+}
+
+// Forward transform of v into out (which can be v itself), packed
+static mrb_value mrb_fft_forward_into(mrb_state *mrb, mrb_value self) {
+  mrb_value v, out;
+  mrb_get_args(mrb, "oo", &v, &out);
+  return fft_into(mrb, mrb_gsl_fft_get(mrb, self), v, out, 0);
+}
+
+// Inverse transform of the packed hc into out (which can be hc itself)
+static mrb_value mrb_fft_inverse_into(mrb_state *mrb, mrb_value self) {
+  mrb_value v, out;
+  mrb_get_args(mrb, "oo", &v, &out);
+  return fft_into(mrb, mrb_gsl_fft_get(mrb, self), v, out, 1);
+}
+
+static mrb_value mrb_fft_forward(mrb_state *mrb, mrb_value self) {
+  fft_s *f = mrb_gsl_fft_get(mrb, self);
+  mrb_value v, out;
+
+  mrb_get_args(mrb, "o", &v);
+  fft_vector_arg(mrb, &v, f->n);
+  out = mrb_gsl_vector_new_uninit(mrb, f->n);
+  return fft_into(mrb, f, v, out, 0);
+}
+
+static mrb_value mrb_fft_inverse(mrb_state *mrb, mrb_value self) {
+  fft_s *f = mrb_gsl_fft_get(mrb, self);
+  mrb_value v, out;
+
+  mrb_get_args(mrb, "o", &v);
+  fft_vector_arg(mrb, &v, f->n);
+  out = mrb_gsl_vector_new_uninit(mrb, f->n);
+  return fft_into(mrb, f, v, out, 1);
+}
+
+// One-sided power spectrum of v: |X(k)|^2 for k = 0..n/2, not scaled
+static mrb_value mrb_fft_power_spectrum(mrb_state *mrb, mrb_value self) {
+  fft_s *f = mrb_gsl_fft_get(mrb, self);
+  gsl_vector *p_vec, *p_res;
+  mrb_value v, res;
+  double re, im;
+  size_t k;
+
+  mrb_get_args(mrb, "o", &v);
+  p_vec = fft_vector_arg(mrb, &v, f->n);
+  res = mrb_gsl_vector_new_uninit(mrb, f->n / 2 + 1);
+  mrb_vector_get_data(mrb, res, &p_res);
+  for (k = 0; k < f->n; k++)
+    f->buf[k] = p_vec->data[k * p_vec->stride];
+  if (mrb_gsl_fft_forward(f, f->buf, 1)) {
+    mrb_raise(mrb, E_FFT_ERROR, "Forward transform failed");
+  }
+  for (k = 0; k <= f->n / 2; k++) {
+    fft_coef(f->buf, 1, f->n, k, &re, &im);
+    p_res->data[k] = re * re + im * im;
+  }
+  return res;
+}
+
+// Unpacks a halfcomplex sequence into all the n coefficients, as a Vector
+// of 2n interleaved real and imaginary parts
+static mrb_value mrb_fft_unpack(mrb_state *mrb, mrb_value self) {
+  fft_s *f = mrb_gsl_fft_get(mrb, self);
+  gsl_vector *p_vec, *p_res;
+  mrb_value v, res;
+  size_t k;
+
+  mrb_get_args(mrb, "o", &v);
+  p_vec = fft_vector_arg(mrb, &v, f->n);
+  res = mrb_gsl_vector_new_uninit(mrb, 2 * f->n);
+  mrb_vector_get_data(mrb, res, &p_res);
+  for (k = 0; k < f->n; k++) {
+    fft_coef(p_vec->data, p_vec->stride, f->n, k, p_res->data + 2 * k,
+             p_res->data + 2 * k + 1);
+  }
+  return res;
+}
+
+// Forward transform of v as a ComplexVector of all the n coefficients
+static mrb_value mrb_fft_forward_complex(mrb_state *mrb, mrb_value self) {
+  fft_s *f = mrb_gsl_fft_get(mrb, self);
+  gsl_vector_complex *p_res;
+  gsl_vector *p_vec;
+  mrb_value v, res;
+  size_t k;
+
+  mrb_get_args(mrb, "o", &v);
+  p_vec = fft_vector_arg(mrb, &v, f->n);
+  res = mrb_gsl_complex_vector_new_uninit(mrb, f->n);
+  mrb_complex_vector_get_data(mrb, res, &p_res);
+  for (k = 0; k < f->n; k++)
+    f->buf[k] = p_vec->data[k * p_vec->stride];
+  if (mrb_gsl_fft_forward(f, f->buf, 1)) {
+    mrb_raise(mrb, E_FFT_ERROR, "Forward transform failed");
+  }
+  for (k = 0; k < f->n; k++) {
+    fft_coef(f->buf, 1, f->n, k, p_res->data + 2 * k * p_res->stride,
+             p_res->data + 2 * k * p_res->stride + 1);
+  }
+  return res;
+}
+
+// Inverse transform of a ComplexVector of n coefficients, as a real
+// Vector: only the coefficients 0..n/2 are read, the others being their
+// conjugates for the spectrum of a real signal
+static mrb_value mrb_fft_inverse_complex(mrb_state *mrb, mrb_value self) {
+  fft_s *f = mrb_gsl_fft_get(mrb, self);
+  gsl_vector_complex *p_z;
+  gsl_vector *p_res;
+  mrb_value z, res;
+  size_t k, n = f->n;
+  const double *c;
+
+  mrb_get_args(mrb, "o", &z);
+  if (!mrb_obj_is_kind_of(mrb, z, mrb_gsl_complex_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a ComplexVector");
+  }
+  mrb_complex_vector_get_data(mrb, z, &p_z);
+  if (p_z->size != n) {
+    mrb_raise(mrb, E_FFT_ERROR, "Vector size does not match the FFT size");
+  }
+  res = mrb_gsl_vector_new_uninit(mrb, n);
+  mrb_vector_get_data(mrb, res, &p_res);
+  c = p_z->data;
+  p_res->data[0] = c[0];
+  for (k = 1; 2 * k < n; k++) {
+    p_res->data[2 * k - 1] = c[2 * k * p_z->stride];
+    p_res->data[2 * k] = c[2 * k * p_z->stride + 1];
+  }
+  if (n % 2 == 0 && n > 1)
+    p_res->data[n - 1] = c[n * p_z->stride];
+  if (mrb_gsl_fft_inverse(f, p_res->data, 1)) {
+    mrb_raise(mrb, E_FFT_ERROR, "Inverse transform failed");
+  }
+  return res;
+}
+
+#pragma mark -
+#pragma mark • Convolutions
+
+// Full linear convolution of a (na samples) and b (nb samples, reversed
+// if rev) into c (na + nb - 1 samples). Short operands are convolved
+// directly, longer ones through radix-2 transforms of the zero-padded
+// operands, multiplied in the radix-2 halfcomplex packing
+static int convolve(const gsl_vector *a, const gsl_vector *b, int rev,
+                    double *c, int fft) {
+  size_t na = a->size, nb = b->size, nc = na + nb - 1, n, i, j;
+  double *x, *y, bj, re, im;
+  int status;
+
+  if (!fft) {
+    memset(c, 0, nc * sizeof(double));
+    for (j = 0; j < nb; j++) {
+      bj = b->data[(rev ? nb - 1 - j : j) * b->stride];
+      for (i = 0; i < na; i++)
+        c[i + j] += a->data[i * a->stride] * bj;
+    }
+    return GSL_SUCCESS;
+  }
+  for (n = 1; n < nc; n <<= 1)
+    ;
+  x = (double *)calloc(2 * n, sizeof(double));
+  if (!x)
+    return GSL_ENOMEM;
+  y = x + n;
+  for (i = 0; i < na; i++)
+    x[i] = a->data[i * a->stride];
+  for (j = 0; j < nb; j++)
+    y[j] = b->data[(rev ? nb - 1 - j : j) * b->stride];
+  status = gsl_fft_real_radix2_transform(x, 1, n);
+  if (!status)
+    status = gsl_fft_real_radix2_transform(y, 1, n);
+  if (!status) {
+    x[0] *= y[0];
+    if (n > 1)
+      x[n / 2] *= y[n / 2];
+    for (i = 1; i < n / 2; i++) {
+      re = x[i] * y[i] - x[n - i] * y[n - i];
+      im = x[i] * y[n - i] + x[n - i] * y[i];
+      x[i] = re;
+      x[n - i] = im;
+    }
+    status = gsl_fft_halfcomplex_radix2_inverse(x, 1, n);
+  }
+  if (!status)
+    memcpy(c, x, nc * sizeof(double));
+  free(x);
+  return status;
+}
+
+static mrb_value vector_convolve(mrb_state *mrb, mrb_value self, int rev) {
+  mrb_value other, opts = mrb_nil_value(), method = mrb_nil_value(), res;
+  gsl_vector *p_vec, *p_other, *p_res;
+  size_t nmin;
+  int fft;
+
+  mrb_get_args(mrb, "o|H", &other, &opts);
+  if (!mrb_obj_is_kind_of(mrb, other, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Vector");
+  }
+  self = buffer_linearize(mrb, self);
+  other = buffer_linearize(mrb, other);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  mrb_vector_get_data(mrb, other, &p_other);
+  if (mrb_hash_p(opts)) {
+    method =
+        mrb_hash_get(mrb, opts, mrb_symbol_value(mrb_intern_lit(mrb, "method")));
+  }
+  nmin = p_vec->size < p_other->size ? p_vec->size : p_other->size;
+  if (mrb_nil_p(method)) {
+    fft = nmin > CONV_DIRECT_MAX;
+  } else if (mrb_symbol_p(method) &&
+             mrb_symbol(method) == mrb_intern_lit(mrb, "fft")) {
+    fft = 1;
+  } else if (mrb_symbol_p(method) &&
+             mrb_symbol(method) == mrb_intern_lit(mrb, "direct")) {
+    fft = 0;
+  } else {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "method must be :direct or :fft");
+  }
+  res = mrb_gsl_vector_new_uninit(mrb, p_vec->size + p_other->size - 1);
+  mrb_vector_get_data(mrb, res, &p_res);
+  if (convolve(p_vec, p_other, rev, p_res->data, fft)) {
+    mrb_raise(mrb, E_FFT_ERROR, "Convolution failed");
+  }
+  return res;
+}
+
+// Full convolution: a Vector of size + other.size - 1 samples. method: is
+// :direct or :fft, by default the FFT for operands longer than 64 samples
+static mrb_value mrb_vector_convolve(mrb_state *mrb, mrb_value self) {
+  return vector_convolve(mrb, self, 0);
+}
+
+// Full cross-correlation, for lags from -(other.size - 1) to size - 1
+static mrb_value mrb_vector_correlate(mrb_state *mrb, mrb_value self) {
+  return vector_convolve(mrb, self, 1);
+}
+
+#pragma mark -
+#pragma mark • Gem setup
+
+void mrb_gsl_fft_init(mrb_state *mrb) {
+  struct RClass *fft;
+
+  mrb_load_string(mrb, "class FFTError < Exception; end");
+  fft = mrb_define_class(mrb, "FFT", mrb->object_class);
+  mrb_gsl_fft_class = fft;
+  MRB_SET_INSTANCE_TT(fft, MRB_TT_DATA);
+  mrb_define_method(mrb, fft, "initialize", mrb_fft_initialize,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, fft, "size", mrb_fft_size, MRB_ARGS_NONE());
+  mrb_define_method(mrb, fft, "radix2?", mrb_fft_radix2_p, MRB_ARGS_NONE());
+  mrb_define_method(mrb, fft, "forward", mrb_fft_forward, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, fft, "forward_into", mrb_fft_forward_into,
+                    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, fft, "inverse", mrb_fft_inverse, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, fft, "inverse_into", mrb_fft_inverse_into,
+                    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, fft, "power_spectrum", mrb_fft_power_spectrum,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, fft, "unpack", mrb_fft_unpack, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, fft, "forward_complex", mrb_fft_forward_complex,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, fft, "inverse_complex", mrb_fft_inverse_complex,
+                    MRB_ARGS_REQ(1));
+
+  mrb_define_method(mrb, mrb_gsl_vector_class, "convolve",
+                    mrb_vector_convolve, MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, mrb_gsl_vector_class, "correlate",
+                    mrb_vector_correlate, MRB_ARGS_ARG(1, 1));
+}
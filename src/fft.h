@@ -0,0 +1,70 @@
+/***************************************************************************/
+/*                                                                         */
+/* fft.h - Fast Fourier transforms for mruby                               */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <gsl/gsl_fft_real.h>
+#include <gsl/gsl_fft_halfcomplex.h>
+
+#include "mruby.h"
+#include "mruby/data.h"
+#include "mruby/class.h"
+#include "mruby/value.h"
+#include "mruby/compile.h"
+
+#define E_FFT_ERROR (mrb_class_get(mrb, "FFTError"))
+
+extern struct RClass *mrb_gsl_fft_class;
+
+/***********************************************\
+ FFT PLANS
+\***********************************************/
+
+// A plan for real transforms of length n. Powers of two use the radix-2
+// routines, which need no wavetable; other lengths use the mixed-radix
+// routines, with wavetables and workspace allocated once here. Both give
+// the mixed-radix halfcomplex packing: r0, r1, i1, r2, i2, ..., with
+// r(n/2) last for an even n. scratch and buf hold n doubles each
+typedef struct {
+  size_t n;
+  int radix2;
+  gsl_fft_real_wavetable *rwt;
+  gsl_fft_halfcomplex_wavetable *hwt;
+  gsl_fft_real_workspace *work;
+  double *scratch;
+  double *buf;
+} fft_s;
+
+// Garbage collector handler
+void fft_destructor(mrb_state *mrb, void *p_);
+
+// The plan wrapped by an FFT object
+fft_s *mrb_gsl_fft_get(mrb_state *mrb, mrb_value self);
+
+// In place transforms of n strided samples, with the packing above. The
+// inverse is normalized by 1/n. Return a GSL status
+int mrb_gsl_fft_forward(fft_s *f, double *data, size_t stride);
+int mrb_gsl_fft_inverse(fft_s *f, double *data, size_t stride);
+
+// Adds FFT, Vector#convolve and Vector#correlate: it must be called after
+// mrb_gsl_vector_init
+void mrb_gsl_fft_init(mrb_state *mrb);
+
+#endif // FFT_H
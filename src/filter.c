@@ -0,0 +1,375 @@
+/***************************************************************************/
+/*                                                                         */
+/* filter.c - Digital filters for mruby                                    */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#include <string.h>
+#include "mruby/array.h"
+#include "mruby/hash.h"
+#include "vector.h"
+#include "matrix.h"
+#include "buffer.h"
+#include "filter.h"
+
+#pragma mark -
+#pragma mark • Utilities
+
+// Garbage collector handler
+void filter_destructor(mrb_state *mrb, void *p_) {
+  if (p_)
+    free(p_);
+};
+
+// Creating data type and reference for GC, in a const struct
+const struct mrb_data_type filter_data_type = {"filter_data",
+                                               filter_destructor};
+
+// Utility function for getting the struct out of self
+static filter_s *mrb_filter_get_data(mrb_state *mrb, mrb_value self) {
+  filter_s *f = (filter_s *)mrb_data_get_ptr(mrb, self, &filter_data_type);
+  if (!f)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access filter data");
+  return f;
+}
+
+// Coefficients and delays per tap (FIR) or per section (SOS)
+static size_t filter_ncoef(filter_kind_t kind) {
+  return kind == FILTER_FIR ? 1 : 5;
+}
+
+static size_t filter_nstate(filter_kind_t kind) { return 2; }
+
+// The struct, the coefficients and the state in a single allocation
+static filter_s *filter_alloc(filter_kind_t kind, size_t n) {
+  filter_s *f = (filter_s *)calloc(
+      1, sizeof(filter_s) +
+             n * (filter_ncoef(kind) + filter_nstate(kind)) * sizeof(double));
+  if (!f)
+    return NULL;
+  f->kind = kind;
+  f->n = n;
+  f->coef = (double *)(f + 1);
+  f->state = f->coef + n * filter_ncoef(kind);
+  return f;
+}
+
+static void filter_reset(filter_s *f) {
+  memset(f->state, 0, f->n * filter_nstate(f->kind) * sizeof(double));
+  f->pos = 0;
+}
+
+// Loads the state that a constant input x0 would give at steady state, so
+// that filtering a signal starting at x0 has no start-up transient. A
+// section with a pole at z = 1 gets a zero state
+static void filter_steady(filter_s *f, double x0) {
+  double *c, *z, g;
+  size_t i;
+
+  f->pos = 0;
+  if (f->kind == FILTER_FIR) {
+    for (i = 0; i < 2 * f->n; i++)
+      f->state[i] = x0;
+    return;
+  }
+  for (i = 0; i < f->n; i++) {
+    c = f->coef + 5 * i;
+    z = f->state + 2 * i;
+    if (1 + c[3] + c[4] == 0) {
+      z[0] = z[1] = 0;
+      x0 = 0;
+      continue;
+    }
+    g = (c[0] + c[1] + c[2]) / (1 + c[3] + c[4]);
+    z[0] = x0 * (g - c[0]);
+    z[1] = x0 * (c[2] - c[4] * g);
+    x0 *= g;
+  }
+}
+
+static double filter_step(filter_s *f, double x) {
+  const double *h = f->coef, *d;
+  double y = 0, *c, *z;
+  size_t k;
+
+  if (f->kind == FILTER_FIR) {
+    f->pos = f->pos == 0 ? f->n - 1 : f->pos - 1;
+    f->state[f->pos] = f->state[f->pos + f->n] = x;
+    d = f->state + f->pos;
+    for (k = 0; k < f->n; k++)
+      y += h[k] * d[k];
+    return y;
+  }
+  for (k = 0; k < f->n; k++) {
+    c = f->coef + 5 * k;
+    z = f->state + 2 * k;
+    y = c[0] * x + z[0];
+    z[0] = c[1] * x - c[3] * y + z[1];
+    z[1] = c[2] * x - c[4] * y;
+    x = y;
+  }
+  return x;
+}
+
+// Filters n samples in place. Biquads are applied one section at a time
+// over the whole block, so that the delays stay in registers
+static void filter_block(filter_s *f, double *x, size_t n, size_t stride) {
+  double b0, b1, b2, a1, a2, z0, z1, xi, y, *c;
+  size_t i, k;
+
+  if (f->kind == FILTER_FIR) {
+    for (i = 0; i < n; i++)
+      x[i * stride] = filter_step(f, x[i * stride]);
+    return;
+  }
+  for (k = 0; k < f->n; k++) {
+    c = f->coef + 5 * k;
+    b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+    z0 = f->state[2 * k];
+    z1 = f->state[2 * k + 1];
+    for (i = 0; i < n; i++) {
+      xi = x[i * stride];
+      y = b0 * xi + z0;
+      z0 = b1 * xi - a1 * y + z1;
+      z1 = b2 * xi - a2 * y;
+      x[i * stride] = y;
+    }
+    f->state[2 * k] = z0;
+    f->state[2 * k + 1] = z1;
+  }
+}
+
+static void reverse(double *x, size_t n) {
+  double t;
+  size_t i;
+  for (i = 0; i < n / 2; i++) {
+    t = x[i];
+    x[i] = x[n - 1 - i];
+    x[n - 1 - i] = t;
+  }
+}
+
+#pragma mark -
+#pragma mark • Initializations
+
+// Filter.new(taps) for a FIR filter (a Vector or an Array), or
+// Filter.new(sos: m) for a cascade of biquads, one per row of the n x 6
+// Matrix m: b0, b1, b2, a0, a1, a2
+static mrb_value mrb_filter_initialize(mrb_state *mrb, mrb_value self) {
+  mrb_value arg, sos = mrb_nil_value();
+  filter_s *f;
+  gsl_vector *p_vec = NULL;
+  gsl_matrix *p_mat = NULL;
+  size_t i, j, n;
+  double a0;
+
+  mrb_get_args(mrb, "o", &arg);
+  if (mrb_hash_p(arg)) {
+    sos = mrb_hash_get(mrb, arg, mrb_symbol_value(mrb_intern_lit(mrb, "sos")));
+    if (!mrb_obj_is_kind_of(mrb, sos, mrb_gsl_matrix_class)) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "sos must be a Matrix");
+    }
+    mrb_matrix_get_data(mrb, sos, &p_mat);
+    if (p_mat->size2 != 6 || p_mat->size1 == 0) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "sos must have 6 columns");
+    }
+    n = p_mat->size1;
+  } else if (mrb_array_p(arg)) {
+    n = RARRAY_LEN(arg);
+  } else if (mrb_obj_is_kind_of(mrb, arg, mrb_gsl_vector_class)) {
+    mrb_vector_get_data(mrb, arg, &p_vec);
+    n = p_vec->size;
+  } else {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Vector, an Array or sos:");
+  }
+  if (n == 0) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need at least one coefficient");
+  }
+  if (p_mat) {
+    for (i = 0; i < n; i++) {
+      if (gsl_matrix_get(p_mat, i, 3) == 0) {
+        mrb_raise(mrb, E_ARGUMENT_ERROR, "a0 must not be zero");
+      }
+    }
+  }
+
+  f = (filter_s *)DATA_PTR(self);
+  if (f) {
+    filter_destructor(mrb, f);
+  }
+  mrb_data_init(self, NULL, &filter_data_type);
+  f = filter_alloc(p_mat ? FILTER_SOS : FILTER_FIR, n);
+  if (!f)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate filter data");
+  mrb_data_init(self, f, &filter_data_type);
+  for (i = 0; i < n; i++) {
+    if (p_mat) {
+      a0 = gsl_matrix_get(p_mat, i, 3);
+      for (j = 0; j < 3; j++)
+        f->coef[5 * i + j] = gsl_matrix_get(p_mat, i, j) / a0;
+      for (j = 4; j < 6; j++)
+        f->coef[5 * i + j - 1] = gsl_matrix_get(p_mat, i, j) / a0;
+    } else if (p_vec) {
+      f->coef[i] = gsl_vector_get(p_vec, i);
+    } else {
+      f->coef[i] = mrb_gsl_to_f(mrb, mrb_ary_ref(mrb, arg, i));
+    }
+  }
+  return mrb_nil_value();
+}
+
+static mrb_value mrb_filter_reset(mrb_state *mrb, mrb_value self) {
+  filter_reset(mrb_filter_get_data(mrb, self));
+  return self;
+}
+
+// Number of delays: taps - 1 (FIR) or twice the sections (SOS)
+static mrb_value mrb_filter_order(mrb_state *mrb, mrb_value self) {
+  filter_s *f = mrb_filter_get_data(mrb, self);
+  return mrb_fixnum_value(f->kind == FILTER_FIR ? f->n - 1 : 2 * f->n);
+}
+
+#pragma mark -
+#pragma mark • Filtering
+
+// The Vector argument of filter and filtfilt: a Buffer stores its samples
+// as a ring, so it is linearized, oldest first
+static mrb_value filter_vector_arg(mrb_state *mrb, mrb_value v) {
+  if (!mrb_obj_is_kind_of(mrb, v, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Vector");
+  }
+  if (mrb_obj_is_kind_of(mrb, v, mrb_gsl_buffer_class))
+    v = mrb_funcall(mrb, v, "to_vector", 0);
+  return v;
+}
+
+// Filters a single sample, returning the output sample
+static mrb_value mrb_filter_step(mrb_state *mrb, mrb_value self) {
+  mrb_value x;
+  mrb_get_args(mrb, "o", &x);
+  return mrb_float_value(
+      mrb, filter_step(mrb_filter_get_data(mrb, self), mrb_gsl_to_f(mrb, x)));
+}
+
+// Filters a block of samples in place, continuing from the state left by
+// the previous block
+static mrb_value mrb_filter_filter_bang(mrb_state *mrb, mrb_value self) {
+  filter_s *f = mrb_filter_get_data(mrb, self);
+  gsl_vector *p_vec;
+  mrb_value v;
+
+  mrb_get_args(mrb, "o", &v);
+  if (!mrb_obj_is_kind_of(mrb, v, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Vector");
+  }
+  // the ring order of a Buffer can't be filtered in place
+  if (mrb_obj_is_kind_of(mrb, v, mrb_gsl_buffer_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Cannot filter a Buffer in place");
+  }
+  mrb_vector_get_data(mrb, v, &p_vec);
+  filter_block(f, p_vec->data, p_vec->size, p_vec->stride);
+  mrb_gsl_touch(mrb, v);
+  return v;
+}
+
+static mrb_value mrb_filter_filter(mrb_state *mrb, mrb_value self) {
+  filter_s *f = mrb_filter_get_data(mrb, self);
+  gsl_vector *p_vec, *p_res;
+  mrb_value v, res;
+
+  mrb_get_args(mrb, "o", &v);
+  v = filter_vector_arg(mrb, v);
+  mrb_vector_get_data(mrb, v, &p_vec);
+  res = mrb_gsl_vector_new_uninit(mrb, p_vec->size);
+  mrb_vector_get_data(mrb, res, &p_res);
+  gsl_vector_memcpy(p_res, p_vec);
+  filter_block(f, p_res->data, p_res->size, 1);
+  return res;
+}
+
+// Zero-phase filtering: forwards, then backwards, so that the magnitude
+// response is squared and the phase cancels. As in scipy's filtfilt and
+// sosfiltfilt, the signal is extended at both ends by an odd reflection of
+// 3 * taps (FIR) or 3 * (2 * sections + 1) (SOS) samples, which must be
+// shorter than the signal, and each pass starts from the steady state of
+// its first sample. The state of self is left untouched
+static mrb_value mrb_filter_filtfilt(mrb_state *mrb, mrb_value self) {
+  filter_s *f = mrb_filter_get_data(mrb, self), *w;
+  gsl_vector *p_vec, *p_res;
+  mrb_value v, res;
+  size_t n, pad, i;
+  double *x;
+
+  mrb_get_args(mrb, "o", &v);
+  v = filter_vector_arg(mrb, v);
+  mrb_vector_get_data(mrb, v, &p_vec);
+  n = p_vec->size;
+  pad = 3 * (f->kind == FILTER_FIR ? f->n : 2 * f->n + 1);
+  if (n <= pad) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR,
+              "Signal must be longer than the padding");
+  }
+
+  res = mrb_gsl_vector_new_uninit(mrb, n);
+  mrb_vector_get_data(mrb, res, &p_res);
+  w = filter_alloc(f->kind, f->n);
+  x = (double *)malloc((n + 2 * pad) * sizeof(double));
+  if (!w || !x) {
+    free(w);
+    free(x);
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate filter data");
+  }
+  memcpy(w->coef, f->coef, f->n * filter_ncoef(f->kind) * sizeof(double));
+  for (i = 0; i < n; i++)
+    x[pad + i] = gsl_vector_get(p_vec, i);
+  for (i = 1; i <= pad; i++) {
+    x[pad - i] = 2 * x[pad] - x[pad + i];
+    x[pad + n - 1 + i] = 2 * x[pad + n - 1] - x[pad + n - 1 - i];
+  }
+
+  filter_steady(w, x[0]);
+  filter_block(w, x, n + 2 * pad, 1);
+  reverse(x, n + 2 * pad);
+  filter_steady(w, x[0]);
+  filter_block(w, x, n + 2 * pad, 1);
+  reverse(x, n + 2 * pad);
+
+  memcpy(p_res->data, x + pad, n * sizeof(double));
+  free(x);
+  free(w);
+  return res;
+}
+
+#pragma mark -
+#pragma mark • Gem setup
+
+void mrb_gsl_filter_init(mrb_state *mrb) {
+  struct RClass *filter;
+
+  filter = mrb_define_class(mrb, "Filter", mrb->object_class);
+  MRB_SET_INSTANCE_TT(filter, MRB_TT_DATA);
+  mrb_define_method(mrb, filter, "initialize", mrb_filter_initialize,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, filter, "reset", mrb_filter_reset, MRB_ARGS_NONE());
+  mrb_define_method(mrb, filter, "order", mrb_filter_order, MRB_ARGS_NONE());
+  mrb_define_method(mrb, filter, "step", mrb_filter_step, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, filter, "filter", mrb_filter_filter,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, filter, "filter!", mrb_filter_filter_bang,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, filter, "filtfilt", mrb_filter_filtfilt,
+                    MRB_ARGS_REQ(1));
+}
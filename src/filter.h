@@ -0,0 +1,55 @@
+/***************************************************************************/
+/*                                                                         */
+/* filter.h - Digital filters for mruby                                    */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdlib.h>
+
+#include "mruby.h"
+#include "mruby/data.h"
+#include "mruby/class.h"
+#include "mruby/value.h"
+
+/***********************************************\
+ FILTERS
+\***********************************************/
+
+typedef enum { FILTER_FIR, FILTER_SOS } filter_kind_t;
+
+// A FIR filter of n taps, or a cascade of n biquads (second order
+// sections), with its delay line. FIR: coef holds the taps, state a delay
+// line of 2n samples, mirrored so that the last n inputs are always
+// contiguous from state + pos, newest first. SOS: coef holds b0, b1, b2,
+// a1, a2 of each section (normalized by a0), state the two delays of each
+// section (transposed direct form II)
+typedef struct {
+  filter_kind_t kind;
+  size_t n;
+  size_t pos;
+  double *coef;
+  double *state;
+} filter_s;
+
+// Garbage collector handler
+void filter_destructor(mrb_state *mrb, void *p_);
+
+void mrb_gsl_filter_init(mrb_state *mrb);
+
+#endif // FILTER_H
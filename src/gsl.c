@@ -16,11 +16,27 @@
 /* See the file LICENSE                                                    */
 /*                                                                         */
 /***************************************************************************/
+#include <stdint.h>
+
 #include "mruby.h"
+#include "mruby/string.h"
 #include "vector.h"
 #include "matrix.h"
 #include "LU_decomp.h"
 #include "QR_decomp.h"
+#include "cholesky_decomp.h"
+#include "lapack.h"
+#include "blas.h"
+#include "bytes.h"
+#include "mmap.h"
+#include "elementwise.h"
+#include "rng.h"
+#include "buffer.h"
+#include "running_stats.h"
+#include "movstat.h"
+#include "filter.h"
+#include "complex_vector.h"
+#include "fft.h"
 
 void error_handler(const char *reason, const char *file, int line,
                    int gsl_errno) {
@@ -38,7 +54,54 @@ static mrb_value mrb_gsl_info_off(mrb_state *mrb, mrb_value self) {
   return mrb_false_value();
 }
 
+#pragma mark -
+#pragma mark • BLAS backend
+
+// The backend is chosen at build time, see mrbgem.rake. The vendor headers
+// are not included, since their cblas.h clashes with gsl_cblas.h
+#ifndef MRUBY_GSL_BLAS_NAME
+#define MRUBY_GSL_BLAS_NAME "gslcblas"
+#endif
+
+#if defined(MRUBY_GSL_BLAS_OPENBLAS)
+extern void openblas_set_num_threads(int num_threads);
+extern int openblas_get_num_threads(void);
+#elif defined(MRUBY_GSL_BLAS_BLIS)
+extern void bli_thread_set_num_threads(int64_t n_threads);
+extern int64_t bli_thread_get_num_threads(void);
+#endif
+
+static mrb_value mrb_gsl_blas_backend(mrb_state *mrb, mrb_value self) {
+  return mrb_str_new_cstr(mrb, MRUBY_GSL_BLAS_NAME);
+}
+
+static mrb_value mrb_gsl_blas_threads(mrb_state *mrb, mrb_value self) {
+#if defined(MRUBY_GSL_BLAS_OPENBLAS)
+  return mrb_fixnum_value(openblas_get_num_threads());
+#elif defined(MRUBY_GSL_BLAS_BLIS)
+  return mrb_fixnum_value((mrb_int)bli_thread_get_num_threads());
+#else
+  return mrb_fixnum_value(1);
+#endif
+}
+
+// Has no effect on single threaded backends
+static mrb_value mrb_gsl_set_blas_threads(mrb_state *mrb, mrb_value self) {
+  mrb_int n;
+  mrb_get_args(mrb, "i", &n);
+  if (n < 1) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need at least one thread");
+  }
+#if defined(MRUBY_GSL_BLAS_OPENBLAS)
+  openblas_set_num_threads((int)n);
+#elif defined(MRUBY_GSL_BLAS_BLIS)
+  bli_thread_set_num_threads((int64_t)n);
+#endif
+  return mrb_gsl_blas_threads(mrb, self);
+}
+
 void mrb_mruby_gsl_gem_init(mrb_state *mrb) {
+  struct RClass *gsl;
 // disable GSL error handler
 #ifdef GSL_ERROR_MSG_PRINTOUT
   gsl_set_error_handler(&error_handler);
@@ -50,10 +113,31 @@ void mrb_mruby_gsl_gem_init(mrb_state *mrb) {
   mrb_define_method(mrb, mrb->kernel_module, "gsl_info_off", mrb_gsl_info_off,
                     MRB_ARGS_NONE());
 
+  gsl = mrb_define_module(mrb, "GSL");
+  mrb_define_class_method(mrb, gsl, "blas_backend", mrb_gsl_blas_backend,
+                          MRB_ARGS_NONE());
+  mrb_define_class_method(mrb, gsl, "blas_threads", mrb_gsl_blas_threads,
+                          MRB_ARGS_NONE());
+  mrb_define_class_method(mrb, gsl, "blas_threads=", mrb_gsl_set_blas_threads,
+                          MRB_ARGS_REQ(1));
+
   mrb_gsl_vector_init(mrb);
+  mrb_gsl_buffer_init(mrb);
   mrb_gsl_matrix_init(mrb);
+  mrb_gsl_blas_init(mrb);
+  mrb_gsl_bytes_init(mrb);
+  mrb_gsl_mmap_init(mrb);
+  mrb_gsl_elementwise_init(mrb);
+  mrb_gsl_rng_init(mrb);
+  mrb_gsl_running_stats_init(mrb);
+  mrb_gsl_movstat_init(mrb);
+  mrb_gsl_filter_init(mrb);
+  mrb_gsl_complex_init(mrb);
+  mrb_gsl_fft_init(mrb);
   mrb_gsl_lu_decomp_init(mrb);
   mrb_gsl_qr_decomp_init(mrb);
+  mrb_gsl_cholesky_decomp_init(mrb);
+  mrb_gsl_lapack_init(mrb);
 }
 
 void mrb_mruby_gsl_gem_final(mrb_state *mrb) {}
@@ -0,0 +1,221 @@
+/***************************************************************************/
+/*                                                                         */
+/* lapack.c - LAPACK dispatch for the matrix decompositions                */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#include <stdlib.h>
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_linalg.h>
+#include "lapack.h"
+
+// Smaller side of a matrix above which LAPACK is used
+static size_t lapack_threshold = 128;
+
+#ifdef HAVE_LAPACK
+
+#pragma mark -
+#pragma mark • LAPACK routines
+
+// Fortran interface: everything by reference, column-major storage
+extern void dgetrf_(const int *m, const int *n, double *a, const int *lda,
+                    int *ipiv, int *info);
+extern void dgeqrf_(const int *m, const int *n, double *a, const int *lda,
+                    double *tau, double *work, const int *lwork, int *info);
+extern void dpotrf_(const char *uplo, const int *n, double *a, const int *lda,
+                    int *info);
+
+// Column-major copy of A, and back. The copy costs O(n^2) against the
+// O(n^3) of the factorization
+static double *lapack_colmajor(const gsl_matrix *A) {
+  size_t i, j, m = A->size1, n = A->size2;
+  double *buf = (double *)malloc(m * n * sizeof(double));
+  if (!buf)
+    return NULL;
+  for (i = 0; i < m; i++) {
+    const double *row = A->data + i * A->tda;
+    for (j = 0; j < n; j++)
+      buf[i + j * m] = row[j];
+  }
+  return buf;
+}
+
+static void lapack_rowmajor(gsl_matrix *A, const double *buf) {
+  size_t i, j, m = A->size1, n = A->size2;
+  for (i = 0; i < m; i++) {
+    double *row = A->data + i * A->tda;
+    for (j = 0; j < n; j++)
+      row[j] = buf[i + j * m];
+  }
+}
+
+// P A = L U. dgetrf returns the row interchanges as 1-based swaps, which
+// are replayed on the identity to get GSL's permutation
+static int lapack_LU_decomp(gsl_matrix *A, gsl_permutation *p, int *signum) {
+  int m = (int)A->size1, n = (int)A->size2, info = 0, i;
+  int *ipiv = (int *)malloc(m * sizeof(int));
+  double *buf = lapack_colmajor(A);
+  if (!buf || !ipiv) {
+    free(buf);
+    free(ipiv);
+    return GSL_ENOMEM;
+  }
+  dgetrf_(&m, &n, buf, &m, ipiv, &info);
+  // info > 0 flags an exact zero pivot: GSL does not fail either
+  if (info >= 0) {
+    lapack_rowmajor(A, buf);
+    gsl_permutation_init(p);
+    *signum = 1;
+    for (i = 0; i < m; i++) {
+      if (ipiv[i] - 1 != i) {
+        gsl_permutation_swap(p, i, ipiv[i] - 1);
+        *signum = -*signum;
+      }
+    }
+  }
+  free(buf);
+  free(ipiv);
+  return info < 0 ? GSL_EINVAL : GSL_SUCCESS;
+}
+
+// Householder reflectors are H = I - tau v v' with v(0) = 1 in both
+// libraries, so the packed result and tau are the same as GSL's
+static int lapack_QR_decomp(gsl_matrix *A, gsl_vector *tau) {
+  int m = (int)A->size1, n = (int)A->size2, info = 0, lwork = -1, k, i;
+  int status = GSL_SUCCESS;
+  double wsize, *work = NULL, *t = tau->data;
+  double *buf = lapack_colmajor(A);
+  if (!buf)
+    return GSL_ENOMEM;
+  k = m < n ? m : n;
+  if (tau->stride != 1) {
+    t = (double *)malloc(k * sizeof(double));
+  }
+  // workspace query: info < 0 flags an invalid argument
+  if (t)
+    dgeqrf_(&m, &n, buf, &m, t, &wsize, &lwork, &info);
+  if (!t) {
+    status = GSL_ENOMEM;
+  } else if (info != 0) {
+    status = GSL_EINVAL;
+  } else {
+    lwork = wsize >= 1 ? (int)wsize : 1;
+    work = (double *)malloc(lwork * sizeof(double));
+    if (!work)
+      status = GSL_ENOMEM;
+    else
+      dgeqrf_(&m, &n, buf, &m, t, work, &lwork, &info);
+    if (work && info != 0)
+      status = GSL_EINVAL;
+  }
+  if (status == GSL_SUCCESS) {
+    lapack_rowmajor(A, buf);
+    if (t != tau->data) {
+      for (i = 0; i < k; i++)
+        gsl_vector_set(tau, i, t[i]);
+    }
+  }
+  if (t != tau->data)
+    free(t);
+  free(work);
+  free(buf);
+  return status;
+}
+
+// A = L L'. The row-major storage seen by LAPACK is A' = A, so factoring
+// its lower triangle in place leaves L' in the upper triangle of A, no
+// copy needed. Mirroring gives GSL's format (L below, L' above)
+static int lapack_cholesky_decomp(gsl_matrix *A) {
+  int n = (int)A->size1, lda = (int)A->tda, info = 0;
+  size_t i, j;
+  dpotrf_("L", &n, A->data, &lda, &info);
+  if (info != 0)
+    return GSL_EDOM;
+  for (i = 1; i < A->size1; i++) {
+    for (j = 0; j < i; j++)
+      A->data[i * A->tda + j] = A->data[j * A->tda + i];
+  }
+  return GSL_SUCCESS;
+}
+
+#define USE_LAPACK(A)                                                          \
+  (((A)->size1 < (A)->size2 ? (A)->size1 : (A)->size2) >= lapack_threshold)
+
+#endif // HAVE_LAPACK
+
+#pragma mark -
+#pragma mark • Dispatch
+
+int mrb_gsl_LU_decomp(gsl_matrix *A, gsl_permutation *p, int *signum) {
+#ifdef HAVE_LAPACK
+  if (USE_LAPACK(A))
+    return lapack_LU_decomp(A, p, signum);
+#endif
+  return gsl_linalg_LU_decomp(A, p, signum);
+}
+
+int mrb_gsl_QR_decomp(gsl_matrix *A, gsl_vector *tau) {
+#ifdef HAVE_LAPACK
+  if (USE_LAPACK(A))
+    return lapack_QR_decomp(A, tau);
+#endif
+  return gsl_linalg_QR_decomp(A, tau);
+}
+
+int mrb_gsl_cholesky_decomp(gsl_matrix *A) {
+#ifdef HAVE_LAPACK
+  if (USE_LAPACK(A))
+    return lapack_cholesky_decomp(A);
+#endif
+  return gsl_linalg_cholesky_decomp(A);
+}
+
+#pragma mark -
+#pragma mark • Gem setup
+
+static mrb_value mrb_gsl_lapack_p(mrb_state *mrb, mrb_value self) {
+#ifdef HAVE_LAPACK
+  return mrb_true_value();
+#else
+  return mrb_false_value();
+#endif
+}
+
+static mrb_value mrb_gsl_lapack_threshold(mrb_state *mrb, mrb_value self) {
+  return mrb_fixnum_value(lapack_threshold);
+}
+
+static mrb_value mrb_gsl_set_lapack_threshold(mrb_state *mrb,
+                                              mrb_value self) {
+  mrb_int n;
+  mrb_get_args(mrb, "i", &n);
+  // 0 sends every decomposition to LAPACK
+  if (n < 0) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Threshold must not be negative");
+  }
+  lapack_threshold = n;
+  return mrb_fixnum_value(n);
+}
+
+void mrb_gsl_lapack_init(mrb_state *mrb) {
+  struct RClass *gsl = mrb_module_get(mrb, "GSL");
+  mrb_define_class_method(mrb, gsl, "lapack?", mrb_gsl_lapack_p,
+                          MRB_ARGS_NONE());
+  mrb_define_class_method(mrb, gsl, "lapack_threshold",
+                          mrb_gsl_lapack_threshold, MRB_ARGS_NONE());
+  mrb_define_class_method(mrb, gsl, "lapack_threshold=",
+                          mrb_gsl_set_lapack_threshold, MRB_ARGS_REQ(1));
+}
@@ -0,0 +1,45 @@
+/***************************************************************************/
+/*                                                                         */
+/* lapack.h - LAPACK dispatch for the matrix decompositions                */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef LAPACK_H
+#define LAPACK_H
+
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_permutation.h>
+
+#include "mruby.h"
+
+/***********************************************\
+ LAPACK dispatch
+\***********************************************/
+
+// Drop-in replacements for gsl_linalg_LU_decomp, gsl_linalg_QR_decomp and
+// gsl_linalg_cholesky_decomp, with the same storage format of the results.
+// When the gem is built with HAVE_LAPACK and the matrix is at least
+// GSL.lapack_threshold on its smaller side, they call the blocked LAPACK
+// routines dgetrf, dgeqrf and dpotrf; otherwise they fall back to GSL.
+int mrb_gsl_LU_decomp(gsl_matrix *A, gsl_permutation *p, int *signum);
+int mrb_gsl_QR_decomp(gsl_matrix *A, gsl_vector *tau);
+int mrb_gsl_cholesky_decomp(gsl_matrix *A);
+
+// Adds GSL.lapack?, GSL.lapack_threshold and GSL.lapack_threshold=
+void mrb_gsl_lapack_init(mrb_state *mrb);
+
+#endif // LAPACK_H
@@ -18,9 +18,11 @@
 /***************************************************************************/
 
 #include <gsl/gsl_blas.h>
-#include <gsl/gsl_rng.h>
+#include <math.h>
+#include "mruby/hash.h"
 #include "matrix.h"
 #include "vector.h"
+#include "rng.h"
 
 #pragma mark -
 #pragma mark • Utilities
@@ -30,22 +32,56 @@
 // Check it with GC.start
 void matrix_destructor(mrb_state *mrb, void *p_) {
   gsl_matrix *v = (gsl_matrix *)p_;
-  gsl_matrix_free(v);
+  if (v)
+    gsl_matrix_free(v);
 };
 
 // Creating data type and reference for GC, in a const struct
 const struct mrb_data_type matrix_data_type = {"matrix_data",
                                                matrix_destructor};
 
-// Utility function for getting the struct out of the wrapping IV @data
-void mrb_matrix_get_data(mrb_state *mrb, mrb_value self, gsl_matrix **data) {
-  mrb_value data_value;
-  data_value = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@data"));
+struct RClass *mrb_gsl_matrix_class = NULL;
+struct RClass *mrb_gsl_matrix_view_class = NULL;
 
-  // Loading data from data_value into p_data:
-  Data_Get_Struct(mrb, data_value, &matrix_data_type, *data);
+// Utility function for getting the struct out of self
+void mrb_matrix_get_data(mrb_state *mrb, mrb_value self, gsl_matrix **data) {
+  *data = (gsl_matrix *)mrb_data_get_ptr(mrb, self, &matrix_data_type);
   if (!*data)
-    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access @data");
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access matrix data");
+}
+
+mrb_value mrb_gsl_matrix_new_uninit(mrb_state *mrb, mrb_int n, mrb_int m) {
+  struct RData *data;
+  gsl_matrix *p_mat;
+
+  // Create the object first, so that the struct can't leak if GC kicks in
+  data = mrb_data_object_alloc(mrb, mrb_gsl_matrix_class, NULL,
+                               &matrix_data_type);
+  p_mat = gsl_matrix_alloc(n, m);
+  if (!p_mat)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate matrix data");
+  data->data = p_mat;
+  return mrb_obj_value(data);
+}
+
+mrb_value mrb_gsl_matrix_view_new(mrb_state *mrb, mrb_value parent,
+                                  gsl_matrix_view view) {
+  struct RData *data;
+  gsl_matrix *p_mat;
+  mrb_value result;
+
+  data = mrb_data_object_alloc(mrb, mrb_gsl_matrix_view_class, NULL,
+                               &matrix_data_type);
+  result = mrb_obj_value(data);
+  // the view does not own its block: keep the owner alive for the GC
+  mrb_iv_set(mrb, result, mrb_intern_lit(mrb, "@parent"), parent);
+  // owner is 0, so gsl_matrix_free() only releases this struct
+  p_mat = (gsl_matrix *)malloc(sizeof(gsl_matrix));
+  if (!p_mat)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate matrix view");
+  *p_mat = view.matrix;
+  data->data = p_mat;
+  return result;
 }
 
 #pragma mark -
@@ -54,26 +90,21 @@ void mrb_matrix_get_data(mrb_state *mrb, mrb_value self, gsl_matrix **data) {
 // Data Initializer C function (not exposed!)
 static void mrb_matrix_init(mrb_state *mrb, mrb_value self, mrb_int n,
                             mrb_int m) {
-  mrb_value data_value; // this IV holds the data
-  gsl_matrix *p_data;   // pointer to the C struct
-
-  data_value = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@data"));
+  gsl_matrix *p_data; // pointer to the C struct
 
-  // if @data already exists, free its content:
-  if (!mrb_nil_p(data_value)) {
-    Data_Get_Struct(mrb, data_value, &matrix_data_type, p_data);
-    free(p_data);
+  // if data already exists, free its content:
+  p_data = (gsl_matrix *)DATA_PTR(self);
+  if (p_data && DATA_TYPE(self)) {
+    DATA_TYPE(self)->dfree(mrb, p_data);
   }
+  mrb_data_init(self, NULL, &matrix_data_type);
   // Allocate and zero-out the data struct:
   p_data = gsl_matrix_calloc(n, m);
   if (!p_data)
-    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate @data");
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate matrix data");
 
-  // Wrap struct into @data:
-  mrb_iv_set(
-      mrb, self, mrb_intern_lit(mrb, "@data"), // set @data
-      mrb_obj_value(                           // with value hold in struct
-          Data_Wrap_Struct(mrb, mrb->object_class, &matrix_data_type, p_data)));
+  // Attach struct to self:
+  mrb_data_init(self, p_data, &matrix_data_type);
 }
 
 static mrb_value mrb_matrix_initialize(mrb_state *mrb, mrb_value self) {
@@ -82,45 +113,49 @@ static mrb_value mrb_matrix_initialize(mrb_state *mrb, mrb_value self) {
 
   // Call strcut initializer:
   mrb_matrix_init(mrb, self, n, m);
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@nrows"), mrb_fixnum_value(n));
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@ncols"), mrb_fixnum_value(m));
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@format"),
-             mrb_str_new_cstr(mrb, "%10.3f"));
   return mrb_nil_value();
 }
 
+static mrb_value mrb_matrix_nrows(mrb_state *mrb, mrb_value self) {
+  gsl_matrix *p_mat = NULL;
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  return mrb_fixnum_value(p_mat->size1);
+}
+
+static mrb_value mrb_matrix_ncols(mrb_state *mrb, mrb_value self) {
+  gsl_matrix *p_mat = NULL;
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  return mrb_fixnum_value(p_mat->size2);
+}
+
 static mrb_value mrb_matrix_dup(mrb_state *mrb, mrb_value self) {
   mrb_value other;
   gsl_matrix *p_mat = NULL, *p_mat_other = NULL;
-  mrb_value args[2];
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
-  args[0] = mrb_fixnum_value(p_mat->size1);
-  args[1] = mrb_fixnum_value(p_mat->size2);
-  other = mrb_obj_new(mrb, mrb_class_get(mrb, "Matrix"), 2, args);
+  other = mrb_gsl_matrix_new_uninit(mrb, p_mat->size1, p_mat->size2);
   mrb_matrix_get_data(mrb, other, &p_mat_other);
   gsl_matrix_memcpy(p_mat_other, p_mat);
   return other;
 }
 
+// Uniform in [0, 1), drawn from rng or from RNG.default
 static mrb_value mrb_matrix_rnd_fill(mrb_state *mrb, mrb_value self) {
   gsl_matrix *p_mat = NULL;
-  const gsl_rng_type *T;
+  mrb_value rng = mrb_nil_value();
   gsl_rng *r;
-  mrb_int h, k;
+  size_t h, k;
 
+  mrb_get_args(mrb, "|o", &rng);
+  r = mrb_gsl_rng_get(mrb, rng);
   mrb_matrix_get_data(mrb, self, &p_mat);
-
-  gsl_rng_env_setup();
-  T = gsl_rng_default;
-  r = gsl_rng_alloc(T);
-
-  for (k = 0; k < p_mat->size2; k++) {
-    for (h = 0; h < p_mat->size1; h++) {
-      gsl_matrix_set(p_mat, h, k, gsl_rng_uniform(r));
+  for (h = 0; h < p_mat->size1; h++) {
+    for (k = 0; k < p_mat->size2; k++) {
+      p_mat->data[h * p_mat->tda + k] = gsl_rng_uniform(r);
     }
   }
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
@@ -129,30 +164,140 @@ static mrb_value mrb_matrix_all(mrb_state *mrb, mrb_value self) {
   gsl_matrix *p_mat = NULL;
 
   mrb_get_args(mrb, "f", &v);
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   gsl_matrix_set_all(p_mat, v);
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
 static mrb_value mrb_matrix_zero(mrb_state *mrb, mrb_value self) {
   gsl_matrix *p_mat = NULL;
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   gsl_matrix_set_zero(p_mat);
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
 static mrb_value mrb_matrix_identity(mrb_state *mrb, mrb_value self) {
   gsl_matrix *p_mat = NULL;
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   gsl_matrix_set_identity(p_mat);
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
+#pragma mark -
+#pragma mark • Conversions
+
+// Copies one row, given as an Array or a Vector, into row i of p_mat
+static void matrix_fill_row(mrb_state *mrb, gsl_matrix *p_mat, size_t i,
+                            mrb_value row) {
+  double *dst = p_mat->data + i * p_mat->tda;
+  gsl_vector *p_vec = NULL;
+  size_t j;
+
+  if (mrb_array_p(row)) {
+    if (RARRAY_LEN(row) != p_mat->size2) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Rows must have the same length");
+    }
+    // RARRAY_PTR is read at each step, since #to_f could change the array
+    for (j = 0; j < p_mat->size2 && j < RARRAY_LEN(row); j++) {
+      dst[j] = mrb_gsl_to_f(mrb, RARRAY_PTR(row)[j]);
+    }
+  } else if (mrb_obj_is_kind_of(mrb, row, mrb_gsl_vector_class)) {
+    mrb_vector_get_data(mrb, row, &p_vec);
+    if (p_vec->size != p_mat->size2) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Rows must have the same length");
+    }
+    for (j = 0; j < p_vec->size; j++) {
+      dst[j] = p_vec->data[j * p_vec->stride];
+    }
+  } else {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Rows must be Arrays or Vectors");
+  }
+}
+
+static mrb_value matrix_from_rows(mrb_state *mrb, mrb_int n,
+                                  const mrb_value *rows) {
+  mrb_value result;
+  gsl_matrix *p_mat = NULL;
+  gsl_vector *p_vec = NULL;
+  mrb_int i, ncols;
+
+  if (n == 0) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need at least one row");
+  }
+  if (mrb_array_p(rows[0])) {
+    ncols = RARRAY_LEN(rows[0]);
+  } else if (mrb_obj_is_kind_of(mrb, rows[0], mrb_gsl_vector_class)) {
+    mrb_vector_get_data(mrb, rows[0], &p_vec);
+    ncols = p_vec->size;
+  } else {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Rows must be Arrays or Vectors");
+  }
+  result = mrb_gsl_matrix_new_uninit(mrb, n, ncols);
+  mrb_matrix_get_data(mrb, result, &p_mat);
+  for (i = 0; i < n; i++) {
+    matrix_fill_row(mrb, p_mat, i, rows[i]);
+  }
+  return result;
+}
+
+// Matrix[[1, 2], [3, 4]]
+static mrb_value mrb_matrix_s_new_from(mrb_state *mrb, mrb_value klass) {
+  mrb_value *argv;
+  mrb_int argc;
+  mrb_get_args(mrb, "*", &argv, &argc);
+  return matrix_from_rows(mrb, argc, argv);
+}
+
+// Matrix.from_rows([v1, v2, v3]), rows being Vectors or Arrays
+static mrb_value mrb_matrix_s_from_rows(mrb_state *mrb, mrb_value klass) {
+  mrb_value rows;
+  mrb_get_args(mrb, "A", &rows);
+  return matrix_from_rows(mrb, RARRAY_LEN(rows), RARRAY_PTR(rows));
+}
+
+// Array of rows, each an Array
+static mrb_value mrb_matrix_to_a(mrb_state *mrb, mrb_value self) {
+  mrb_value result, row;
+  gsl_matrix *p_mat = NULL;
+  size_t i, j;
+  int ai;
+
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  result = mrb_ary_new_capa(mrb, p_mat->size1);
+  ai = mrb_gc_arena_save(mrb);
+  for (i = 0; i < p_mat->size1; i++) {
+    row = mrb_ary_new_capa(mrb, p_mat->size2);
+    mrb_ary_push(mrb, result, row);
+    for (j = 0; j < p_mat->size2; j++) {
+      mrb_ary_push(mrb, row,
+                   mrb_float_value(mrb, p_mat->data[i * p_mat->tda + j]));
+      mrb_gc_arena_restore(mrb, ai);
+    }
+  }
+  return result;
+}
+
+// Column Matrix out of a Vector
+static mrb_value mrb_vector_to_mat(mrb_state *mrb, mrb_value self) {
+  mrb_value result;
+  gsl_vector *p_vec = NULL;
+  gsl_matrix *p_mat = NULL;
+
+  mrb_vector_get_data(mrb, self, &p_vec);
+  result = mrb_gsl_matrix_new_uninit(mrb, p_vec->size, 1);
+  mrb_matrix_get_data(mrb, result, &p_mat);
+  gsl_matrix_set_col(p_mat, 0, p_vec);
+  return result;
+}
+
 #pragma mark -
 #pragma mark • Tests
 
@@ -161,7 +306,7 @@ static mrb_value mrb_matrix_equal(mrb_state *mrb, mrb_value self) {
   gsl_matrix *p_mat, *p_mat_other;
   mrb_get_args(mrb, "o", &other);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   mrb_matrix_get_data(mrb, other, &p_mat_other);
   if (1 == gsl_matrix_equal(p_mat, p_mat_other))
@@ -175,20 +320,19 @@ static mrb_value mrb_matrix_equal(mrb_state *mrb, mrb_value self) {
 
 static mrb_value mrb_matrix_get_row(mrb_state *mrb, mrb_value self) {
   mrb_int i, n;
-  mrb_value result, args[1];
+  mrb_value result;
   gsl_matrix *p_mat = NULL;
   gsl_vector *p_vec = NULL;
 
   n = mrb_get_args(mrb, "|i", &i);
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
 
   if (n == 1) {
     if (i >= p_mat->size1) {
       mrb_raise(mrb, E_MATRIX_ERROR, "matrix index out of range!");
     }
-    args[0] = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@ncols"));
-    result = mrb_obj_new(mrb, mrb_class_get(mrb, "Vector"), 1, args);
+    result = mrb_gsl_vector_new_uninit(mrb, p_mat->size2);
     mrb_vector_get_data(mrb, result, &p_vec);
     gsl_matrix_get_row(p_vec, p_mat, i);
   }
@@ -203,18 +347,17 @@ static mrb_value mrb_matrix_get_row(mrb_state *mrb, mrb_value self) {
 
 static mrb_value mrb_matrix_get_col(mrb_state *mrb, mrb_value self) {
   mrb_int i;
-  mrb_value res, args[1];
+  mrb_value res;
   gsl_matrix *p_mat = NULL;
   gsl_vector *p_vec = NULL;
 
   mrb_get_args(mrb, "i", &i);
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   if (i >= p_mat->size2) {
     mrb_raise(mrb, E_MATRIX_ERROR, "matrix index out of range!");
   }
-  args[0] = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@nrows"));
-  res = mrb_obj_new(mrb, mrb_class_get(mrb, "Vector"), 1, args);
+  res = mrb_gsl_vector_new_uninit(mrb, p_mat->size1);
   mrb_vector_get_data(mrb, res, &p_vec);
   gsl_matrix_get_col(p_vec, p_mat, i);
   return res;
@@ -227,13 +370,18 @@ static mrb_value mrb_matrix_get_ij(mrb_state *mrb, mrb_value self) {
   mrb_int n;
 
   n = mrb_get_args(mrb, "|ii", &i, &j);
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   if (n == 2) {
     if (i >= p_mat->size1 || j >= p_mat->size2) {
       mrb_raise(mrb, E_MATRIX_ERROR, "matrix index out of range!");
     }
     result = mrb_float_value(mrb, gsl_matrix_get(p_mat, (size_t)i, (size_t)j));
+  } else if (n == 1) {
+    if (i >= p_mat->size1) {
+      mrb_raise(mrb, E_MATRIX_ERROR, "matrix index out of range!");
+    }
+    result = mrb_gsl_vector_view_new(mrb, self, gsl_matrix_row(p_mat, i));
   } else {
     result = mrb_matrix_get_row(mrb, self);
   }
@@ -247,12 +395,13 @@ static mrb_value mrb_matrix_set_ij(mrb_state *mrb, mrb_value self) {
 
   mrb_get_args(mrb, "iif", &i, &j, &f);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   if (i >= p_mat->size1 || j >= p_mat->size2) {
     mrb_raise(mrb, E_MATRIX_ERROR, "matrix index out of range!");
   }
   gsl_matrix_set(p_mat, (size_t)i, (size_t)j, (double)f);
+  mrb_gsl_touch(mrb, self);
   return mrb_float_value(mrb, f);
 }
 
@@ -263,7 +412,7 @@ static mrb_value mrb_matrix_set_row(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec = NULL;
 
   mrb_get_args(mrb, "io", &i, &other);
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   if (i >= p_mat->size1) {
     mrb_raise(mrb, E_MATRIX_ERROR, "matrix row index out of range!");
@@ -273,6 +422,7 @@ static mrb_value mrb_matrix_set_row(mrb_state *mrb, mrb_value self) {
     mrb_raise(mrb, E_MATRIX_ERROR, "Size mismatch!");
   }
   gsl_matrix_set_row(p_mat, i, p_vec);
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
@@ -283,7 +433,7 @@ static mrb_value mrb_matrix_set_col(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec = NULL;
 
   mrb_get_args(mrb, "io", &i, &other);
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   if (i >= p_mat->size2) {
     mrb_raise(mrb, E_MATRIX_ERROR, "matrix col index out of range!");
@@ -293,24 +443,76 @@ static mrb_value mrb_matrix_set_col(mrb_state *mrb, mrb_value self) {
     mrb_raise(mrb, E_MATRIX_ERROR, "Size mismatch!");
   }
   gsl_matrix_set_col(p_mat, i, p_vec);
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
 #pragma mark -
-#pragma mark • Properties
+#pragma mark • Views
 
-static mrb_value mrb_matrix_max(mrb_state *mrb, mrb_value self) {
+static mrb_value mrb_matrix_row_view(mrb_state *mrb, mrb_value self) {
+  mrb_int i;
+  gsl_matrix *p_mat = NULL;
+
+  mrb_get_args(mrb, "i", &i);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  if (i >= p_mat->size1) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix index out of range!");
+  }
+  return mrb_gsl_vector_view_new(mrb, self, gsl_matrix_row(p_mat, i));
+}
+
+static mrb_value mrb_matrix_col_view(mrb_state *mrb, mrb_value self) {
+  mrb_int j;
   gsl_matrix *p_mat = NULL;
+
+  mrb_get_args(mrb, "i", &j);
   mrb_matrix_get_data(mrb, self, &p_mat);
-  return mrb_float_value(mrb, gsl_matrix_max(p_mat));
+  if (j >= p_mat->size2) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix index out of range!");
+  }
+  return mrb_gsl_vector_view_new(mrb, self, gsl_matrix_column(p_mat, j));
 }
 
-static mrb_value mrb_matrix_min(mrb_state *mrb, mrb_value self) {
+// k > 0 gives the k-th superdiagonal, k < 0 the k-th subdiagonal
+static mrb_value mrb_matrix_diagonal(mrb_state *mrb, mrb_value self) {
+  mrb_int k = 0;
+  gsl_matrix *p_mat = NULL;
+  gsl_vector_view view;
+
+  mrb_get_args(mrb, "|i", &k);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  if (k >= 0) {
+    if (k >= p_mat->size2) {
+      mrb_raise(mrb, E_MATRIX_ERROR, "matrix index out of range!");
+    }
+    view = gsl_matrix_superdiagonal(p_mat, k);
+  } else {
+    if (-k >= p_mat->size1) {
+      mrb_raise(mrb, E_MATRIX_ERROR, "matrix index out of range!");
+    }
+    view = gsl_matrix_subdiagonal(p_mat, -k);
+  }
+  return mrb_gsl_vector_view_new(mrb, self, view);
+}
+
+static mrb_value mrb_matrix_submatrix(mrb_state *mrb, mrb_value self) {
+  mrb_int i, j, n1, n2;
   gsl_matrix *p_mat = NULL;
+
+  mrb_get_args(mrb, "iiii", &i, &j, &n1, &n2);
   mrb_matrix_get_data(mrb, self, &p_mat);
-  return mrb_float_value(mrb, gsl_matrix_min(p_mat));
+  if (i < 0 || j < 0 || n1 <= 0 || n2 <= 0 || i + n1 > p_mat->size1 ||
+      j + n2 > p_mat->size2) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "Submatrix out of range!");
+  }
+  return mrb_gsl_matrix_view_new(mrb, self,
+                                 gsl_matrix_submatrix(p_mat, i, j, n1, n2));
 }
 
+#pragma mark -
+#pragma mark • Properties
+
 static mrb_value mrb_matrix_max_index(mrb_state *mrb, mrb_value self) {
   size_t i, j;
   mrb_value res = mrb_ary_new_capa(mrb, 2);
@@ -341,18 +543,19 @@ static mrb_value mrb_matrix_add(mrb_state *mrb, mrb_value self) {
   gsl_matrix *p_mat, *p_mat_other;
   mrb_get_args(mrb, "o", &other);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
-  if (mrb_obj_is_kind_of(mrb, other, mrb_class_get(mrb, "Matrix"))) {
+  if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_matrix_class)) {
     mrb_matrix_get_data(mrb, other, &p_mat_other);
     if (p_mat->size1 != p_mat_other->size1 ||
         p_mat->size2 != p_mat_other->size2) {
       mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
     }
     gsl_matrix_add(p_mat, p_mat_other);
-  } else if (mrb_obj_is_kind_of(mrb, other, mrb_class_get(mrb, "Numeric"))) {
+  } else if ((mrb_float_p(other) || mrb_fixnum_p(other))) {
     gsl_matrix_add_constant(p_mat, mrb_to_flo(mrb, other));
   }
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
@@ -361,7 +564,7 @@ static mrb_value mrb_matrix_sub(mrb_state *mrb, mrb_value self) {
   gsl_matrix *p_mat, *p_mat_other;
   mrb_get_args(mrb, "o", &other);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   mrb_matrix_get_data(mrb, other, &p_mat_other);
   if (p_mat->size1 != p_mat_other->size1 ||
@@ -369,6 +572,7 @@ static mrb_value mrb_matrix_sub(mrb_state *mrb, mrb_value self) {
     mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
   }
   gsl_matrix_sub(p_mat, p_mat_other);
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
@@ -377,18 +581,19 @@ static mrb_value mrb_matrix_mul(mrb_state *mrb, mrb_value self) {
   gsl_matrix *p_mat, *p_mat_other;
   mrb_get_args(mrb, "o", &other);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
-  if (mrb_obj_is_kind_of(mrb, other, mrb_class_get(mrb, "Matrix"))) {
+  if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_matrix_class)) {
     mrb_matrix_get_data(mrb, other, &p_mat_other);
     if (p_mat->size1 != p_mat_other->size1 ||
         p_mat->size2 != p_mat_other->size2) {
       mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
     }
     gsl_matrix_mul_elements(p_mat, p_mat_other);
-  } else if (mrb_obj_is_kind_of(mrb, other, mrb_class_get(mrb, "Numeric"))) {
+  } else if ((mrb_float_p(other) || mrb_fixnum_p(other))) {
     gsl_matrix_scale(p_mat, mrb_to_flo(mrb, other));
   }
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
@@ -396,44 +601,90 @@ static mrb_value mrb_matrix_prod(mrb_state *mrb, mrb_value self) {
   mrb_value other, res;
   gsl_matrix *p_mat, *p_mat_other, *p_mat_res;
   gsl_vector *p_vec_other, *p_vec_res;
-  mrb_value args[2];
   mrb_get_args(mrb, "o", &other);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
 
-  if (mrb_obj_is_kind_of(mrb, other, mrb_class_get(mrb, "Matrix"))) {
-    args[1] = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@nrows"));
-    args[0] = mrb_iv_get(mrb, other, mrb_intern_lit(mrb, "@ncols"));
-    res = mrb_obj_new(mrb, mrb_class_get(mrb, "Matrix"), 2, args);
+  if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_matrix_class)) {
     mrb_matrix_get_data(mrb, other, &p_mat_other);
-    mrb_matrix_get_data(mrb, res, &p_mat_res);
-
     if (p_mat->size2 != p_mat_other->size1) {
       mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
     }
+    res = mrb_gsl_matrix_new_uninit(mrb, p_mat->size1, p_mat_other->size2);
+    mrb_matrix_get_data(mrb, res, &p_mat_res);
+
     gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, p_mat, p_mat_other, 0.0,
                    p_mat_res);
-  } else if (mrb_obj_is_kind_of(mrb, other, mrb_class_get(mrb, "Vector"))) {
-    args[0] = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@nrows"));
-    res = mrb_obj_new(mrb, mrb_class_get(mrb, "Vector"), 1, args);
+  } else if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_vector_class)) {
     mrb_vector_get_data(mrb, other, &p_vec_other);
-    mrb_vector_get_data(mrb, res, &p_vec_res);
-
     if (p_mat->size2 != p_vec_other->size) {
       mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
     }
+    res = mrb_gsl_vector_new_uninit(mrb, p_mat->size1);
+    mrb_vector_get_data(mrb, res, &p_vec_res);
+
     gsl_blas_dgemv(CblasNoTrans, 1.0, p_mat, p_vec_other, 0.0, p_vec_res);
+  } else {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Matrix or a Vector!");
   }
   return res;
 }
 
+static mrb_value mrb_matrix_mmul_into(mrb_state *mrb, mrb_value self) {
+  mrb_value other, out;
+  gsl_matrix *p_mat, *p_mat_other, *p_mat_out;
+  gsl_vector *p_vec_other, *p_vec_out;
+  mrb_get_args(mrb, "oo", &other, &out);
+
+  // call utility for unwrapping data into p_mat:
+  mrb_matrix_get_data(mrb, self, &p_mat);
+
+  if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_matrix_class)) {
+    mrb_matrix_get_data(mrb, other, &p_mat_other);
+    mrb_matrix_get_data(mrb, out, &p_mat_out);
+    if (p_mat->size2 != p_mat_other->size1 ||
+        p_mat_out->size1 != p_mat->size1 ||
+        p_mat_out->size2 != p_mat_other->size2) {
+      mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+    }
+    if (mrb_gsl_overlap(p_mat_out->data, mrb_gsl_matrix_span(p_mat_out),
+                        p_mat->data, mrb_gsl_matrix_span(p_mat)) ||
+        mrb_gsl_overlap(p_mat_out->data, mrb_gsl_matrix_span(p_mat_out),
+                        p_mat_other->data,
+                        mrb_gsl_matrix_span(p_mat_other))) {
+      mrb_raise(mrb, E_MATRIX_ERROR, "Output must not alias an operand");
+    }
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, p_mat, p_mat_other, 0.0,
+                   p_mat_out);
+  } else if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_vector_class)) {
+    mrb_vector_get_data(mrb, other, &p_vec_other);
+    mrb_vector_get_data(mrb, out, &p_vec_out);
+    if (p_mat->size2 != p_vec_other->size ||
+        p_vec_out->size != p_mat->size1) {
+      mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+    }
+    if (mrb_gsl_overlap(p_vec_out->data, mrb_gsl_vector_span(p_vec_out),
+                        p_mat->data, mrb_gsl_matrix_span(p_mat)) ||
+        mrb_gsl_overlap(p_vec_out->data, mrb_gsl_vector_span(p_vec_out),
+                        p_vec_other->data,
+                        mrb_gsl_vector_span(p_vec_other))) {
+      mrb_raise(mrb, E_MATRIX_ERROR, "Output must not alias an operand");
+    }
+    gsl_blas_dgemv(CblasNoTrans, 1.0, p_mat, p_vec_other, 0.0, p_vec_out);
+  } else {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Matrix or a Vector!");
+  }
+  mrb_gsl_touch(mrb, out);
+  return out;
+}
+
 static mrb_value mrb_matrix_div(mrb_state *mrb, mrb_value self) {
   mrb_value other;
   gsl_matrix *p_mat, *p_mat_other;
   mrb_get_args(mrb, "o", &other);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   mrb_matrix_get_data(mrb, other, &p_mat_other);
   if (p_mat->size1 != p_mat_other->size1 ||
@@ -441,12 +692,13 @@ static mrb_value mrb_matrix_div(mrb_state *mrb, mrb_value self) {
     mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
   }
   gsl_matrix_div_elements(p_mat, p_mat_other);
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
 static mrb_value mrb_matrix_transpose_self(mrb_state *mrb, mrb_value self) {
   gsl_matrix *p_mat;
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   if (p_mat->size1 != p_mat->size2) {
     mrb_raise(mrb, E_MATRIX_ERROR, "matrix must be square!");
@@ -454,19 +706,17 @@ static mrb_value mrb_matrix_transpose_self(mrb_state *mrb, mrb_value self) {
   if (gsl_matrix_transpose(p_mat)) {
     mrb_raise(mrb, E_MATRIX_ERROR, "Cannot calculate transposed matrix");
   }
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
 static mrb_value mrb_matrix_transpose(mrb_state *mrb, mrb_value self) {
   mrb_value other;
   gsl_matrix *p_mat, *p_mat_other;
-  mrb_value args[2];
-  // swap dimensions!
-  args[1] = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@nrows"));
-  args[0] = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@ncols"));
-  other = mrb_obj_new(mrb, mrb_class_get(mrb, "Matrix"), 2, args);
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
+  // swap dimensions!
+  other = mrb_gsl_matrix_new_uninit(mrb, p_mat->size2, p_mat->size1);
   mrb_matrix_get_data(mrb, other, &p_mat_other);
   if (gsl_matrix_transpose_memcpy(p_mat_other, p_mat)) {
     mrb_raise(mrb, E_MATRIX_ERROR, "Cannot calculate transposed matrix");
@@ -474,16 +724,138 @@ static mrb_value mrb_matrix_transpose(mrb_state *mrb, mrb_value self) {
   return other;
 }
 
+static mrb_value mrb_matrix_transpose_into(mrb_state *mrb, mrb_value self) {
+  mrb_value out;
+  gsl_matrix *p_mat, *p_mat_out;
+  mrb_get_args(mrb, "o", &out);
+
+  // call utility for unwrapping data into p_mat:
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  mrb_matrix_get_data(mrb, out, &p_mat_out);
+  if (p_mat_out->size1 != p_mat->size2 || p_mat_out->size2 != p_mat->size1) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+  }
+  if (mrb_gsl_overlap(p_mat_out->data, mrb_gsl_matrix_span(p_mat_out),
+                      p_mat->data, mrb_gsl_matrix_span(p_mat))) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "Output must not alias an operand");
+  }
+  if (gsl_matrix_transpose_memcpy(p_mat_out, p_mat)) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "Cannot calculate transposed matrix");
+  }
+  mrb_gsl_touch(mrb, out);
+  return out;
+}
+
+// Non-destructive and output-argument versions of add!, sub!, mul!, div!
+
+// out = self <op> other, other being a Matrix or a Numeric
+static void mrb_matrix_elementwise(mrb_state *mrb, char op, mrb_value self,
+                                   mrb_value other, gsl_matrix *p_out) {
+  gsl_matrix *p_mat, *p_mat_other = NULL;
+  double k = 0;
+  size_t i;
+
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  if (p_out->size1 != p_mat->size1 || p_out->size2 != p_mat->size2) {
+    mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+  }
+  if (mrb_float_p(other) || mrb_fixnum_p(other)) {
+    k = mrb_to_flo(mrb, other);
+  } else {
+    if (!mrb_obj_is_kind_of(mrb, other, mrb_gsl_matrix_class)) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Matrix or a Numeric!");
+    }
+    mrb_matrix_get_data(mrb, other, &p_mat_other);
+    if (p_mat->size1 != p_mat_other->size1 ||
+        p_mat->size2 != p_mat_other->size2) {
+      mrb_raise(mrb, E_MATRIX_ERROR, "matrix dimensions don't match!");
+    }
+  }
+  // row by row, since views have tda != size2
+  for (i = 0; i < p_mat->size1; i++) {
+    if (p_mat_other) {
+      mrb_gsl_elementwise(op, p_mat->size2, p_out->data + i * p_out->tda, 1,
+                          p_mat->data + i * p_mat->tda, 1,
+                          p_mat_other->data + i * p_mat_other->tda, 1);
+    } else {
+      mrb_gsl_elementwise(op, p_mat->size2, p_out->data + i * p_out->tda, 1,
+                          p_mat->data + i * p_mat->tda, 1, &k, 0);
+    }
+  }
+}
+
+static mrb_value mrb_matrix_op_new(mrb_state *mrb, mrb_value self, char op) {
+  mrb_value other, res;
+  gsl_matrix *p_mat, *p_res;
+  mrb_get_args(mrb, "o", &other);
+
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  res = mrb_gsl_matrix_new_uninit(mrb, p_mat->size1, p_mat->size2);
+  mrb_matrix_get_data(mrb, res, &p_res);
+  mrb_matrix_elementwise(mrb, op, self, other, p_res);
+  return res;
+}
+
+static mrb_value mrb_matrix_op_into(mrb_state *mrb, mrb_value self, char op) {
+  mrb_value other, out;
+  gsl_matrix *p_out;
+  mrb_get_args(mrb, "oo", &other, &out);
+
+  mrb_matrix_get_data(mrb, out, &p_out);
+  mrb_matrix_elementwise(mrb, op, self, other, p_out);
+  mrb_gsl_touch(mrb, out);
+  return out;
+}
+
+static mrb_value mrb_matrix_plus(mrb_state *mrb, mrb_value self) {
+  return mrb_matrix_op_new(mrb, self, '+');
+}
+
+static mrb_value mrb_matrix_minus(mrb_state *mrb, mrb_value self) {
+  return mrb_matrix_op_new(mrb, self, '-');
+}
+
+static mrb_value mrb_matrix_times(mrb_state *mrb, mrb_value self) {
+  mrb_value other;
+  mrb_get_args(mrb, "o", &other);
+  // Matrix * Vector is the matrix-vector product
+  if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_vector_class)) {
+    return mrb_matrix_prod(mrb, self);
+  }
+  return mrb_matrix_op_new(mrb, self, '*');
+}
+
+static mrb_value mrb_matrix_over(mrb_state *mrb, mrb_value self) {
+  return mrb_matrix_op_new(mrb, self, '/');
+}
+
+static mrb_value mrb_matrix_add_into(mrb_state *mrb, mrb_value self) {
+  return mrb_matrix_op_into(mrb, self, '+');
+}
+
+static mrb_value mrb_matrix_sub_into(mrb_state *mrb, mrb_value self) {
+  return mrb_matrix_op_into(mrb, self, '-');
+}
+
+static mrb_value mrb_matrix_mul_into(mrb_state *mrb, mrb_value self) {
+  return mrb_matrix_op_into(mrb, self, '*');
+}
+
+static mrb_value mrb_matrix_div_into(mrb_state *mrb, mrb_value self) {
+  return mrb_matrix_op_into(mrb, self, '/');
+}
+
 static mrb_value mrb_matrix_swap_rows(mrb_state *mrb, mrb_value self) {
   gsl_matrix *p_mat;
   mrb_int i, j;
   mrb_get_args(mrb, "ii", &i, &j);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   if (gsl_matrix_swap_rows(p_mat, i, j)) {
     mrb_raise(mrb, E_MATRIX_ERROR, "Cannot swap rows");
   }
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
@@ -492,14 +864,455 @@ static mrb_value mrb_matrix_swap_cols(mrb_state *mrb, mrb_value self) {
   mrb_int i, j;
   mrb_get_args(mrb, "ii", &i, &j);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_mat:
   mrb_matrix_get_data(mrb, self, &p_mat);
   if (gsl_matrix_swap_columns(p_mat, i, j)) {
     mrb_raise(mrb, E_MATRIX_ERROR, "Cannot swap cols");
   }
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
+#pragma mark -
+#pragma mark • Statistics
+
+typedef enum { REDUCE_SUM, REDUCE_SUMSQ, REDUCE_MAX, REDUCE_MIN } reduce_op;
+
+// axis: 0 reduces each column (one result per column), 1 reduces each row,
+// nil reduces the whole matrix (returned as -1)
+static mrb_int matrix_axis(mrb_state *mrb, mrb_value opts) {
+  mrb_value v;
+  if (!mrb_hash_p(opts))
+    return -1;
+  v = mrb_hash_get(mrb, opts, mrb_symbol_value(mrb_intern_lit(mrb, "axis")));
+  if (mrb_nil_p(v))
+    return -1;
+  if (!mrb_fixnum_p(v) || (mrb_fixnum(v) != 0 && mrb_fixnum(v) != 1)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "axis must be 0 or 1");
+  }
+  return mrb_fixnum(v);
+}
+
+// Reduces m along axis into res (size2 results for axis 0, size1 for axis
+// 1). The matrix is always read row by row, in memory order: for axis 0 the
+// partial results of all the columns are updated at each row, rather than
+// walking down each column with a stride of tda. REDUCE_SUMSQ subtracts
+// center (one value per result, may be NULL) before squaring. MAX and MIN
+// store the index of the first extreme in idx (may be NULL), and propagate
+// NaNs as gsl_matrix_max does.
+static void matrix_reduce(const gsl_matrix *m, mrb_int axis, reduce_op op,
+                          const double *center, double *res, size_t *idx) {
+  size_t i, j, n1 = m->size1, n2 = m->size2;
+  const double *row;
+  double x, acc;
+
+  if (axis == 0) {
+    if (op == REDUCE_MAX || op == REDUCE_MIN) {
+      memcpy(res, m->data, n2 * sizeof(double));
+      if (idx)
+        memset(idx, 0, n2 * sizeof(size_t));
+    } else {
+      memset(res, 0, n2 * sizeof(double));
+    }
+    for (i = 0; i < n1; i++) {
+      row = m->data + i * m->tda;
+      switch (op) {
+      case REDUCE_SUM:
+        for (j = 0; j < n2; j++)
+          res[j] += row[j];
+        break;
+      case REDUCE_SUMSQ:
+        if (center) {
+          for (j = 0; j < n2; j++) {
+            x = row[j] - center[j];
+            res[j] += x * x;
+          }
+        } else {
+          for (j = 0; j < n2; j++)
+            res[j] += row[j] * row[j];
+        }
+        break;
+      case REDUCE_MAX:
+        for (j = 0; j < n2; j++) {
+          if (row[j] > res[j] || (isnan(row[j]) && !isnan(res[j]))) {
+            res[j] = row[j];
+            if (idx)
+              idx[j] = i;
+          }
+        }
+        break;
+      case REDUCE_MIN:
+        for (j = 0; j < n2; j++) {
+          if (row[j] < res[j] || (isnan(row[j]) && !isnan(res[j]))) {
+            res[j] = row[j];
+            if (idx)
+              idx[j] = i;
+          }
+        }
+        break;
+      }
+    }
+  } else {
+    for (i = 0; i < n1; i++) {
+      row = m->data + i * m->tda;
+      acc = (op == REDUCE_MAX || op == REDUCE_MIN) ? row[0] : 0.0;
+      if (idx)
+        idx[i] = 0;
+      switch (op) {
+      case REDUCE_SUM:
+        for (j = 0; j < n2; j++)
+          acc += row[j];
+        break;
+      case REDUCE_SUMSQ:
+        x = center ? center[i] : 0.0;
+        for (j = 0; j < n2; j++)
+          acc += (row[j] - x) * (row[j] - x);
+        break;
+      case REDUCE_MAX:
+        for (j = 1; j < n2; j++) {
+          if (row[j] > acc || (isnan(row[j]) && !isnan(acc))) {
+            acc = row[j];
+            if (idx)
+              idx[i] = j;
+          }
+        }
+        break;
+      case REDUCE_MIN:
+        for (j = 1; j < n2; j++) {
+          if (row[j] < acc || (isnan(row[j]) && !isnan(acc))) {
+            acc = row[j];
+            if (idx)
+              idx[i] = j;
+          }
+        }
+        break;
+      }
+      res[i] = acc;
+    }
+  }
+}
+
+// Runs the reduction along axis, into a new Vector
+static mrb_value matrix_reduce_new(mrb_state *mrb, gsl_matrix *p_mat,
+                                   mrb_int axis, reduce_op op,
+                                   const double *center, gsl_vector **p_res) {
+  mrb_value res = mrb_gsl_vector_new_uninit(
+      mrb, axis == 0 ? p_mat->size2 : p_mat->size1);
+  mrb_vector_get_data(mrb, res, p_res);
+  matrix_reduce(p_mat, axis, op, center, (*p_res)->data, NULL);
+  return res;
+}
+
+// Sum (or sum of squares) of all the elements, adding up the row results
+static double matrix_total(mrb_state *mrb, gsl_matrix *p_mat,
+                           reduce_op op) {
+  gsl_vector *p_rows = gsl_vector_alloc(p_mat->size1);
+  double total = 0;
+  size_t i;
+
+  if (!p_rows)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate vector data");
+  matrix_reduce(p_mat, 1, op, NULL, p_rows->data, NULL);
+  for (i = 0; i < p_mat->size1; i++)
+    total += p_rows->data[i];
+  gsl_vector_free(p_rows);
+  return total;
+}
+
+// Sum of all the elements, or a Vector of sums along axis:
+static mrb_value mrb_matrix_sum(mrb_state *mrb, mrb_value self) {
+  mrb_value opts = mrb_nil_value();
+  gsl_matrix *p_mat = NULL;
+  gsl_vector *p_res = NULL;
+  mrb_int axis;
+
+  mrb_get_args(mrb, "|H", &opts);
+  axis = matrix_axis(mrb, opts);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  if (axis < 0)
+    return mrb_float_value(mrb, matrix_total(mrb, p_mat, REDUCE_SUM));
+  return matrix_reduce_new(mrb, p_mat, axis, REDUCE_SUM, NULL, &p_res);
+}
+
+// Means along axis into res, n being the number of elements reduced
+static void matrix_means(gsl_matrix *p_mat, mrb_int axis, gsl_vector *res) {
+  size_t n = axis == 0 ? p_mat->size1 : p_mat->size2;
+  matrix_reduce(p_mat, axis, REDUCE_SUM, NULL, res->data, NULL);
+  gsl_vector_scale(res, 1.0 / n);
+}
+
+static mrb_value mrb_matrix_mean(mrb_state *mrb, mrb_value self) {
+  mrb_value opts = mrb_nil_value(), res;
+  gsl_matrix *p_mat = NULL;
+  gsl_vector *p_res = NULL;
+  mrb_int axis;
+
+  mrb_get_args(mrb, "|H", &opts);
+  axis = matrix_axis(mrb, opts);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  if (axis < 0) {
+    return mrb_float_value(mrb, matrix_total(mrb, p_mat, REDUCE_SUM) /
+                                    (p_mat->size1 * p_mat->size2));
+  }
+  res = mrb_gsl_vector_new_uninit(mrb, axis == 0 ? p_mat->size2
+                                                 : p_mat->size1);
+  mrb_vector_get_data(mrb, res, &p_res);
+  matrix_means(p_mat, axis, p_res);
+  return res;
+}
+
+// Sample variance (divided by n - 1, as Vector#variance), computed in two
+// passes: the means first, then the squared deviations from them
+static mrb_value mrb_matrix_variance(mrb_state *mrb, mrb_value self) {
+  mrb_value opts = mrb_nil_value(), res;
+  gsl_matrix *p_mat = NULL;
+  gsl_vector *p_res = NULL, *p_mean;
+  mrb_int axis;
+  size_t n;
+  double mean, ss = 0;
+  size_t i, j;
+
+  mrb_get_args(mrb, "|H", &opts);
+  axis = matrix_axis(mrb, opts);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  if (axis < 0) {
+    n = p_mat->size1 * p_mat->size2;
+    mean = matrix_total(mrb, p_mat, REDUCE_SUM) / n;
+    for (i = 0; i < p_mat->size1; i++) {
+      for (j = 0; j < p_mat->size2; j++) {
+        ss += (p_mat->data[i * p_mat->tda + j] - mean) *
+              (p_mat->data[i * p_mat->tda + j] - mean);
+      }
+    }
+    return mrb_float_value(mrb, ss / (n - 1));
+  }
+  n = axis == 0 ? p_mat->size1 : p_mat->size2;
+  // the result first, as allocating it can raise
+  res = mrb_gsl_vector_new_uninit(mrb, axis == 0 ? p_mat->size2
+                                                 : p_mat->size1);
+  mrb_vector_get_data(mrb, res, &p_res);
+  p_mean = gsl_vector_alloc(p_res->size);
+  if (!p_mean)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate vector data");
+  matrix_means(p_mat, axis, p_mean);
+  matrix_reduce(p_mat, axis, REDUCE_SUMSQ, p_mean->data, p_res->data, NULL);
+  gsl_vector_free(p_mean);
+  gsl_vector_scale(p_res, 1.0 / (n - 1));
+  return res;
+}
+
+// Euclidean norms of the rows or columns; without axis, the Frobenius norm
+static mrb_value mrb_matrix_norm(mrb_state *mrb, mrb_value self) {
+  mrb_value opts = mrb_nil_value(), res;
+  gsl_matrix *p_mat = NULL;
+  gsl_vector *p_res = NULL;
+  mrb_int axis;
+  size_t i;
+
+  mrb_get_args(mrb, "|H", &opts);
+  axis = matrix_axis(mrb, opts);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  if (axis < 0)
+    return mrb_float_value(mrb, sqrt(matrix_total(mrb, p_mat, REDUCE_SUMSQ)));
+  res = matrix_reduce_new(mrb, p_mat, axis, REDUCE_SUMSQ, NULL, &p_res);
+  for (i = 0; i < p_res->size; i++)
+    p_res->data[i] = sqrt(p_res->data[i]);
+  return res;
+}
+
+static mrb_value matrix_extreme(mrb_state *mrb, mrb_value self,
+                                reduce_op op) {
+  mrb_value opts = mrb_nil_value();
+  gsl_matrix *p_mat = NULL;
+  gsl_vector *p_res = NULL;
+  mrb_int axis;
+
+  mrb_get_args(mrb, "|H", &opts);
+  axis = matrix_axis(mrb, opts);
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  if (axis < 0) {
+    return mrb_float_value(mrb, op == REDUCE_MAX ? gsl_matrix_max(p_mat)
+                                                 : gsl_matrix_min(p_mat));
+  }
+  return matrix_reduce_new(mrb, p_mat, axis, op, NULL, &p_res);
+}
+
+static mrb_value mrb_matrix_max(mrb_state *mrb, mrb_value self) {
+  return matrix_extreme(mrb, self, REDUCE_MAX);
+}
+
+static mrb_value mrb_matrix_min(mrb_state *mrb, mrb_value self) {
+  return matrix_extreme(mrb, self, REDUCE_MIN);
+}
+
+// Indexes of the extremes along axis, as an Array of Integers (the same
+// as max_index/min_index without axis)
+static mrb_value matrix_arg_extreme(mrb_state *mrb, mrb_value self,
+                                    reduce_op op) {
+  mrb_value opts = mrb_nil_value(), res;
+  gsl_matrix *p_mat = NULL;
+  mrb_int axis;
+  size_t i, n, *idx;
+  double *ext;
+  int ai;
+
+  mrb_get_args(mrb, "|H", &opts);
+  axis = matrix_axis(mrb, opts);
+  if (axis < 0) {
+    return op == REDUCE_MAX ? mrb_matrix_max_index(mrb, self)
+                            : mrb_matrix_min_index(mrb, self);
+  }
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  n = axis == 0 ? p_mat->size2 : p_mat->size1;
+  ext = (double *)mrb_malloc(mrb, n * sizeof(double));
+  idx = (size_t *)mrb_malloc(mrb, n * sizeof(size_t));
+  matrix_reduce(p_mat, axis, op, NULL, ext, idx);
+  mrb_free(mrb, ext);
+  res = mrb_ary_new_capa(mrb, n);
+  ai = mrb_gc_arena_save(mrb);
+  for (i = 0; i < n; i++) {
+    mrb_ary_push(mrb, res, mrb_fixnum_value(idx[i]));
+    mrb_gc_arena_restore(mrb, ai);
+  }
+  mrb_free(mrb, idx);
+  return res;
+}
+
+static mrb_value mrb_matrix_argmax(mrb_state *mrb, mrb_value self) {
+  return matrix_arg_extreme(mrb, self, REDUCE_MAX);
+}
+
+static mrb_value mrb_matrix_argmin(mrb_state *mrb, mrb_value self) {
+  return matrix_arg_extreme(mrb, self, REDUCE_MIN);
+}
+
+#pragma mark -
+#pragma mark • Iterators
+
+static mrb_value matrix_block(mrb_state *mrb) {
+  mrb_value blk;
+  mrb_get_args(mrb, "&", &blk);
+  if (mrb_nil_p(blk)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a block");
+  }
+  return blk;
+}
+
+// Yields the elements row by row. The struct is fetched again at each
+// step, as the block could reinitialize self
+static mrb_value mrb_matrix_each(mrb_state *mrb, mrb_value self) {
+  mrb_value blk = matrix_block(mrb);
+  gsl_matrix *p_mat = NULL;
+  size_t i, j;
+  int ai = mrb_gc_arena_save(mrb);
+
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  for (i = 0; i < p_mat->size1; i++) {
+    for (j = 0; j < p_mat->size2; j++) {
+      mrb_yield(mrb, blk,
+                mrb_float_value(mrb, p_mat->data[i * p_mat->tda + j]));
+      mrb_gc_arena_restore(mrb, ai);
+      mrb_matrix_get_data(mrb, self, &p_mat);
+      if (i >= p_mat->size1)
+        return self;
+    }
+  }
+  return self;
+}
+
+static mrb_value mrb_matrix_each_with_indexes(mrb_state *mrb,
+                                              mrb_value self) {
+  mrb_value blk = matrix_block(mrb), args[3];
+  gsl_matrix *p_mat = NULL;
+  size_t i, j;
+  int ai = mrb_gc_arena_save(mrb);
+
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  for (i = 0; i < p_mat->size1; i++) {
+    for (j = 0; j < p_mat->size2; j++) {
+      args[0] = mrb_float_value(mrb, p_mat->data[i * p_mat->tda + j]);
+      args[1] = mrb_fixnum_value(i);
+      args[2] = mrb_fixnum_value(j);
+      mrb_yield_argv(mrb, blk, 3, args);
+      mrb_gc_arena_restore(mrb, ai);
+      mrb_matrix_get_data(mrb, self, &p_mat);
+      if (i >= p_mat->size1)
+        return self;
+    }
+  }
+  return self;
+}
+
+static mrb_value mrb_matrix_map_bang(mrb_state *mrb, mrb_value self) {
+  mrb_value blk = matrix_block(mrb), v;
+  gsl_matrix *p_mat = NULL;
+  size_t i, j, size1, size2;
+  double x;
+  int ai = mrb_gc_arena_save(mrb);
+
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  size1 = p_mat->size1;
+  size2 = p_mat->size2;
+  for (i = 0; i < size1; i++) {
+    for (j = 0; j < size2; j++) {
+      v = mrb_yield(mrb, blk,
+                    mrb_float_value(mrb, p_mat->data[i * p_mat->tda + j]));
+      x = mrb_gsl_to_f(mrb, v);
+      // the block (or to_f) could have reinitialized self
+      mrb_matrix_get_data(mrb, self, &p_mat);
+      if (p_mat->size1 != size1 || p_mat->size2 != size2) {
+        mrb_raise(mrb, E_MATRIX_ERROR, "Matrix resized during map!");
+      }
+      // before each write, since the block may raise or cache a new LU
+      mrb_gsl_touch(mrb, self);
+      p_mat->data[i * p_mat->tda + j] = x;
+      mrb_gc_arena_restore(mrb, ai);
+    }
+  }
+  return self;
+}
+
+// Yields (view, index) for each row or column. A single view object is
+// moved along the matrix, so the block must dup it to keep a copy
+static mrb_value matrix_each_line(mrb_state *mrb, mrb_value self,
+                                  mrb_bool rows) {
+  mrb_value blk = matrix_block(mrb), view, args[2];
+  gsl_matrix *p_mat = NULL;
+  gsl_vector *p_view = NULL;
+  size_t i, n;
+  int ai;
+
+  mrb_matrix_get_data(mrb, self, &p_mat);
+  n = rows ? p_mat->size1 : p_mat->size2;
+  if (n == 0)
+    return self;
+  view = mrb_gsl_vector_view_new(mrb, self, rows ? gsl_matrix_row(p_mat, 0)
+                                                 : gsl_matrix_column(p_mat, 0));
+  mrb_vector_get_data(mrb, view, &p_view);
+  ai = mrb_gc_arena_save(mrb);
+  for (i = 0; i < n; i++) {
+    // re-aim the view, in case the block reinitialized self
+    mrb_matrix_get_data(mrb, self, &p_mat);
+    if (i >= (rows ? p_mat->size1 : p_mat->size2))
+      break;
+    *p_view = rows ? gsl_matrix_row(p_mat, i).vector
+                   : gsl_matrix_column(p_mat, i).vector;
+    args[0] = view;
+    args[1] = mrb_fixnum_value(i);
+    mrb_yield_argv(mrb, blk, 2, args);
+    mrb_gc_arena_restore(mrb, ai);
+  }
+  return self;
+}
+
+static mrb_value mrb_matrix_each_row(mrb_state *mrb, mrb_value self) {
+  return matrix_each_line(mrb, self, 1);
+}
+
+static mrb_value mrb_matrix_each_col(mrb_state *mrb, mrb_value self) {
+  return matrix_each_line(mrb, self, 0);
+}
+
 #pragma mark -
 #pragma mark • Gem setup
 
@@ -509,13 +1322,24 @@ void mrb_gsl_matrix_init(mrb_state *mrb) {
   mrb_load_string(mrb, "class MatrixError < Exception; end");
 
   gsl = mrb_define_class(mrb, "Matrix", mrb->object_class);
+  MRB_SET_INSTANCE_TT(gsl, MRB_TT_DATA);
+  mrb_gsl_matrix_class = gsl;
   mrb_define_method(mrb, gsl, "initialize", mrb_matrix_initialize,
                     MRB_ARGS_NONE());
+  mrb_define_class_method(mrb, gsl, "[]", mrb_matrix_s_new_from,
+                          MRB_ARGS_ANY());
+  mrb_define_class_method(mrb, gsl, "from_rows", mrb_matrix_s_from_rows,
+                          MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "to_a", mrb_matrix_to_a, MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_gsl_vector_class, "to_mat", mrb_vector_to_mat,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, gsl, "nrows", mrb_matrix_nrows, MRB_ARGS_NONE());
+  mrb_define_method(mrb, gsl, "ncols", mrb_matrix_ncols, MRB_ARGS_NONE());
   mrb_define_method(mrb, gsl, "dup", mrb_matrix_dup, MRB_ARGS_NONE());
   mrb_define_method(mrb, gsl, "all", mrb_matrix_all, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, gsl, "zero", mrb_matrix_zero, MRB_ARGS_NONE());
   mrb_define_method(mrb, gsl, "identity", mrb_matrix_identity, MRB_ARGS_NONE());
-  mrb_define_method(mrb, gsl, "rnd_fill", mrb_matrix_rnd_fill, MRB_ARGS_NONE());
+  mrb_define_method(mrb, gsl, "rnd_fill", mrb_matrix_rnd_fill, MRB_ARGS_OPT(1));
   mrb_define_method(mrb, gsl, "===", mrb_matrix_equal, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, gsl, "[]", mrb_matrix_get_ij, MRB_ARGS_OPT(2));
   mrb_define_method(mrb, gsl, "row", mrb_matrix_get_row, MRB_ARGS_REQ(1));
@@ -525,11 +1349,19 @@ void mrb_gsl_matrix_init(mrb_state *mrb) {
   mrb_define_method(mrb, gsl, "get_col", mrb_matrix_get_col, MRB_ARGS_OPT(1));
   mrb_define_method(mrb, gsl, "set_row", mrb_matrix_set_row, MRB_ARGS_REQ(2));
   mrb_define_method(mrb, gsl, "set_col", mrb_matrix_set_col, MRB_ARGS_REQ(2));
-
-  mrb_define_method(mrb, gsl, "max", mrb_matrix_max, MRB_ARGS_NONE());
+  mrb_define_method(mrb, gsl, "row_view", mrb_matrix_row_view,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "col_view", mrb_matrix_col_view,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "diagonal", mrb_matrix_diagonal,
+                    MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, gsl, "submatrix", mrb_matrix_submatrix,
+                    MRB_ARGS_REQ(4));
+
+  mrb_define_method(mrb, gsl, "max", mrb_matrix_max, MRB_ARGS_OPT(1));
   mrb_define_method(mrb, gsl, "max_index", mrb_matrix_max_index,
                     MRB_ARGS_NONE());
-  mrb_define_method(mrb, gsl, "min", mrb_matrix_min, MRB_ARGS_NONE());
+  mrb_define_method(mrb, gsl, "min", mrb_matrix_min, MRB_ARGS_OPT(1));
   mrb_define_method(mrb, gsl, "min_index", mrb_matrix_min_index,
                     MRB_ARGS_NONE());
 
@@ -537,11 +1369,49 @@ void mrb_gsl_matrix_init(mrb_state *mrb) {
   mrb_define_method(mrb, gsl, "sub!", mrb_matrix_sub, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, gsl, "mul!", mrb_matrix_mul, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, gsl, "div!", mrb_matrix_div, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "+", mrb_matrix_plus, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "-", mrb_matrix_minus, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "*", mrb_matrix_times, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "/", mrb_matrix_over, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "add_into", mrb_matrix_add_into,
+                    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, gsl, "sub_into", mrb_matrix_sub_into,
+                    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, gsl, "mul_into", mrb_matrix_mul_into,
+                    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, gsl, "div_into", mrb_matrix_div_into,
+                    MRB_ARGS_REQ(2));
   mrb_define_method(mrb, gsl, "^", mrb_matrix_prod, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "mmul_into", mrb_matrix_mmul_into,
+                    MRB_ARGS_REQ(2));
   mrb_define_method(mrb, gsl, "t!", mrb_matrix_transpose_self, MRB_ARGS_NONE());
   mrb_define_method(mrb, gsl, "t", mrb_matrix_transpose, MRB_ARGS_NONE());
+  mrb_define_method(mrb, gsl, "transpose_into", mrb_matrix_transpose_into,
+                    MRB_ARGS_REQ(1));
   mrb_define_method(mrb, gsl, "swap_rows", mrb_matrix_swap_rows,
                     MRB_ARGS_REQ(2));
   mrb_define_method(mrb, gsl, "swap_cols", mrb_matrix_swap_cols,
                     MRB_ARGS_REQ(2));
+
+  mrb_define_method(mrb, gsl, "sum", mrb_matrix_sum, MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, gsl, "mean", mrb_matrix_mean, MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, gsl, "variance", mrb_matrix_variance,
+                    MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, gsl, "norm", mrb_matrix_norm, MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, gsl, "argmax", mrb_matrix_argmax, MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, gsl, "argmin", mrb_matrix_argmin, MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, gsl, "each", mrb_matrix_each, MRB_ARGS_BLOCK());
+  mrb_define_method(mrb, gsl, "each_with_indexes",
+                    mrb_matrix_each_with_indexes, MRB_ARGS_BLOCK());
+  mrb_define_method(mrb, gsl, "map!", mrb_matrix_map_bang, MRB_ARGS_BLOCK());
+  mrb_define_method(mrb, gsl, "each_row", mrb_matrix_each_row,
+                    MRB_ARGS_BLOCK());
+  mrb_define_method(mrb, gsl, "each_col", mrb_matrix_each_col,
+                    MRB_ARGS_BLOCK());
+
+  // Views alias the storage of a parent Matrix
+  mrb_gsl_matrix_view_class =
+      mrb_define_class(mrb, "MatrixView", mrb_gsl_matrix_class);
+  MRB_SET_INSTANCE_TT(mrb_gsl_matrix_view_class, MRB_TT_DATA);
+  mrb_undef_class_method(mrb, mrb_gsl_matrix_view_class, "new");
 }
@@ -43,6 +43,10 @@
 
 #define E_MATRIX_ERROR (mrb_class_get(mrb, "MatrixError"))
 
+// Matrix and MatrixView classes, cached at gem init
+extern struct RClass *mrb_gsl_matrix_class;
+extern struct RClass *mrb_gsl_matrix_view_class;
+
 /***********************************************\
  MATRICES
 \***********************************************/
@@ -52,9 +56,18 @@
 // Check it with GC.start
 void matrix_destructor(mrb_state *mrb, void *p_);
 
-// Utility function for getting the struct out of the wrapping IV @data
+// Utility function for getting the struct out of self (an MRB_TT_DATA object)
 void mrb_matrix_get_data(mrb_state *mrb, mrb_value self, gsl_matrix **data);
 
+// Fast allocation of a new n x m Matrix, bypassing #initialize.
+// Content is NOT zeroed: the caller must fill it up.
+mrb_value mrb_gsl_matrix_new_uninit(mrb_state *mrb, mrb_int n, mrb_int m);
+
+// Wrap a gsl_matrix_view into a new MatrixView, aliasing the storage of
+// parent. The parent object is kept alive for as long as the view is.
+mrb_value mrb_gsl_matrix_view_new(mrb_state *mrb, mrb_value parent,
+                                  gsl_matrix_view view);
+
 void mrb_gsl_matrix_init(mrb_state *mrb);
 
 #endif // MATRIX_H
\ No newline at end of file
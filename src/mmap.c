@@ -0,0 +1,451 @@
+/***************************************************************************/
+/*                                                                         */
+/* mmap.c - Vectors and Matrices backed by memory-mapped files             */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "matrix.h"
+#include "vector.h"
+#include "mmap.h"
+
+// the data block must stay 8-byte aligned after the header
+typedef char map_header_size_check[sizeof(mrb_gsl_map_header_s) == 64 ? 1
+                                                                      : -1];
+
+#pragma mark -
+#pragma mark • Utilities
+
+static void mapping_destructor(mrb_state *mrb, void *p_) {
+  mrb_gsl_mapping_s *map = (mrb_gsl_mapping_s *)p_;
+  if (!map)
+    return;
+  munmap(map->addr, map->len);
+  free(map);
+}
+
+static const struct mrb_data_type mapping_data_type = {"mapping_data",
+                                                       mapping_destructor};
+
+static struct RClass *mrb_gsl_mapping_class = NULL;
+
+static mrb_gsl_mapping_s *mapping_get_data(mrb_state *mrb, mrb_value self) {
+  mrb_gsl_mapping_s *map =
+      (mrb_gsl_mapping_s *)mrb_data_get_ptr(mrb, self, &mapping_data_type);
+  if (!map)
+    mrb_raise(mrb, E_MMAP_ERROR, "Not a mapped object");
+  return map;
+}
+
+// Closes fd and raises
+static void map_fail(mrb_state *mrb, int fd, const char *msg) {
+  close(fd);
+  mrb_raise(mrb, E_MMAP_ERROR, msg);
+}
+
+// Why size1 x size2 can't be created, or NULL if it can
+static const char *map_sizes_error(mrb_int size1, mrb_int size2) {
+  if (size1 <= 0 || size2 <= 0)
+    return "Need positive sizes";
+  if ((uint64_t)size2 > (SIZE_MAX - sizeof(mrb_gsl_map_header_s)) /
+                            sizeof(double) / (uint64_t)size1)
+    return "Sizes are too large";
+  return NULL;
+}
+
+// Sizes are checked before the file is opened, since "w" truncates it
+static void map_check_sizes(mrb_state *mrb, mrb_gsl_map_mode mode,
+                            mrb_int size1, mrb_int size2) {
+  const char *msg;
+  if (mode == MRB_GSL_MAP_CREATE && (msg = map_sizes_error(size1, size2)))
+    mrb_raise(mrb, E_MMAP_ERROR, msg);
+}
+
+// The GSL::Mapping that owns a region, still empty
+static struct RData *mapping_owner_new(mrb_state *mrb) {
+  return mrb_data_object_alloc(mrb, mrb_gsl_mapping_class, NULL,
+                               &mapping_data_type);
+}
+
+// Body of mrb_gsl_map_fd, with an owner allocated by the caller before fd
+// was opened: nothing here allocates before the region is attached to it
+// or fd is closed
+static mrb_value map_fd(mrb_state *mrb, struct RData *owner, int fd,
+                        mrb_gsl_map_mode mode, uint32_t kind, mrb_int size1,
+                        mrb_int size2) {
+  mrb_gsl_mapping_s *map = NULL;
+  mrb_gsl_map_header_s *hdr = NULL;
+  mrb_value parent = mrb_obj_value(owner);
+  struct stat st;
+  const char *msg;
+  size_t len;
+  void *addr;
+  double *data;
+
+  if (mode == MRB_GSL_MAP_CREATE) {
+    if ((msg = map_sizes_error(size1, size2)))
+      map_fail(mrb, fd, msg);
+    len = sizeof(mrb_gsl_map_header_s) + size1 * size2 * sizeof(double);
+    if (ftruncate(fd, len))
+      map_fail(mrb, fd, "Could not resize the file");
+  } else {
+    if (fstat(fd, &st))
+      map_fail(mrb, fd, "Could not stat the file");
+    len = st.st_size;
+    if (len < sizeof(mrb_gsl_map_header_s))
+      map_fail(mrb, fd, "File is too short");
+  }
+
+  map = (mrb_gsl_mapping_s *)malloc(sizeof(mrb_gsl_mapping_s));
+  if (!map)
+    map_fail(mrb, fd, "Could not allocate mapping data");
+  addr = mmap(NULL, len, PROT_READ | PROT_WRITE,
+              mode == MRB_GSL_MAP_READ ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    free(map);
+    map_fail(mrb, fd, "Could not map the file");
+  }
+  close(fd);
+  map->addr = addr;
+  map->len = len;
+  map->shared = (mode != MRB_GSL_MAP_READ);
+  owner->data = map;
+
+  hdr = (mrb_gsl_map_header_s *)addr;
+  if (mode == MRB_GSL_MAP_CREATE) {
+    memset(hdr, 0, sizeof(mrb_gsl_map_header_s));
+    memcpy(hdr->magic, MRB_GSL_MAP_MAGIC, sizeof(MRB_GSL_MAP_MAGIC));
+    hdr->version = MRB_GSL_MAP_VERSION;
+    hdr->dtype = MRB_GSL_MAP_F64;
+    hdr->kind = kind;
+    hdr->size1 = size1;
+    hdr->size2 = size2;
+  } else {
+    if (memcmp(hdr->magic, MRB_GSL_MAP_MAGIC, sizeof(MRB_GSL_MAP_MAGIC)) ||
+        hdr->version != MRB_GSL_MAP_VERSION ||
+        hdr->dtype != MRB_GSL_MAP_F64) {
+      mrb_raise(mrb, E_MMAP_ERROR, "Not a mapped Vector or Matrix file");
+    }
+    if (hdr->kind != kind) {
+      mrb_raise(mrb, E_MMAP_ERROR, kind == MRB_GSL_MAP_VECTOR
+                                       ? "File does not contain a Vector"
+                                       : "File does not contain a Matrix");
+    }
+    // each factor is bounded before multiplying, so that a corrupt header
+    // can't overflow the size check
+    if (hdr->size1 == 0 || hdr->size2 == 0 || hdr->size1 > SIZE_MAX ||
+        hdr->size2 > SIZE_MAX ||
+        hdr->size2 > (len - sizeof(mrb_gsl_map_header_s)) / sizeof(double) /
+                         hdr->size1) {
+      mrb_raise(mrb, E_MMAP_ERROR, "File is too short");
+    }
+    if ((size1 > 0 && hdr->size1 != (uint64_t)size1) ||
+        (size2 > 0 && hdr->size2 != (uint64_t)size2)) {
+      mrb_raise(mrb, E_MMAP_ERROR, "Sizes don't match the file header");
+    }
+  }
+
+  data = (double *)(hdr + 1);
+  if (kind == MRB_GSL_MAP_VECTOR) {
+    return mrb_gsl_vector_view_new(mrb, parent,
+                                   gsl_vector_view_array(data, hdr->size1));
+  }
+  return mrb_gsl_matrix_view_new(
+      mrb, parent, gsl_matrix_view_array(data, hdr->size1, hdr->size2));
+}
+
+mrb_value mrb_gsl_map_fd(mrb_state *mrb, int fd, mrb_gsl_map_mode mode,
+                         uint32_t kind, mrb_int size1, mrb_int size2) {
+  return map_fd(mrb, mapping_owner_new(mrb), fd, mode, kind, size1, size2);
+}
+
+mrb_gsl_map_header_s *mrb_gsl_map_header(mrb_state *mrb, mrb_value obj) {
+  // views of mapped objects are mapped too
+  while (!mrb_nil_p(obj) &&
+         !mrb_obj_is_kind_of(mrb, obj, mrb_gsl_mapping_class)) {
+    obj = mrb_iv_get(mrb, obj, mrb_intern_lit(mrb, "@parent"));
+  }
+  if (mrb_nil_p(obj)) {
+    mrb_raise(mrb, E_MMAP_ERROR, "Not a mapped object");
+  }
+  return (mrb_gsl_map_header_s *)mapping_get_data(mrb, obj)->addr;
+}
+
+// Arguments are (path, [size1, [size2,]] [mode]), mode being "r" (default),
+// "r+" or "w"; nsizes is the number of sizes for the class
+static void mmap_args(mrb_state *mrb, int nsizes, char **path,
+                      mrb_int *sizes, mrb_gsl_map_mode *mode) {
+  mrb_value *argv;
+  mrb_int argc, i;
+  const char *m = "r";
+
+  mrb_get_args(mrb, "z*", path, &argv, &argc);
+  for (i = 0; i < nsizes; i++)
+    sizes[i] = 0;
+  if ((argc == nsizes || argc == nsizes + 1) && !mrb_string_p(argv[0])) {
+    for (i = 0; i < nsizes; i++)
+      sizes[i] = mrb_fixnum(mrb_to_int(mrb, argv[i]));
+    argv += nsizes;
+    argc -= nsizes;
+  }
+  if (argc == 1) {
+    m = mrb_string_value_cstr(mrb, &argv[0]);
+  } else if (argc != 0) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Wrong number of arguments");
+  }
+  if (!strcmp(m, "r")) {
+    *mode = MRB_GSL_MAP_READ;
+  } else if (!strcmp(m, "r+")) {
+    *mode = MRB_GSL_MAP_UPDATE;
+  } else if (!strcmp(m, "w")) {
+    *mode = MRB_GSL_MAP_CREATE;
+  } else {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Mode must be \"r\", \"r+\" or \"w\"");
+  }
+}
+
+static int mmap_open(mrb_state *mrb, const char *path,
+                     mrb_gsl_map_mode mode) {
+  int fd;
+  if (mode == MRB_GSL_MAP_CREATE)
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+  else
+    fd = open(path, mode == MRB_GSL_MAP_READ ? O_RDONLY : O_RDWR);
+  if (fd < 0)
+    mrb_sys_fail(mrb, path);
+  return fd;
+}
+
+#pragma mark -
+#pragma mark • Constructors
+
+// Vector.mmap(path, [n,] mode = "r")
+static mrb_value mrb_vector_s_mmap(mrb_state *mrb, mrb_value klass) {
+  char *path;
+  mrb_int n;
+  mrb_gsl_map_mode mode;
+  struct RData *owner;
+
+  mmap_args(mrb, 1, &path, &n, &mode);
+  map_check_sizes(mrb, mode, n, 1);
+  owner = mapping_owner_new(mrb);
+  return map_fd(mrb, owner, mmap_open(mrb, path, mode), mode,
+                MRB_GSL_MAP_VECTOR, n, n > 0 ? 1 : 0);
+}
+
+// Matrix.mmap(path, [rows, cols,] mode = "r")
+static mrb_value mrb_matrix_s_mmap(mrb_state *mrb, mrb_value klass) {
+  char *path;
+  mrb_int sizes[2];
+  mrb_gsl_map_mode mode;
+  struct RData *owner;
+
+  mmap_args(mrb, 2, &path, sizes, &mode);
+  map_check_sizes(mrb, mode, sizes[0], sizes[1]);
+  owner = mapping_owner_new(mrb);
+  return map_fd(mrb, owner, mmap_open(mrb, path, mode), mode,
+                MRB_GSL_MAP_MATRIX, sizes[0], sizes[1]);
+}
+
+// Vector.shm(name, [n]) and Matrix.shm(name, [rows, cols]): POSIX shared
+// memory object, created with its header if it does not exist yet;
+// otherwise its header is checked as for mmap
+static mrb_value shm_map(mrb_state *mrb, uint32_t kind, int nsizes) {
+  char *name;
+  mrb_value *argv;
+  mrb_int argc, sizes[2] = {0, 0}, i;
+  mrb_gsl_map_mode mode = MRB_GSL_MAP_CREATE;
+  struct RData *owner;
+  int fd;
+
+  mrb_get_args(mrb, "z*", &name, &argv, &argc);
+  if (argc != 0 && argc != nsizes) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Wrong number of arguments");
+  }
+  for (i = 0; i < argc; i++) {
+    sizes[i] = mrb_fixnum(mrb_to_int(mrb, argv[i]));
+  }
+  if (nsizes == 1 && argc == 1)
+    sizes[1] = 1;
+  if (argc)
+    map_check_sizes(mrb, MRB_GSL_MAP_CREATE, sizes[0], sizes[1]);
+  owner = mapping_owner_new(mrb);
+  fd = argc ? shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0666) : -1;
+  if (fd < 0) {
+    // it already exists (or no size was given): attach to it
+    mode = MRB_GSL_MAP_UPDATE;
+    fd = shm_open(name, O_RDWR, 0666);
+  }
+  if (fd < 0)
+    mrb_sys_fail(mrb, name);
+  return map_fd(mrb, owner, fd, mode, kind, sizes[0], sizes[1]);
+}
+
+static mrb_value mrb_vector_s_shm(mrb_state *mrb, mrb_value klass) {
+  return shm_map(mrb, MRB_GSL_MAP_VECTOR, 1);
+}
+
+static mrb_value mrb_matrix_s_shm(mrb_state *mrb, mrb_value klass) {
+  return shm_map(mrb, MRB_GSL_MAP_MATRIX, 2);
+}
+
+// GSL.shm_unlink(name): removes the name; the memory is released when the
+// last process unmaps it
+static mrb_value mrb_gsl_s_shm_unlink(mrb_state *mrb, mrb_value self) {
+  char *name;
+  mrb_get_args(mrb, "z", &name);
+  if (shm_unlink(name))
+    mrb_sys_fail(mrb, name);
+  return mrb_nil_value();
+}
+
+#pragma mark -
+#pragma mark • Seqlock
+
+// The seq field of the header is a sequence lock: it is odd while a writer
+// is publishing. Readers never block the writer: they retry when seq was
+// odd or changed while they were reading.
+
+static mrb_value publish_body(mrb_state *mrb, mrb_value args) {
+  return mrb_yield(mrb, mrb_ary_entry(args, 0), mrb_ary_entry(args, 1));
+}
+
+static mrb_value publish_ensure(mrb_state *mrb, mrb_value self) {
+  mrb_gsl_map_header_s *hdr = mrb_gsl_map_header(mrb, self);
+  __atomic_store_n(&hdr->seq, hdr->seq + 1, __ATOMIC_RELEASE);
+  return mrb_nil_value();
+}
+
+// publish! { |obj| ... } writes into obj in the block; readers see either
+// the data before or after it, never a mix. Single writer only.
+static mrb_value mrb_gsl_publish(mrb_state *mrb, mrb_value self) {
+  mrb_value blk;
+  mrb_gsl_map_header_s *hdr;
+
+  mrb_get_args(mrb, "&", &blk);
+  if (mrb_nil_p(blk)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a block");
+  }
+  hdr = mrb_gsl_map_header(mrb, self);
+  __atomic_store_n(&hdr->seq, hdr->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  mrb_ensure(mrb, publish_body, mrb_assoc_new(mrb, blk, self),
+             publish_ensure, self);
+  return self;
+}
+
+// read_consistent(max_tries = 1000) { |obj| ... } runs the block until it
+// completes with no publish! in between, and returns its value. The block
+// may then run more than once, and must only read from obj.
+static mrb_value mrb_gsl_read_consistent(mrb_state *mrb, mrb_value self) {
+  mrb_value blk, result;
+  mrb_int max_tries = 1000, i;
+  mrb_gsl_map_header_s *hdr;
+  uint64_t s1, s2;
+
+  mrb_get_args(mrb, "|i&", &max_tries, &blk);
+  if (mrb_nil_p(blk)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a block");
+  }
+  hdr = mrb_gsl_map_header(mrb, self);
+  for (i = 0; i < max_tries; i++) {
+    s1 = __atomic_load_n(&hdr->seq, __ATOMIC_ACQUIRE);
+    if (s1 & 1) {
+      sched_yield();
+      continue;
+    }
+    result = mrb_yield(mrb, blk, self);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    s2 = __atomic_load_n(&hdr->seq, __ATOMIC_RELAXED);
+    if (s1 == s2)
+      return result;
+  }
+  mrb_raise(mrb, E_MMAP_ERROR, "Could not read a consistent snapshot");
+}
+
+// Number of completed publish! calls
+static mrb_value mrb_gsl_seq(mrb_state *mrb, mrb_value self) {
+  mrb_gsl_map_header_s *hdr = mrb_gsl_map_header(mrb, self);
+  return mrb_fixnum_value(__atomic_load_n(&hdr->seq, __ATOMIC_ACQUIRE) / 2);
+}
+
+#pragma mark -
+#pragma mark • Mapping
+
+// Flushes the changes of a shared mapping to its file
+static mrb_value mrb_mapping_sync(mrb_state *mrb, mrb_value self) {
+  mrb_gsl_mapping_s *map = mapping_get_data(mrb, self);
+  if (map->shared && msync(map->addr, map->len, MS_SYNC))
+    mrb_sys_fail(mrb, "msync");
+  return self;
+}
+
+static mrb_value mrb_mapping_shared(mrb_state *mrb, mrb_value self) {
+  return mrb_bool_value(mapping_get_data(mrb, self)->shared);
+}
+
+// Mapped bytes, header included
+static mrb_value mrb_mapping_length(mrb_state *mrb, mrb_value self) {
+  return mrb_fixnum_value(mapping_get_data(mrb, self)->len);
+}
+
+#pragma mark -
+#pragma mark • Gem setup
+
+void mrb_gsl_mmap_init(mrb_state *mrb) {
+  struct RClass *gsl = mrb_module_get(mrb, "GSL");
+
+  mrb_load_string(mrb, "class MmapError < Exception; end");
+
+  mrb_gsl_mapping_class =
+      mrb_define_class_under(mrb, gsl, "Mapping", mrb->object_class);
+  MRB_SET_INSTANCE_TT(mrb_gsl_mapping_class, MRB_TT_DATA);
+  mrb_undef_class_method(mrb, mrb_gsl_mapping_class, "new");
+  mrb_define_method(mrb, mrb_gsl_mapping_class, "sync", mrb_mapping_sync,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_gsl_mapping_class, "shared?", mrb_mapping_shared,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_gsl_mapping_class, "length", mrb_mapping_length,
+                    MRB_ARGS_NONE());
+
+  mrb_define_class_method(mrb, gsl, "shm_unlink", mrb_gsl_s_shm_unlink,
+                          MRB_ARGS_REQ(1));
+
+  mrb_define_class_method(mrb, mrb_gsl_vector_class, "shm", mrb_vector_s_shm,
+                          MRB_ARGS_ARG(1, 1));
+  mrb_define_class_method(mrb, mrb_gsl_matrix_class, "shm", mrb_matrix_s_shm,
+                          MRB_ARGS_ARG(1, 2));
+  mrb_define_method(mrb, mrb_gsl_vector_class, "publish!", mrb_gsl_publish,
+                    MRB_ARGS_BLOCK());
+  mrb_define_method(mrb, mrb_gsl_matrix_class, "publish!", mrb_gsl_publish,
+                    MRB_ARGS_BLOCK());
+  mrb_define_method(mrb, mrb_gsl_vector_class, "read_consistent",
+                    mrb_gsl_read_consistent, MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, mrb_gsl_matrix_class, "read_consistent",
+                    mrb_gsl_read_consistent, MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, mrb_gsl_vector_class, "seq", mrb_gsl_seq,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, mrb_gsl_matrix_class, "seq", mrb_gsl_seq,
+                    MRB_ARGS_NONE());
+
+  mrb_define_class_method(mrb, mrb_gsl_vector_class, "mmap",
+                          mrb_vector_s_mmap, MRB_ARGS_ARG(1, 2));
+  mrb_define_class_method(mrb, mrb_gsl_matrix_class, "mmap",
+                          mrb_matrix_s_mmap, MRB_ARGS_ARG(1, 3));
+}
@@ -0,0 +1,86 @@
+/***************************************************************************/
+/*                                                                         */
+/* mmap.h - Vectors and Matrices backed by memory-mapped files             */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef MMAP_H
+#define MMAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "mruby.h"
+#include "mruby/data.h"
+
+#define E_MMAP_ERROR (mrb_class_get(mrb, "MmapError"))
+
+/***********************************************\
+ Mapped files
+\***********************************************/
+
+#define MRB_GSL_MAP_MAGIC "GSLMMAP"
+#define MRB_GSL_MAP_VERSION 1
+#define MRB_GSL_MAP_F64 1
+#define MRB_GSL_MAP_VECTOR 1
+#define MRB_GSL_MAP_MATRIX 2
+
+// 64 bytes header at the beginning of a mapped file, in host byte order,
+// followed by the size1 * size2 row-major doubles
+typedef struct {
+  char magic[8];     // MRB_GSL_MAP_MAGIC
+  uint32_t version;  // MRB_GSL_MAP_VERSION
+  uint32_t dtype;    // MRB_GSL_MAP_F64
+  uint32_t kind;     // MRB_GSL_MAP_VECTOR or MRB_GSL_MAP_MATRIX
+  uint32_t reserved;
+  uint64_t size1;    // length, or rows
+  uint64_t size2;    // 1, or columns
+  uint64_t seq;      // sequence counter for concurrent writers
+  uint8_t pad[16];
+} mrb_gsl_map_header_s;
+
+// The mapped region, owned by a GSL::Mapping object: it is unmapped when
+// the object is garbage collected
+typedef struct {
+  void *addr;
+  size_t len;
+  mrb_bool shared;
+} mrb_gsl_mapping_s;
+
+// How a mapping is opened
+typedef enum {
+  MRB_GSL_MAP_READ,   // private, copy-on-write: writes stay in this process
+  MRB_GSL_MAP_UPDATE, // shared: writes go to the file
+  MRB_GSL_MAP_CREATE  // shared, and the header is written
+} mrb_gsl_map_mode;
+
+// Maps the whole file fd and returns a VectorView or a MatrixView (as for
+// kind) over its data, whose parent is the GSL::Mapping. With
+// MRB_GSL_MAP_CREATE the file is resized and its header written; otherwise
+// the header is checked, and so are size1 and size2 unless they are 0.
+// The function takes ownership of fd, which is always closed, unless
+// allocating the GSL::Mapping raises: the constructors in mmap.c allocate
+// it before opening the file.
+mrb_value mrb_gsl_map_fd(mrb_state *mrb, int fd, mrb_gsl_map_mode mode,
+                         uint32_t kind, mrb_int size1, mrb_int size2);
+
+// Header of a mapped Vector or Matrix, of a view of it, or of its
+// GSL::Mapping; raises if obj is not mapped
+mrb_gsl_map_header_s *mrb_gsl_map_header(mrb_state *mrb, mrb_value obj);
+
+void mrb_gsl_mmap_init(mrb_state *mrb);
+
+#endif // MMAP_H
@@ -0,0 +1,388 @@
+/***************************************************************************/
+/*                                                                         */
+/* movstat.c - Moving window statistics for mruby                          */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#include <string.h>
+#include "mruby/hash.h"
+#include "vector.h"
+#include "buffer.h"
+#include "movstat.h"
+
+#pragma mark -
+#pragma mark • Utilities
+
+enum {
+  MOV_MEAN,
+  MOV_MEDIAN,
+  MOV_MIN,
+  MOV_MAX,
+  MOV_MINMAX,
+  MOV_SUM,
+  MOV_SD,
+  MOV_VARIANCE,
+  MOV_MAD,
+  MOV_NSTATS
+};
+
+static const char *mov_names[MOV_NSTATS] = {
+    "mean", "median", "min", "max", "minmax", "sum", "sd", "variance", "mad"};
+
+// Scale factor of the MAD, so that it estimates the standard deviation of
+// normal data (the same as gsl_movstat_mad)
+static double mad_scale = 1.482602218505602;
+
+static const gsl_movstat_accum *mov_accum(int stat) {
+  switch (stat) {
+  case MOV_MEAN:
+    return gsl_movstat_accum_mean;
+  case MOV_MEDIAN:
+    return gsl_movstat_accum_median;
+  case MOV_MIN:
+    return gsl_movstat_accum_min;
+  case MOV_MAX:
+    return gsl_movstat_accum_max;
+  case MOV_MINMAX:
+    return gsl_movstat_accum_minmax;
+  case MOV_SUM:
+    return gsl_movstat_accum_sum;
+  case MOV_SD:
+    return gsl_movstat_accum_sd;
+  case MOV_VARIANCE:
+    return gsl_movstat_accum_variance;
+  default:
+    return gsl_movstat_accum_mad;
+  }
+}
+
+// Garbage collector handler
+void moving_window_destructor(mrb_state *mrb, void *p_) {
+  moving_window_s *mw = (moving_window_s *)p_;
+  if (!mw)
+    return;
+  if (mw->ws)
+    gsl_movstat_free(mw->ws);
+  free(mw->state);
+  free(mw);
+};
+
+// Creating data type and reference for GC, in a const struct
+const struct mrb_data_type moving_window_data_type = {
+    "moving_window_data", moving_window_destructor};
+
+static struct RClass *moving_window_class = NULL;
+
+// Utility function for getting the struct out of self
+static moving_window_s *mrb_moving_window_get_data(mrb_state *mrb,
+                                                   mrb_value self) {
+  moving_window_s *mw = (moving_window_s *)mrb_data_get_ptr(
+      mrb, self, &moving_window_data_type);
+  if (!mw)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access window data");
+  return mw;
+}
+
+// Option from a trailing Hash
+static mrb_value mov_opt(mrb_state *mrb, mrb_value opts, const char *key) {
+  if (!mrb_hash_p(opts))
+    return mrb_nil_value();
+  return mrb_hash_get(mrb, opts, mrb_symbol_value(mrb_intern_cstr(mrb, key)));
+}
+
+// ends: :pad_value (default, repeats the first and last samples),
+// :pad_zero or :truncate (shorter windows at the ends)
+static gsl_movstat_end_t mov_ends(mrb_state *mrb, mrb_value opts) {
+  mrb_value v = mov_opt(mrb, opts, "ends");
+  if (mrb_nil_p(v) || (mrb_symbol_p(v) &&
+                        mrb_symbol(v) == mrb_intern_lit(mrb, "pad_value")))
+    return GSL_MOVSTAT_END_PADVALUE;
+  if (mrb_symbol_p(v) && mrb_symbol(v) == mrb_intern_lit(mrb, "pad_zero"))
+    return GSL_MOVSTAT_END_PADZERO;
+  if (mrb_symbol_p(v) && mrb_symbol(v) == mrb_intern_lit(mrb, "truncate"))
+    return GSL_MOVSTAT_END_TRUNCATE;
+  mrb_raise(mrb, E_ARGUMENT_ERROR,
+            "ends must be :pad_value, :pad_zero or :truncate");
+}
+
+#pragma mark -
+#pragma mark • Initializations
+
+// MovingWindow.new(k, stat: :median). The stat is only needed for push
+static mrb_value mrb_moving_window_initialize(mrb_state *mrb,
+                                              mrb_value self) {
+  mrb_value opts = mrb_nil_value(), stat;
+  moving_window_s *mw;
+  mrb_int k;
+  int i, s = -1;
+
+  mrb_get_args(mrb, "i|H", &k, &opts);
+  if (k <= 0) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Window size must be positive");
+  }
+  stat = mov_opt(mrb, opts, "stat");
+  if (!mrb_nil_p(stat)) {
+    for (i = 0; i < MOV_NSTATS; i++) {
+      if (mrb_symbol_p(stat) &&
+          mrb_symbol(stat) == mrb_intern_cstr(mrb, mov_names[i]))
+        s = i;
+    }
+    if (s < 0) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Unknown stat");
+    }
+  }
+
+  mw = (moving_window_s *)DATA_PTR(self);
+  if (mw) {
+    moving_window_destructor(mrb, mw);
+  }
+  mrb_data_init(self, NULL, &moving_window_data_type);
+  // self is only set once the window is complete, so that a failed
+  // allocation can't leave it half built
+  mw = (moving_window_s *)calloc(1, sizeof(moving_window_s));
+  if (!mw)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate window data");
+  mw->k = k;
+  mw->stat = s;
+  mw->ws = gsl_movstat_alloc(k);
+  if (mw->ws && s >= 0)
+    mw->state = malloc(mov_accum(s)->size(k));
+  if (!mw->ws || (s >= 0 && !mw->state)) {
+    moving_window_destructor(mrb, mw);
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate window data");
+  }
+  if (s >= 0) {
+    mw->acc = mov_accum(s);
+    mw->acc->init(k, mw->state);
+  }
+  mrb_data_init(self, mw, &moving_window_data_type);
+  return mrb_nil_value();
+}
+
+static mrb_value mrb_moving_window_size(mrb_state *mrb, mrb_value self) {
+  return mrb_fixnum_value(mrb_moving_window_get_data(mrb, self)->k);
+}
+
+// Number of samples pushed, up to the window size
+static mrb_value mrb_moving_window_count(mrb_state *mrb, mrb_value self) {
+  return mrb_fixnum_value(mrb_moving_window_get_data(mrb, self)->count);
+}
+
+#pragma mark -
+#pragma mark • Streaming
+
+// Adds a sample, dropping the oldest one when the window is full, and
+// returns the statistic over the window: O(1) for mean, sum, sd,
+// variance, min and max, O(log k) for median and mad. minmax returns
+// [min, max]
+static mrb_value mrb_moving_window_push(mrb_state *mrb, mrb_value self) {
+  moving_window_s *mw = mrb_moving_window_get_data(mrb, self);
+  mrb_value x, res;
+  double result[2];
+
+  mrb_get_args(mrb, "o", &x);
+  if (!mw->acc) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR,
+              "Streaming needs a stat (MovingWindow.new(k, stat: ...))");
+  }
+  mw->acc->insert(mrb_gsl_to_f(mrb, x), mw->state);
+  if (mw->count < mw->k)
+    mw->count++;
+  mw->acc->get(mw->stat == MOV_MAD ? &mad_scale : NULL, result, mw->state);
+  switch (mw->stat) {
+  case MOV_MINMAX:
+    res = mrb_ary_new_capa(mrb, 2);
+    mrb_ary_push(mrb, res, mrb_float_value(mrb, result[0]));
+    mrb_ary_push(mrb, res, mrb_float_value(mrb, result[1]));
+    return res;
+  case MOV_MAD:
+    return mrb_float_value(mrb, result[1]);
+  default:
+    return mrb_float_value(mrb, result[0]);
+  }
+}
+
+static mrb_value mrb_moving_window_reset(mrb_state *mrb, mrb_value self) {
+  moving_window_s *mw = mrb_moving_window_get_data(mrb, self);
+  if (mw->acc)
+    mw->acc->init(mw->k, mw->state);
+  mw->count = 0;
+  return self;
+}
+
+#pragma mark -
+#pragma mark • Vector methods
+
+// Applies stat over a centered window to every sample of self (a Buffer is
+// taken from the oldest sample to the newest). The window is an Integer,
+// or a MovingWindow whose workspace is reused. The window of k samples
+// spans k/2 samples on each side, so that an even k is rounded up
+static mrb_value vector_moving(mrb_state *mrb, mrb_value self, int stat) {
+  mrb_value win, opts = mrb_nil_value(), res, res2 = mrb_nil_value();
+  gsl_movstat_workspace *ws;
+  gsl_movstat_end_t ends;
+  gsl_vector *p_vec, *p_res, *p_res2 = NULL, *p_tmp = NULL;
+  mrb_int k;
+  int status;
+
+  mrb_get_args(mrb, "o|H", &win, &opts);
+  ends = mov_ends(mrb, opts);
+  if (mrb_obj_is_kind_of(mrb, self, mrb_gsl_buffer_class))
+    self = mrb_funcall(mrb, self, "to_vector", 0);
+  mrb_vector_get_data(mrb, self, &p_vec);
+
+  res = mrb_gsl_vector_new_uninit(mrb, p_vec->size);
+  mrb_vector_get_data(mrb, res, &p_res);
+  if (stat == MOV_MINMAX) {
+    res2 = mrb_gsl_vector_new_uninit(mrb, p_vec->size);
+    mrb_vector_get_data(mrb, res2, &p_res2);
+  }
+  if (mrb_obj_is_kind_of(mrb, win, moving_window_class)) {
+    ws = mrb_moving_window_get_data(mrb, win)->ws;
+  } else {
+    k = mrb_fixnum(mrb_to_int(mrb, win));
+    if (k <= 0) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Window size must be positive");
+    }
+    ws = gsl_movstat_alloc(k);
+    if (!ws)
+      mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate window data");
+  }
+  if (stat == MOV_MAD) {
+    // the moving median, not returned
+    p_tmp = gsl_vector_alloc(p_vec->size);
+    if (!p_tmp) {
+      if (!mrb_obj_is_kind_of(mrb, win, moving_window_class))
+        gsl_movstat_free(ws);
+      mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate vector data");
+    }
+  }
+
+  switch (stat) {
+  case MOV_MEAN:
+    status = gsl_movstat_mean(ends, p_vec, p_res, ws);
+    break;
+  case MOV_MEDIAN:
+    status = gsl_movstat_median(ends, p_vec, p_res, ws);
+    break;
+  case MOV_MIN:
+    status = gsl_movstat_min(ends, p_vec, p_res, ws);
+    break;
+  case MOV_MAX:
+    status = gsl_movstat_max(ends, p_vec, p_res, ws);
+    break;
+  case MOV_MINMAX:
+    status = gsl_movstat_minmax(ends, p_vec, p_res, p_res2, ws);
+    break;
+  case MOV_SUM:
+    status = gsl_movstat_sum(ends, p_vec, p_res, ws);
+    break;
+  case MOV_SD:
+    status = gsl_movstat_sd(ends, p_vec, p_res, ws);
+    break;
+  case MOV_VARIANCE:
+    status = gsl_movstat_variance(ends, p_vec, p_res, ws);
+    break;
+  default:
+    status = gsl_movstat_mad(ends, p_vec, p_tmp, p_res, ws);
+    break;
+  }
+  if (p_tmp)
+    gsl_vector_free(p_tmp);
+  if (!mrb_obj_is_kind_of(mrb, win, moving_window_class))
+    gsl_movstat_free(ws);
+  if (status) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Moving window failed");
+  }
+  if (stat == MOV_MINMAX)
+    return mrb_assoc_new(mrb, res, res2);
+  return res;
+}
+
+static mrb_value mrb_vector_moving_mean(mrb_state *mrb, mrb_value self) {
+  return vector_moving(mrb, self, MOV_MEAN);
+}
+
+static mrb_value mrb_vector_moving_median(mrb_state *mrb, mrb_value self) {
+  return vector_moving(mrb, self, MOV_MEDIAN);
+}
+
+static mrb_value mrb_vector_moving_min(mrb_state *mrb, mrb_value self) {
+  return vector_moving(mrb, self, MOV_MIN);
+}
+
+static mrb_value mrb_vector_moving_max(mrb_state *mrb, mrb_value self) {
+  return vector_moving(mrb, self, MOV_MAX);
+}
+
+static mrb_value mrb_vector_moving_minmax(mrb_state *mrb, mrb_value self) {
+  return vector_moving(mrb, self, MOV_MINMAX);
+}
+
+static mrb_value mrb_vector_moving_sum(mrb_state *mrb, mrb_value self) {
+  return vector_moving(mrb, self, MOV_SUM);
+}
+
+static mrb_value mrb_vector_moving_sd(mrb_state *mrb, mrb_value self) {
+  return vector_moving(mrb, self, MOV_SD);
+}
+
+static mrb_value mrb_vector_moving_variance(mrb_state *mrb, mrb_value self) {
+  return vector_moving(mrb, self, MOV_VARIANCE);
+}
+
+static mrb_value mrb_vector_moving_mad(mrb_state *mrb, mrb_value self) {
+  return vector_moving(mrb, self, MOV_MAD);
+}
+
+#pragma mark -
+#pragma mark • Gem setup
+
+void mrb_gsl_movstat_init(mrb_state *mrb) {
+  struct RClass *mw, *vec = mrb_gsl_vector_class;
+
+  mw = mrb_define_class(mrb, "MovingWindow", mrb->object_class);
+  moving_window_class = mw;
+  MRB_SET_INSTANCE_TT(mw, MRB_TT_DATA);
+  mrb_define_method(mrb, mw, "initialize", mrb_moving_window_initialize,
+                    MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, mw, "size", mrb_moving_window_size, MRB_ARGS_NONE());
+  mrb_define_method(mrb, mw, "count", mrb_moving_window_count,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, mw, "push", mrb_moving_window_push, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mw, "<<", mrb_moving_window_push, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, mw, "reset", mrb_moving_window_reset,
+                    MRB_ARGS_NONE());
+
+  mrb_define_method(mrb, vec, "moving_mean", mrb_vector_moving_mean,
+                    MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, vec, "moving_median", mrb_vector_moving_median,
+                    MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, vec, "moving_min", mrb_vector_moving_min,
+                    MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, vec, "moving_max", mrb_vector_moving_max,
+                    MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, vec, "moving_minmax", mrb_vector_moving_minmax,
+                    MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, vec, "moving_sum", mrb_vector_moving_sum,
+                    MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, vec, "moving_sd", mrb_vector_moving_sd,
+                    MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, vec, "moving_variance", mrb_vector_moving_variance,
+                    MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, vec, "moving_mad", mrb_vector_moving_mad,
+                    MRB_ARGS_ARG(1, 1));
+}
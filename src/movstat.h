@@ -0,0 +1,53 @@
+/***************************************************************************/
+/*                                                                         */
+/* movstat.h - Moving window statistics for mruby                          */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef MOVSTAT_H
+#define MOVSTAT_H
+
+#include <gsl/gsl_movstat.h>
+
+#include "mruby.h"
+#include "mruby/data.h"
+#include "mruby/class.h"
+#include "mruby/value.h"
+
+/***********************************************\
+ MOVING WINDOWS
+\***********************************************/
+
+// A gsl_movstat workspace for a window of k samples, reused by the
+// Vector#moving_* methods, and optionally a streaming accumulator over the
+// last k samples
+typedef struct {
+  size_t k;
+  gsl_movstat_workspace *ws;
+  const gsl_movstat_accum *acc;
+  int stat;
+  void *state;
+  size_t count;
+} moving_window_s;
+
+// Garbage collector handler
+void moving_window_destructor(mrb_state *mrb, void *p_);
+
+// Adds MovingWindow and Vector#moving_*: it must be called after
+// mrb_gsl_vector_init and mrb_gsl_buffer_init
+void mrb_gsl_movstat_init(mrb_state *mrb);
+
+#endif // MOVSTAT_H
@@ -0,0 +1,373 @@
+/***************************************************************************/
+/*                                                                         */
+/* rng.c - Random number generators for mruby                              */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#include <string.h>
+#include <gsl/gsl_randist.h>
+#include "mruby/hash.h"
+#include "matrix.h"
+#include "vector.h"
+#include "rng.h"
+
+#pragma mark -
+#pragma mark • Utilities
+
+// Garbage collector handler
+void rng_destructor(mrb_state *mrb, void *p_) {
+  gsl_rng *r = (gsl_rng *)p_;
+  if (r)
+    gsl_rng_free(r);
+};
+
+// Creating data type and reference for GC, in a const struct
+const struct mrb_data_type rng_data_type = {"rng_data", rng_destructor};
+
+struct RClass *mrb_gsl_rng_class = NULL;
+
+// Utility function for getting the struct out of self
+static gsl_rng *mrb_rng_get_data(mrb_state *mrb, mrb_value self) {
+  gsl_rng *r = (gsl_rng *)mrb_data_get_ptr(mrb, self, &rng_data_type);
+  if (!r)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access generator data");
+  return r;
+}
+
+// RNG.default is created on first use, honoring the GSL_RNG_TYPE and
+// GSL_RNG_SEED environment variables, and kept in a class instance variable
+static mrb_value mrb_rng_s_default(mrb_state *mrb, mrb_value klass) {
+  mrb_sym sym = mrb_intern_lit(mrb, "@default");
+  mrb_value rng = mrb_iv_get(mrb, mrb_obj_value(mrb_gsl_rng_class), sym);
+  if (mrb_nil_p(rng)) {
+    rng = mrb_obj_new(mrb, mrb_gsl_rng_class, 0, NULL);
+    mrb_iv_set(mrb, mrb_obj_value(mrb_gsl_rng_class), sym, rng);
+  }
+  return rng;
+}
+
+gsl_rng *mrb_gsl_rng_get(mrb_state *mrb, mrb_value rng) {
+  if (mrb_nil_p(rng))
+    rng = mrb_rng_s_default(mrb, mrb_nil_value());
+  if (!mrb_obj_is_kind_of(mrb, rng, mrb_gsl_rng_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need an RNG");
+  }
+  return mrb_rng_get_data(mrb, rng);
+}
+
+// Generator type by name (a String or a Symbol), nil for gsl_rng_default
+static const gsl_rng_type *rng_type(mrb_state *mrb, mrb_value name) {
+  const gsl_rng_type **t;
+  const char *s;
+
+  if (mrb_nil_p(name))
+    return gsl_rng_default;
+  s = mrb_symbol_p(name) ? mrb_sym2name(mrb, mrb_symbol(name))
+                         : mrb_string_value_cstr(mrb, &name);
+  for (t = gsl_rng_types_setup(); *t; t++) {
+    if (!strcmp((*t)->name, s))
+      return *t;
+  }
+  mrb_raise(mrb, E_RNG_ERROR, "Unknown generator type (see RNG.types)");
+}
+
+#pragma mark -
+#pragma mark • Initializations
+
+// RNG.new(type: :mt19937, seed: 42), both optional. Without a seed the
+// generator starts from the GSL default one (GSL_RNG_SEED, or 0)
+static mrb_value mrb_rng_initialize(mrb_state *mrb, mrb_value self) {
+  mrb_value opts = mrb_nil_value(), type = mrb_nil_value(),
+            seed = mrb_nil_value();
+  gsl_rng *r;
+
+  mrb_get_args(mrb, "|H", &opts);
+  if (mrb_hash_p(opts)) {
+    type = mrb_hash_get(mrb, opts, mrb_symbol_value(mrb_intern_lit(mrb, "type")));
+    seed = mrb_hash_get(mrb, opts, mrb_symbol_value(mrb_intern_lit(mrb, "seed")));
+  }
+  r = (gsl_rng *)DATA_PTR(self);
+  if (r) {
+    rng_destructor(mrb, r);
+  }
+  mrb_data_init(self, NULL, &rng_data_type);
+  r = gsl_rng_alloc(rng_type(mrb, type));
+  if (!r)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate generator");
+  mrb_data_init(self, r, &rng_data_type);
+  if (!mrb_nil_p(seed))
+    gsl_rng_set(r, (unsigned long)mrb_fixnum(mrb_to_int(mrb, seed)));
+  return mrb_nil_value();
+}
+
+// Independent copy, continuing the same stream
+static mrb_value mrb_rng_dup(mrb_state *mrb, mrb_value self) {
+  struct RData *data;
+  gsl_rng *r = mrb_rng_get_data(mrb, self);
+
+  data = mrb_data_object_alloc(mrb, mrb_gsl_rng_class, NULL, &rng_data_type);
+  data->data = gsl_rng_clone(r);
+  if (!data->data)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate generator");
+  return mrb_obj_value(data);
+}
+
+static mrb_value mrb_rng_s_types(mrb_state *mrb, mrb_value klass) {
+  const gsl_rng_type **t;
+  mrb_value res = mrb_ary_new(mrb);
+  int ai = mrb_gc_arena_save(mrb);
+
+  for (t = gsl_rng_types_setup(); *t; t++) {
+    mrb_ary_push(mrb, res, mrb_str_new_cstr(mrb, (*t)->name));
+    mrb_gc_arena_restore(mrb, ai);
+  }
+  return res;
+}
+
+#pragma mark -
+#pragma mark • Accessors
+
+static mrb_value mrb_rng_name(mrb_state *mrb, mrb_value self) {
+  return mrb_str_new_cstr(mrb, gsl_rng_name(mrb_rng_get_data(mrb, self)));
+}
+
+// Restarts the stream from seed
+static mrb_value mrb_rng_set_seed(mrb_state *mrb, mrb_value self) {
+  mrb_int seed;
+  mrb_get_args(mrb, "i", &seed);
+  gsl_rng_set(mrb_rng_get_data(mrb, self), (unsigned long)seed);
+  return mrb_fixnum_value(seed);
+}
+
+// Raw integer in [min, max] of the generator
+static mrb_value mrb_rng_get(mrb_state *mrb, mrb_value self) {
+  return mrb_fixnum_value((mrb_int)gsl_rng_get(mrb_rng_get_data(mrb, self)));
+}
+
+// Single Float in [0, 1)
+static mrb_value mrb_rng_uniform(mrb_state *mrb, mrb_value self) {
+  return mrb_float_value(mrb, gsl_rng_uniform(mrb_rng_get_data(mrb, self)));
+}
+
+// The state is saved as the generator name, a NUL, and the raw state bytes,
+// so that it can only be restored into a generator of the same type
+static mrb_value mrb_rng_state(mrb_state *mrb, mrb_value self) {
+  gsl_rng *r = mrb_rng_get_data(mrb, self);
+  mrb_value str = mrb_str_new_cstr(mrb, gsl_rng_name(r));
+  mrb_str_cat(mrb, str, "", 1);
+  mrb_str_cat(mrb, str, (const char *)gsl_rng_state(r), gsl_rng_size(r));
+  return str;
+}
+
+static mrb_value mrb_rng_set_state(mrb_state *mrb, mrb_value self) {
+  gsl_rng *r = mrb_rng_get_data(mrb, self);
+  mrb_value str;
+  size_t len = strlen(gsl_rng_name(r)) + 1;
+
+  mrb_get_args(mrb, "S", &str);
+  if (RSTRING_LEN(str) != len + gsl_rng_size(r) ||
+      memcmp(RSTRING_PTR(str), gsl_rng_name(r), len)) {
+    mrb_raise(mrb, E_RNG_ERROR, "State does not match the generator type");
+  }
+  memcpy(gsl_rng_state(r), RSTRING_PTR(str) + len, gsl_rng_size(r));
+  return str;
+}
+
+#pragma mark -
+#pragma mark • Bulk fills
+
+// A draw from a distribution with up to two parameters
+typedef double (*rng_draw)(const gsl_rng *r, const double *prm);
+
+static double draw_flat(const gsl_rng *r, const double *prm) {
+  return gsl_ran_flat(r, prm[0], prm[1]);
+}
+
+static double draw_gaussian(const gsl_rng *r, const double *prm) {
+  return prm[1] + gsl_ran_gaussian_ziggurat(r, prm[0]);
+}
+
+static double draw_exponential(const gsl_rng *r, const double *prm) {
+  return gsl_ran_exponential(r, prm[0]);
+}
+
+static double draw_gamma(const gsl_rng *r, const double *prm) {
+  return gsl_ran_gamma(r, prm[0], prm[1]);
+}
+
+static double draw_lognormal(const gsl_rng *r, const double *prm) {
+  return gsl_ran_lognormal(r, prm[0], prm[1]);
+}
+
+static double draw_poisson(const gsl_rng *r, const double *prm) {
+  return gsl_ran_poisson(r, prm[0]);
+}
+
+static double draw_bernoulli(const gsl_rng *r, const double *prm) {
+  return gsl_ran_bernoulli(r, prm[0]);
+}
+
+static double draw_binomial(const gsl_rng *r, const double *prm) {
+  return gsl_ran_binomial(r, prm[0], (unsigned int)prm[1]);
+}
+
+// Fills every element of target (a Vector or a Matrix, views included)
+// with draws from the generator, and returns target
+static mrb_value rng_fill(mrb_state *mrb, gsl_rng *r, mrb_value target,
+                          rng_draw draw, const double *prm) {
+  gsl_vector *p_vec;
+  gsl_matrix *p_mat;
+  size_t i, j;
+
+  if (mrb_obj_is_kind_of(mrb, target, mrb_gsl_matrix_class)) {
+    mrb_matrix_get_data(mrb, target, &p_mat);
+    for (i = 0; i < p_mat->size1; i++) {
+      for (j = 0; j < p_mat->size2; j++)
+        p_mat->data[i * p_mat->tda + j] = draw(r, prm);
+    }
+  } else if (mrb_obj_is_kind_of(mrb, target, mrb_gsl_vector_class)) {
+    mrb_vector_get_data(mrb, target, &p_vec);
+    for (i = 0; i < p_vec->size; i++)
+      p_vec->data[i * p_vec->stride] = draw(r, prm);
+  } else {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Vector or a Matrix");
+  }
+  mrb_gsl_touch(mrb, target);
+  return target;
+}
+
+// uniform!(target, lo = 0, hi = 1)
+static mrb_value mrb_rng_uniform_bang(mrb_state *mrb, mrb_value self) {
+  mrb_value target;
+  double prm[2] = {0.0, 1.0};
+  mrb_get_args(mrb, "o|ff", &target, &prm[0], &prm[1]);
+  return rng_fill(mrb, mrb_rng_get_data(mrb, self), target, draw_flat, prm);
+}
+
+// gaussian!(target, sigma = 1, mean = 0)
+static mrb_value mrb_rng_gaussian_bang(mrb_state *mrb, mrb_value self) {
+  mrb_value target;
+  double prm[2] = {1.0, 0.0};
+  mrb_get_args(mrb, "o|ff", &target, &prm[0], &prm[1]);
+  return rng_fill(mrb, mrb_rng_get_data(mrb, self), target, draw_gaussian,
+                  prm);
+}
+
+// exponential!(target, mu = 1), mu being the mean
+static mrb_value mrb_rng_exponential_bang(mrb_state *mrb, mrb_value self) {
+  mrb_value target;
+  double prm[2] = {1.0, 0.0};
+  mrb_get_args(mrb, "o|f", &target, &prm[0]);
+  return rng_fill(mrb, mrb_rng_get_data(mrb, self), target,
+                  draw_exponential, prm);
+}
+
+// gamma!(target, a, b = 1), shape a and scale b
+static mrb_value mrb_rng_gamma_bang(mrb_state *mrb, mrb_value self) {
+  mrb_value target;
+  double prm[2] = {1.0, 1.0};
+  mrb_get_args(mrb, "of|f", &target, &prm[0], &prm[1]);
+  return rng_fill(mrb, mrb_rng_get_data(mrb, self), target, draw_gamma, prm);
+}
+
+// lognormal!(target, zeta = 0, sigma = 1)
+static mrb_value mrb_rng_lognormal_bang(mrb_state *mrb, mrb_value self) {
+  mrb_value target;
+  double prm[2] = {0.0, 1.0};
+  mrb_get_args(mrb, "o|ff", &target, &prm[0], &prm[1]);
+  return rng_fill(mrb, mrb_rng_get_data(mrb, self), target, draw_lognormal,
+                  prm);
+}
+
+// poisson!(target, mu)
+static mrb_value mrb_rng_poisson_bang(mrb_state *mrb, mrb_value self) {
+  mrb_value target;
+  double prm[2] = {1.0, 0.0};
+  mrb_get_args(mrb, "of", &target, &prm[0]);
+  return rng_fill(mrb, mrb_rng_get_data(mrb, self), target, draw_poisson,
+                  prm);
+}
+
+// bernoulli!(target, p): ones with probability p, zeros otherwise
+static mrb_value mrb_rng_bernoulli_bang(mrb_state *mrb, mrb_value self) {
+  mrb_value target;
+  double prm[2] = {0.5, 0.0};
+  mrb_get_args(mrb, "of", &target, &prm[0]);
+  if (prm[0] < 0 || prm[0] > 1) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Probability must be in [0,1]");
+  }
+  return rng_fill(mrb, mrb_rng_get_data(mrb, self), target, draw_bernoulli,
+                  prm);
+}
+
+// binomial!(target, p, n)
+static mrb_value mrb_rng_binomial_bang(mrb_state *mrb, mrb_value self) {
+  mrb_value target;
+  mrb_int n;
+  double prm[2];
+  mrb_get_args(mrb, "ofi", &target, &prm[0], &n);
+  if (prm[0] < 0 || prm[0] > 1 || n < 0) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need p in [0,1] and n >= 0");
+  }
+  prm[1] = (double)n;
+  return rng_fill(mrb, mrb_rng_get_data(mrb, self), target, draw_binomial,
+                  prm);
+}
+
+#pragma mark -
+#pragma mark • Gem setup
+
+void mrb_gsl_rng_init(mrb_state *mrb) {
+  struct RClass *rng;
+
+  mrb_load_string(mrb, "class RNGError < Exception; end");
+  // reads GSL_RNG_TYPE and GSL_RNG_SEED into gsl_rng_default(_seed)
+  gsl_rng_env_setup();
+
+  rng = mrb_define_class(mrb, "RNG", mrb->object_class);
+  mrb_gsl_rng_class = rng;
+  MRB_SET_INSTANCE_TT(rng, MRB_TT_DATA);
+  mrb_define_class_method(mrb, rng, "default", mrb_rng_s_default,
+                          MRB_ARGS_NONE());
+  mrb_define_class_method(mrb, rng, "types", mrb_rng_s_types,
+                          MRB_ARGS_NONE());
+  mrb_define_method(mrb, rng, "initialize", mrb_rng_initialize,
+                    MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, rng, "dup", mrb_rng_dup, MRB_ARGS_NONE());
+  mrb_define_method(mrb, rng, "name", mrb_rng_name, MRB_ARGS_NONE());
+  mrb_define_method(mrb, rng, "seed=", mrb_rng_set_seed, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, rng, "get", mrb_rng_get, MRB_ARGS_NONE());
+  mrb_define_method(mrb, rng, "uniform", mrb_rng_uniform, MRB_ARGS_NONE());
+  mrb_define_method(mrb, rng, "state", mrb_rng_state, MRB_ARGS_NONE());
+  mrb_define_method(mrb, rng, "state=", mrb_rng_set_state, MRB_ARGS_REQ(1));
+
+  mrb_define_method(mrb, rng, "uniform!", mrb_rng_uniform_bang,
+                    MRB_ARGS_ARG(1, 2));
+  mrb_define_method(mrb, rng, "gaussian!", mrb_rng_gaussian_bang,
+                    MRB_ARGS_ARG(1, 2));
+  mrb_define_method(mrb, rng, "exponential!", mrb_rng_exponential_bang,
+                    MRB_ARGS_ARG(1, 1));
+  mrb_define_method(mrb, rng, "gamma!", mrb_rng_gamma_bang,
+                    MRB_ARGS_ARG(2, 1));
+  mrb_define_method(mrb, rng, "lognormal!", mrb_rng_lognormal_bang,
+                    MRB_ARGS_ARG(1, 2));
+  mrb_define_method(mrb, rng, "poisson!", mrb_rng_poisson_bang,
+                    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, rng, "bernoulli!", mrb_rng_bernoulli_bang,
+                    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, rng, "binomial!", mrb_rng_binomial_bang,
+                    MRB_ARGS_REQ(3));
+}
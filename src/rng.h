@@ -0,0 +1,50 @@
+/***************************************************************************/
+/*                                                                         */
+/* rng.h - Random number generators for mruby                              */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <gsl/gsl_rng.h>
+
+#include "mruby.h"
+#include "mruby/data.h"
+#include "mruby/class.h"
+#include "mruby/value.h"
+#include "mruby/compile.h"
+
+#define E_RNG_ERROR (mrb_class_get(mrb, "RNGError"))
+
+extern struct RClass *mrb_gsl_rng_class;
+
+/***********************************************\
+ RANDOM NUMBER GENERATORS
+\***********************************************/
+
+// Garbage collector handler
+void rng_destructor(mrb_state *mrb, void *p_);
+
+// The generator wrapped by an RNG object, or the one of RNG.default if rng
+// is nil
+gsl_rng *mrb_gsl_rng_get(mrb_state *mrb, mrb_value rng);
+
+// Adds the RNG class and its bulk fills: it must be called after
+// mrb_gsl_vector_init and mrb_gsl_matrix_init
+void mrb_gsl_rng_init(mrb_state *mrb);
+
+#endif // RNG_H
@@ -0,0 +1,492 @@
+/***************************************************************************/
+/*                                                                         */
+/* running_stats.c - Streaming statistics for mruby                        */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "mruby/hash.h"
+#include "vector.h"
+#include "running_stats.h"
+
+#pragma mark -
+#pragma mark • Utilities
+
+// Garbage collector handler
+void running_stats_destructor(mrb_state *mrb, void *p_) {
+  if (p_)
+    free(p_);
+};
+
+// Creating data type and reference for GC, in a const struct
+const struct mrb_data_type running_stats_data_type = {
+    "running_stats_data", running_stats_destructor};
+
+static struct RClass *running_stats_class = NULL;
+
+// Utility function for getting the struct out of self
+static running_stats_s *mrb_running_stats_get_data(mrb_state *mrb,
+                                                   mrb_value self) {
+  running_stats_s *rs = (running_stats_s *)mrb_data_get_ptr(
+      mrb, self, &running_stats_data_type);
+  if (!rs)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access statistics data");
+  return rs;
+}
+
+// Size of the struct with nq quantile estimators
+static size_t rs_size(size_t nq) {
+  return sizeof(running_stats_s) +
+         (nq > 0 ? nq - 1 : 0) * sizeof(p2_quantile_s);
+}
+
+static int double_cmp(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+#pragma mark -
+#pragma mark • P-square quantiles
+
+static void p2_reset(p2_quantile_s *e, double p) {
+  int i;
+  e->p = p;
+  for (i = 0; i < 5; i++) {
+    e->q[i] = 0;
+    e->n[i] = i + 1;
+  }
+  e->np[0] = 1;
+  e->np[1] = 1 + 2 * p;
+  e->np[2] = 1 + 4 * p;
+  e->np[3] = 3 + 2 * p;
+  e->np[4] = 5;
+  e->dn[0] = 0;
+  e->dn[1] = p / 2;
+  e->dn[2] = p;
+  e->dn[3] = (1 + p) / 2;
+  e->dn[4] = 1;
+}
+
+// Piecewise-parabolic prediction of the height of marker i moved by d
+static double p2_parabolic(const p2_quantile_s *e, int i, double d) {
+  return e->q[i] +
+         d / (e->n[i + 1] - e->n[i - 1]) *
+             ((e->n[i] - e->n[i - 1] + d) * (e->q[i + 1] - e->q[i]) /
+                  (e->n[i + 1] - e->n[i]) +
+              (e->n[i + 1] - e->n[i] - d) * (e->q[i] - e->q[i - 1]) /
+                  (e->n[i] - e->n[i - 1]));
+}
+
+static double p2_linear(const p2_quantile_s *e, int i, int d) {
+  return e->q[i] + d * (e->q[i + d] - e->q[i]) / (e->n[i + d] - e->n[i]);
+}
+
+// Adds x as the count-th sample (count including x)
+static void p2_add(p2_quantile_s *e, size_t count, double x) {
+  int i, k, d;
+  double dd, qp;
+
+  if (count <= 5) {
+    e->q[count - 1] = x;
+    if (count == 5)
+      qsort(e->q, 5, sizeof(double), double_cmp);
+    return;
+  }
+  if (x < e->q[0]) {
+    e->q[0] = x;
+    k = 0;
+  } else if (x >= e->q[4]) {
+    e->q[4] = x;
+    k = 3;
+  } else {
+    for (k = 0; k < 3 && x >= e->q[k + 1]; k++)
+      ;
+  }
+  for (i = k + 1; i < 5; i++)
+    e->n[i] += 1;
+  for (i = 0; i < 5; i++)
+    e->np[i] += e->dn[i];
+  for (i = 1; i < 4; i++) {
+    dd = e->np[i] - e->n[i];
+    if ((dd >= 1 && e->n[i + 1] - e->n[i] > 1) ||
+        (dd <= -1 && e->n[i - 1] - e->n[i] < -1)) {
+      d = dd > 0 ? 1 : -1;
+      qp = p2_parabolic(e, i, d);
+      if (e->q[i - 1] < qp && qp < e->q[i + 1])
+        e->q[i] = qp;
+      else
+        e->q[i] = p2_linear(e, i, d);
+      e->n[i] += d;
+    }
+  }
+}
+
+// The estimate; with less than five samples, the exact quantile
+static double p2_get(const p2_quantile_s *e, size_t count) {
+  double s[5], idx, delta;
+  size_t lhs;
+
+  if (count >= 5)
+    return e->q[2];
+  if (count == 0)
+    return 0.0;
+  memcpy(s, e->q, count * sizeof(double));
+  qsort(s, count, sizeof(double), double_cmp);
+  idx = e->p * (count - 1);
+  lhs = (size_t)idx;
+  delta = idx - lhs;
+  return lhs + 1 < count ? (1 - delta) * s[lhs] + delta * s[lhs + 1]
+                         : s[lhs];
+}
+
+// Approximate merge of two estimators with at least five samples each: the
+// marker ranks add up, and their heights are averaged, weighted by count
+static void p2_merge(p2_quantile_s *a, size_t na, const p2_quantile_s *b,
+                     size_t nb) {
+  size_t n = na + nb;
+  int i;
+  a->q[0] = a->q[0] < b->q[0] ? a->q[0] : b->q[0];
+  a->q[4] = a->q[4] > b->q[4] ? a->q[4] : b->q[4];
+  for (i = 1; i < 4; i++) {
+    a->q[i] = (a->q[i] * na + b->q[i] * nb) / n;
+    a->n[i] = a->n[i] + b->n[i];
+  }
+  for (i = 1; i < 4; i++) {
+    if (a->q[i] < a->q[i - 1])
+      a->q[i] = a->q[i - 1];
+  }
+  a->n[4] = (double)n;
+  for (i = 0; i < 5; i++)
+    a->np[i] = 1 + (n - 1) * a->dn[i];
+}
+
+#pragma mark -
+#pragma mark • Accumulation
+
+static void rs_reset(running_stats_s *rs) {
+  size_t i;
+  rs->n = 0;
+  rs->mean = rs->m2 = rs->m3 = rs->m4 = rs->min = rs->max = 0;
+  for (i = 0; i < rs->nq; i++)
+    p2_reset(&rs->q[i], rs->q[i].p);
+}
+
+static void rs_push(running_stats_s *rs, double x) {
+  double n1 = (double)rs->n, n, delta, dn, dn2, term1;
+  size_t i;
+
+  if (rs->n == 0 || x < rs->min)
+    rs->min = x;
+  if (rs->n == 0 || x > rs->max)
+    rs->max = x;
+  rs->n++;
+  n = (double)rs->n;
+  delta = x - rs->mean;
+  dn = delta / n;
+  dn2 = dn * dn;
+  term1 = delta * dn * n1;
+  rs->mean += dn;
+  rs->m4 += term1 * dn2 * (n * n - 3 * n + 3) + 6 * dn2 * rs->m2 -
+            4 * dn * rs->m3;
+  rs->m3 += term1 * dn * (n - 2) - 3 * dn * rs->m2;
+  rs->m2 += term1;
+  for (i = 0; i < rs->nq; i++)
+    p2_add(&rs->q[i], rs->n, x);
+}
+
+// Chan et al. pairwise update of the moments (Pebay 2008 for the third
+// and fourth ones)
+static void rs_merge(running_stats_s *a, const running_stats_s *b) {
+  double na = (double)a->n, nb = (double)b->n, n = na + nb;
+  double d = b->mean - a->mean, d2 = d * d;
+  double m2, m3, m4;
+  size_t i, k;
+
+  if (b->n == 0)
+    return;
+  if (a->n == 0) {
+    memcpy(a, b, rs_size(a->nq));
+    return;
+  }
+  m2 = a->m2 + b->m2 + d2 * na * nb / n;
+  m3 = a->m3 + b->m3 + d2 * d * na * nb * (na - nb) / (n * n) +
+       3 * d * (na * b->m2 - nb * a->m2) / n;
+  m4 = a->m4 + b->m4 +
+       d2 * d2 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n) +
+       6 * d2 * (na * na * b->m2 + nb * nb * a->m2) / (n * n) +
+       4 * d * (na * b->m3 - nb * a->m3) / n;
+
+  for (i = 0; i < a->nq; i++) {
+    if (b->n < 5) {
+      // b still holds its samples: add them
+      for (k = 0; k < b->n; k++)
+        p2_add(&a->q[i], a->n + k + 1, b->q[i].q[k]);
+    } else if (a->n < 5) {
+      p2_quantile_s e = b->q[i];
+      for (k = 0; k < a->n; k++)
+        p2_add(&e, b->n + k + 1, a->q[i].q[k]);
+      a->q[i] = e;
+    } else {
+      p2_merge(&a->q[i], a->n, &b->q[i], b->n);
+    }
+  }
+  a->mean += d * nb / n;
+  a->m2 = m2;
+  a->m3 = m3;
+  a->m4 = m4;
+  a->min = a->min < b->min ? a->min : b->min;
+  a->max = a->max > b->max ? a->max : b->max;
+  a->n += b->n;
+}
+
+#pragma mark -
+#pragma mark • Initializations
+
+// RunningStats.new(quantiles: [0.05, 0.5, 0.95]), by default the median
+static mrb_value mrb_running_stats_initialize(mrb_state *mrb,
+                                              mrb_value self) {
+  mrb_value opts = mrb_nil_value(), qs = mrb_nil_value();
+  running_stats_s *rs;
+  mrb_int nq = 1, i;
+  double p;
+
+  mrb_get_args(mrb, "|H", &opts);
+  if (mrb_hash_p(opts)) {
+    qs = mrb_hash_get(mrb, opts,
+                      mrb_symbol_value(mrb_intern_lit(mrb, "quantiles")));
+  }
+  if (!mrb_nil_p(qs)) {
+    if (!mrb_array_p(qs)) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "quantiles must be an Array");
+    }
+    nq = RARRAY_LEN(qs);
+    for (i = 0; i < nq; i++) {
+      p = mrb_gsl_to_f(mrb, mrb_ary_ref(mrb, qs, i));
+      if (!(p >= 0 && p <= 1)) {
+        mrb_raise(mrb, E_ARGUMENT_ERROR, "Quantile must be in [0,1]");
+      }
+    }
+  }
+  rs = (running_stats_s *)DATA_PTR(self);
+  if (rs) {
+    running_stats_destructor(mrb, rs);
+  }
+  mrb_data_init(self, NULL, &running_stats_data_type);
+  rs = (running_stats_s *)malloc(rs_size(nq));
+  if (!rs)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate statistics data");
+  rs->nq = nq;
+  for (i = 0; i < nq; i++) {
+    rs->q[i].p =
+        mrb_nil_p(qs) ? 0.5 : mrb_gsl_to_f(mrb, mrb_ary_ref(mrb, qs, i));
+  }
+  rs_reset(rs);
+  mrb_data_init(self, rs, &running_stats_data_type);
+  return mrb_nil_value();
+}
+
+static mrb_value mrb_running_stats_reset(mrb_state *mrb, mrb_value self) {
+  rs_reset(mrb_running_stats_get_data(mrb, self));
+  return self;
+}
+
+#pragma mark -
+#pragma mark • Ingestion
+
+static mrb_value mrb_running_stats_push(mrb_state *mrb, mrb_value self) {
+  running_stats_s *rs = mrb_running_stats_get_data(mrb, self);
+  mrb_value x;
+  mrb_get_args(mrb, "o", &x);
+  rs_push(rs, mrb_gsl_to_f(mrb, x));
+  return self;
+}
+
+// All the elements of a Vector (or an Array), in a single C loop
+static mrb_value mrb_running_stats_push_vector(mrb_state *mrb,
+                                               mrb_value self) {
+  running_stats_s *rs = mrb_running_stats_get_data(mrb, self);
+  gsl_vector *p_vec;
+  mrb_value v;
+  size_t i;
+
+  mrb_get_args(mrb, "o", &v);
+  if (mrb_array_p(v)) {
+    for (i = 0; i < (size_t)RARRAY_LEN(v); i++)
+      rs_push(rs, mrb_gsl_to_f(mrb, mrb_ary_ref(mrb, v, i)));
+    return self;
+  }
+  if (!mrb_obj_is_kind_of(mrb, v, mrb_gsl_vector_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Vector or an Array");
+  }
+  mrb_vector_get_data(mrb, v, &p_vec);
+  for (i = 0; i < p_vec->size; i++)
+    rs_push(rs, p_vec->data[i * p_vec->stride]);
+  return self;
+}
+
+// Adds the samples accumulated by other, which must track the same
+// quantiles. Moments, min and max are exact; quantiles are approximate
+static mrb_value mrb_running_stats_merge(mrb_state *mrb, mrb_value self) {
+  running_stats_s *rs = mrb_running_stats_get_data(mrb, self), *other;
+  mrb_value v;
+  size_t i;
+
+  mrb_get_args(mrb, "o", &v);
+  if (!mrb_obj_is_kind_of(mrb, v, running_stats_class)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a RunningStats");
+  }
+  other = mrb_running_stats_get_data(mrb, v);
+  if (other == rs) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Cannot merge with itself");
+  }
+  if (other->nq != rs->nq) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Quantiles don't match");
+  }
+  for (i = 0; i < rs->nq; i++) {
+    if (other->q[i].p != rs->q[i].p) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Quantiles don't match");
+    }
+  }
+  rs_merge(rs, other);
+  return self;
+}
+
+#pragma mark -
+#pragma mark • Statistics
+
+static mrb_value mrb_running_stats_count(mrb_state *mrb, mrb_value self) {
+  return mrb_fixnum_value(mrb_running_stats_get_data(mrb, self)->n);
+}
+
+static mrb_value mrb_running_stats_mean(mrb_state *mrb, mrb_value self) {
+  return mrb_float_value(mrb, mrb_running_stats_get_data(mrb, self)->mean);
+}
+
+// Sample variance, 0 with less than two samples
+static double rs_variance(running_stats_s *rs) {
+  return rs->n > 1 ? rs->m2 / (rs->n - 1.0) : 0.0;
+}
+
+static mrb_value mrb_running_stats_variance(mrb_state *mrb, mrb_value self) {
+  return mrb_float_value(
+      mrb, rs_variance(mrb_running_stats_get_data(mrb, self)));
+}
+
+static mrb_value mrb_running_stats_sd(mrb_state *mrb, mrb_value self) {
+  return mrb_float_value(
+      mrb, sqrt(rs_variance(mrb_running_stats_get_data(mrb, self))));
+}
+
+static mrb_value mrb_running_stats_rms(mrb_state *mrb, mrb_value self) {
+  running_stats_s *rs = mrb_running_stats_get_data(mrb, self);
+  return mrb_float_value(
+      mrb, rs->n ? sqrt(rs->mean * rs->mean + rs->m2 / rs->n) : 0.0);
+}
+
+// As gsl_stats_skew
+static mrb_value mrb_running_stats_skew(mrb_state *mrb, mrb_value self) {
+  running_stats_s *rs = mrb_running_stats_get_data(mrb, self);
+  double n = (double)rs->n;
+  return mrb_float_value(mrb, pow(n - 1, 1.5) / n * rs->m3 /
+                                  pow(rs->m2, 1.5));
+}
+
+// Excess kurtosis, as gsl_stats_kurtosis
+static mrb_value mrb_running_stats_kurtosis(mrb_state *mrb, mrb_value self) {
+  running_stats_s *rs = mrb_running_stats_get_data(mrb, self);
+  double n = (double)rs->n;
+  return mrb_float_value(mrb, (n - 1) / n * (n - 1) * rs->m4 /
+                                      (rs->m2 * rs->m2) -
+                                  3.0);
+}
+
+static mrb_value mrb_running_stats_min(mrb_state *mrb, mrb_value self) {
+  return mrb_float_value(mrb, mrb_running_stats_get_data(mrb, self)->min);
+}
+
+static mrb_value mrb_running_stats_max(mrb_state *mrb, mrb_value self) {
+  return mrb_float_value(mrb, mrb_running_stats_get_data(mrb, self)->max);
+}
+
+// quantile(p = 0.5): p must be one of the tracked quantiles
+static mrb_value mrb_running_stats_quantile(mrb_state *mrb, mrb_value self) {
+  running_stats_s *rs = mrb_running_stats_get_data(mrb, self);
+  mrb_float p = 0.5;
+  size_t i;
+
+  mrb_get_args(mrb, "|f", &p);
+  for (i = 0; i < rs->nq; i++) {
+    if (rs->q[i].p == p)
+      return mrb_float_value(mrb, p2_get(&rs->q[i], rs->n));
+  }
+  mrb_raise(mrb, E_ARGUMENT_ERROR,
+            "Quantile not tracked (see RunningStats.new)");
+}
+
+// All the tracked quantiles, in the order given to new
+static mrb_value mrb_running_stats_quantiles(mrb_state *mrb,
+                                             mrb_value self) {
+  running_stats_s *rs = mrb_running_stats_get_data(mrb, self);
+  mrb_value res = mrb_ary_new_capa(mrb, rs->nq);
+  size_t i;
+  int ai = mrb_gc_arena_save(mrb);
+
+  for (i = 0; i < rs->nq; i++) {
+    mrb_ary_push(mrb, res, mrb_float_value(mrb, p2_get(&rs->q[i], rs->n)));
+    mrb_gc_arena_restore(mrb, ai);
+  }
+  return res;
+}
+
+#pragma mark -
+#pragma mark • Gem setup
+
+void mrb_gsl_running_stats_init(mrb_state *mrb) {
+  struct RClass *rs;
+
+  rs = mrb_define_class(mrb, "RunningStats", mrb->object_class);
+  running_stats_class = rs;
+  MRB_SET_INSTANCE_TT(rs, MRB_TT_DATA);
+  mrb_define_method(mrb, rs, "initialize", mrb_running_stats_initialize,
+                    MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, rs, "reset", mrb_running_stats_reset,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, rs, "push", mrb_running_stats_push, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, rs, "<<", mrb_running_stats_push, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, rs, "push_vector", mrb_running_stats_push_vector,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, rs, "merge", mrb_running_stats_merge,
+                    MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, rs, "count", mrb_running_stats_count,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, rs, "mean", mrb_running_stats_mean, MRB_ARGS_NONE());
+  mrb_define_method(mrb, rs, "variance", mrb_running_stats_variance,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, rs, "sd", mrb_running_stats_sd, MRB_ARGS_NONE());
+  mrb_define_method(mrb, rs, "rms", mrb_running_stats_rms, MRB_ARGS_NONE());
+  mrb_define_method(mrb, rs, "skew", mrb_running_stats_skew, MRB_ARGS_NONE());
+  mrb_define_method(mrb, rs, "kurtosis", mrb_running_stats_kurtosis,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, rs, "min", mrb_running_stats_min, MRB_ARGS_NONE());
+  mrb_define_method(mrb, rs, "max", mrb_running_stats_max, MRB_ARGS_NONE());
+  mrb_define_method(mrb, rs, "quantile", mrb_running_stats_quantile,
+                    MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, rs, "median", mrb_running_stats_quantile,
+                    MRB_ARGS_NONE());
+  mrb_define_method(mrb, rs, "quantiles", mrb_running_stats_quantiles,
+                    MRB_ARGS_NONE());
+}
@@ -0,0 +1,59 @@
+/***************************************************************************/
+/*                                                                         */
+/* running_stats.h - Streaming statistics for mruby                        */
+/* Copyright (C) 2015 Paolo Bosetti                                        */
+/* paolo[dot]bosetti[at]unitn.it                                           */
+/* Department of Industrial Engineering, University of Trento              */
+/*                                                                         */
+/* This library is free software.  You can redistribute it and/or          */
+/* modify it under the terms of the GNU GENERAL PUBLIC LICENSE 2.0.        */
+/*                                                                         */
+/* This library is distributed in the hope that it will be useful,         */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/* Artistic License 2.0 for more details.                                  */
+/*                                                                         */
+/* See the file LICENSE                                                    */
+/*                                                                         */
+/***************************************************************************/
+
+#ifndef RUNNING_STATS_H
+#define RUNNING_STATS_H
+
+#include <stdlib.h>
+
+#include "mruby.h"
+#include "mruby/data.h"
+#include "mruby/class.h"
+#include "mruby/value.h"
+
+/***********************************************\
+ RUNNING STATISTICS
+\***********************************************/
+
+// P-square estimator of a single quantile (Jain and Chlamtac, 1985): five
+// markers, whose heights approximate the min, p/2, p, (1+p)/2 quantiles and
+// the max. Until five samples are seen, q holds the samples themselves
+typedef struct {
+  double p;
+  double q[5];   // marker heights
+  double n[5];   // marker positions (1-based ranks)
+  double np[5];  // desired positions
+  double dn[5];  // desired position increments
+} p2_quantile_s;
+
+// Moments are accumulated as in gsl_rstat (Welford's update, extended to
+// the third and fourth central moments), and can be merged
+typedef struct {
+  size_t n;
+  double mean, m2, m3, m4, min, max;
+  size_t nq;
+  p2_quantile_s q[1]; // nq of them, allocated with the struct
+} running_stats_s;
+
+// Garbage collector handler
+void running_stats_destructor(mrb_state *mrb, void *p_);
+
+void mrb_gsl_running_stats_init(mrb_state *mrb);
+
+#endif // RUNNING_STATS_H
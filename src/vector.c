@@ -17,11 +17,13 @@
 /*                                                                         */
 /***************************************************************************/
 
+#include <stdint.h>
 #include <gsl/gsl_blas.h>
 #include <gsl/gsl_statistics_double.h>
 #include <gsl/gsl_sort_vector.h>
-#include <gsl/gsl_rng.h>
 #include "vector.h"
+#include "rng.h"
+#include "buffer.h"
 
 #pragma mark -
 #pragma mark • Utilities
@@ -31,22 +33,97 @@
 // Check it with GC.start
 void vector_destructor(mrb_state *mrb, void *p_) {
   gsl_vector *v = (gsl_vector *)p_;
-  gsl_vector_free(v);
+  if (v)
+    gsl_vector_free(v);
 };
 
 // Creating data type and reference for GC, in a const struct
 const struct mrb_data_type vector_data_type = {"vector_data",
                                                vector_destructor};
 
-// Utility function for getting the struct out of the wrapping IV @data
-void mrb_vector_get_data(mrb_state *mrb, mrb_value self, gsl_vector **data) {
-  mrb_value data_value;
-  data_value = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@data"));
+struct RClass *mrb_gsl_vector_class = NULL;
+struct RClass *mrb_gsl_vector_view_class = NULL;
 
-  // Loading data from data_value into p_data:
-  Data_Get_Struct(mrb, data_value, &vector_data_type, *data);
+// Utility function for getting the struct out of self
+void mrb_vector_get_data(mrb_state *mrb, mrb_value self, gsl_vector **data) {
+  *data = (gsl_vector *)mrb_data_get_ptr(mrb, self, &vector_data_type);
   if (!*data)
-    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access @data");
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not access vector data");
+  mrb_gsl_buffer_linearize(mrb, self);
+}
+
+mrb_value mrb_gsl_vector_new_uninit(mrb_state *mrb, mrb_int n) {
+  struct RData *data;
+  gsl_vector *p_vec;
+
+  // Create the object first, so that the struct can't leak if GC kicks in
+  data = mrb_data_object_alloc(mrb, mrb_gsl_vector_class, NULL,
+                               &vector_data_type);
+  p_vec = gsl_vector_alloc(n);
+  if (!p_vec)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate vector data");
+  data->data = p_vec;
+  return mrb_obj_value(data);
+}
+
+mrb_value mrb_gsl_vector_view_new(mrb_state *mrb, mrb_value parent,
+                                  gsl_vector_view view) {
+  struct RData *data;
+  gsl_vector *p_vec;
+  mrb_value result;
+
+  data = mrb_data_object_alloc(mrb, mrb_gsl_vector_view_class, NULL,
+                               &vector_data_type);
+  result = mrb_obj_value(data);
+  // the view does not own its block: keep the owner alive for the GC
+  mrb_iv_set(mrb, result, mrb_intern_lit(mrb, "@parent"), parent);
+  // owner is 0, so gsl_vector_free() only releases this struct
+  p_vec = (gsl_vector *)malloc(sizeof(gsl_vector));
+  if (!p_vec)
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate vector view");
+  *p_vec = view.vector;
+  data->data = p_vec;
+  return result;
+}
+
+double mrb_gsl_to_f(mrb_state *mrb, mrb_value v) {
+  if (mrb_float_p(v))
+    return mrb_float(v);
+  if (mrb_fixnum_p(v))
+    return (double)mrb_fixnum(v);
+  return mrb_to_flo(mrb, mrb_funcall(mrb, v, "to_f", 0));
+}
+
+mrb_bool mrb_gsl_overlap(const double *a, size_t na, const double *b,
+                         size_t nb) {
+  uintptr_t pa = (uintptr_t)a, pb = (uintptr_t)b;
+  return na && nb && pa < pb + nb * sizeof(double) &&
+         pb < pa + na * sizeof(double);
+}
+
+size_t mrb_gsl_vector_span(const gsl_vector *v) {
+  return v->size ? (v->size - 1) * v->stride + 1 : 0;
+}
+
+size_t mrb_gsl_matrix_span(const gsl_matrix *m) {
+  return m->size1 && m->size2 ? (m->size1 - 1) * m->tda + m->size2 : 0;
+}
+
+// Interned once in mrb_gsl_vector_init, as touch runs on every write
+static mrb_sym sym_lu = 0, sym_parent = 0;
+
+void mrb_gsl_touch(mrb_state *mrb, mrb_value self) {
+  while (!mrb_nil_p(self)) {
+    // plain Vectors and Matrices have no ivars at all: nothing to drop
+    if (mrb_type(self) == MRB_TT_DATA && !RDATA(self)->iv) {
+      mrb_gsl_buffer_dirty(mrb, self);
+      return;
+    }
+    mrb_gsl_buffer_dirty(mrb, self);
+    if (!mrb_nil_p(mrb_iv_get(mrb, self, sym_lu)))
+      mrb_iv_set(mrb, self, sym_lu, mrb_nil_value());
+    self = mrb_iv_get(mrb, self, sym_parent);
+  }
 }
 
 #pragma mark -
@@ -54,26 +131,21 @@ void mrb_vector_get_data(mrb_state *mrb, mrb_value self, gsl_vector **data) {
 
 // Data Initializer C function (not exposed!)
 static void mrb_vector_init(mrb_state *mrb, mrb_value self, mrb_int n) {
-  mrb_value data_value; // this IV holds the data
-  gsl_vector *p_data;   // pointer to the C struct
-
-  data_value = mrb_iv_get(mrb, self, mrb_intern_lit(mrb, "@data"));
+  gsl_vector *p_data; // pointer to the C struct
 
-  // if @data already exists, free its content:
-  if (!mrb_nil_p(data_value)) {
-    Data_Get_Struct(mrb, data_value, &vector_data_type, p_data);
-    free(p_data);
+  // if data already exists, free its content:
+  p_data = (gsl_vector *)DATA_PTR(self);
+  if (p_data && DATA_TYPE(self)) {
+    DATA_TYPE(self)->dfree(mrb, p_data);
   }
+  mrb_data_init(self, NULL, &vector_data_type);
   // Allocate and zero-out the data struct:
   p_data = gsl_vector_calloc(n);
   if (!p_data)
-    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate @data");
+    mrb_raise(mrb, E_RUNTIME_ERROR, "Could not allocate vector data");
 
-  // Wrap struct into @data:
-  mrb_iv_set(
-      mrb, self, mrb_intern_lit(mrb, "@data"), // set @data
-      mrb_obj_value(                           // with value hold in struct
-          Data_Wrap_Struct(mrb, mrb->object_class, &vector_data_type, p_data)));
+  // Attach struct to self:
+  mrb_data_init(self, p_data, &vector_data_type);
 }
 
 static mrb_value mrb_vector_initialize(mrb_state *mrb, mrb_value self) {
@@ -82,40 +154,39 @@ static mrb_value mrb_vector_initialize(mrb_state *mrb, mrb_value self) {
 
   // Call strcut initializer:
   mrb_vector_init(mrb, self, n);
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@length"), mrb_fixnum_value(n));
-  mrb_iv_set(mrb, self, mrb_intern_lit(mrb, "@format"),
-             mrb_str_new_cstr(mrb, "%10.3f"));
   return mrb_nil_value();
 }
 
+static mrb_value mrb_vector_length(mrb_state *mrb, mrb_value self) {
+  gsl_vector *p_vec = NULL;
+  mrb_vector_get_data(mrb, self, &p_vec);
+  return mrb_fixnum_value(p_vec->size);
+}
+
+// Uniform in [0, 1), drawn from rng or from RNG.default
 static mrb_value mrb_vector_rnd_fill(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec = NULL;
-  const gsl_rng_type *T;
+  mrb_value rng = mrb_nil_value();
   gsl_rng *r;
-  mrb_int h;
+  size_t h;
 
+  mrb_get_args(mrb, "|o", &rng);
+  r = mrb_gsl_rng_get(mrb, rng);
   mrb_vector_get_data(mrb, self, &p_vec);
-
-  gsl_rng_env_setup();
-  T = gsl_rng_default;
-  r = gsl_rng_alloc(T);
-
   for (h = 0; h < p_vec->size; h++) {
-    gsl_vector_set(p_vec, h, gsl_rng_uniform(r));
+    p_vec->data[h * p_vec->stride] = gsl_rng_uniform(r);
   }
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
-
 static mrb_value mrb_vector_dup(mrb_state *mrb, mrb_value self) {
   mrb_value other;
   gsl_vector *p_vec = NULL, *p_vec_other = NULL;
-  mrb_value args[1];
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
-  args[0] = mrb_fixnum_value(p_vec->size);
-  other = mrb_obj_new(mrb, mrb_class_get(mrb, "Vector"), 1, args);
+  other = mrb_gsl_vector_new_uninit(mrb, p_vec->size);
   mrb_vector_get_data(mrb, other, &p_vec_other);
   gsl_vector_memcpy(p_vec_other, p_vec);
   return other;
@@ -126,18 +197,20 @@ static mrb_value mrb_vector_all(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec = NULL;
 
   mrb_get_args(mrb, "f", &v);
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   gsl_vector_set_all(p_vec, v);
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
 static mrb_value mrb_vector_zero(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec = NULL;
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   gsl_vector_set_zero(p_vec);
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
@@ -146,9 +219,10 @@ static mrb_value mrb_vector_basis(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec = NULL;
 
   mrb_get_args(mrb, "i", &i);
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   gsl_vector_set_basis(p_vec, i);
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
@@ -161,7 +235,7 @@ static mrb_value mrb_vector_equal(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec, *p_vec_other;
   mrb_get_args(mrb, "o", &other);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   mrb_vector_get_data(mrb, other, &p_vec_other);
   if (1 == gsl_vector_equal(p_vec, p_vec_other))
@@ -179,7 +253,7 @@ static mrb_value mrb_vector_get_i(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec = NULL;
 
   mrb_get_args(mrb, "i", &i);
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   if (i >= p_vec->size) {
     mrb_raise(mrb, E_VECTOR_ERROR, "Vector index out of range!");
@@ -194,29 +268,66 @@ static mrb_value mrb_vector_set_i(mrb_state *mrb, mrb_value self) {
 
   mrb_get_args(mrb, "if", &i, &f);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   if (i >= p_vec->size) {
     mrb_raise(mrb, E_VECTOR_ERROR, "Vector index out of range!");
   }
   gsl_vector_set(p_vec, (size_t)i, (double)f);
+  mrb_gsl_touch(mrb, self);
   return mrb_float_value(mrb, f);
 }
 
+// Vector[1, 2, 3]
+static mrb_value mrb_vector_s_new_from(mrb_state *mrb, mrb_value klass) {
+  mrb_value *argv, result;
+  mrb_int argc, i;
+  gsl_vector *p_vec = NULL;
+
+  mrb_get_args(mrb, "*", &argv, &argc);
+  result = mrb_gsl_vector_new_uninit(mrb, argc);
+  mrb_vector_get_data(mrb, result, &p_vec);
+  for (i = 0; i < argc; i++) {
+    p_vec->data[i] = mrb_gsl_to_f(mrb, argv[i]);
+  }
+  return result;
+}
+
 static mrb_value mrb_vector_to_a(mrb_state *mrb, mrb_value self) {
-  int i;
+  size_t i;
+  int ai;
   mrb_value ary = mrb_nil_value();
   gsl_vector *p_vec = NULL;
   mrb_float e;
   mrb_vector_get_data(mrb, self, &p_vec);
   ary = mrb_ary_new_capa(mrb, p_vec->size);
+  ai = mrb_gc_arena_save(mrb);
   for (i = 0; i < p_vec->size; i++) {
     e = *(p_vec->data + i * p_vec->stride);
-    mrb_ary_set(mrb, ary, i, mrb_float_value(mrb, e));
+    mrb_ary_push(mrb, ary, mrb_float_value(mrb, e));
+    // boxed floats are referenced by ary: don't let them fill the arena
+    mrb_gc_arena_restore(mrb, ai);
   }
   return ary;
 }
 
+#pragma mark -
+#pragma mark • Views
+
+static mrb_value mrb_vector_subvector(mrb_state *mrb, mrb_value self) {
+  mrb_int offset, n, stride = 1;
+  gsl_vector *p_vec = NULL;
+
+  mrb_get_args(mrb, "ii|i", &offset, &n, &stride);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  if (offset < 0 || n <= 0 || stride <= 0 ||
+      offset + (n - 1) * stride >= p_vec->size) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Subvector out of range!");
+  }
+  return mrb_gsl_vector_view_new(
+      mrb, self, gsl_vector_subvector_with_stride(p_vec, offset, stride, n));
+}
+
 #pragma mark -
 #pragma mark • Properties
 
@@ -252,18 +363,19 @@ static mrb_value mrb_vector_add(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec, *p_vec_other;
   mrb_get_args(mrb, "o", &other);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
 
-  if (mrb_obj_is_kind_of(mrb, other, mrb_class_get(mrb, "Vector"))) {
+  if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_vector_class)) {
     mrb_vector_get_data(mrb, other, &p_vec_other);
     if (p_vec->size != p_vec_other->size) {
       mrb_raise(mrb, E_VECTOR_ERROR, "Vector indexes don't match!");
     }
     gsl_vector_add(p_vec, p_vec_other);
-  } else if (mrb_obj_is_kind_of(mrb, other, mrb_class_get(mrb, "Numeric"))) {
+  } else if ((mrb_float_p(other) || mrb_fixnum_p(other))) {
     gsl_vector_add_constant(p_vec, mrb_to_flo(mrb, other));
   }
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
@@ -272,13 +384,14 @@ static mrb_value mrb_vector_sub(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec, *p_vec_other;
   mrb_get_args(mrb, "o", &other);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   mrb_vector_get_data(mrb, other, &p_vec_other);
   if (p_vec->size != p_vec_other->size) {
     mrb_raise(mrb, E_VECTOR_ERROR, "Vector dimensions don't match!");
   }
   gsl_vector_sub(p_vec, p_vec_other);
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
@@ -287,17 +400,18 @@ static mrb_value mrb_vector_mul(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec, *p_vec_other;
   mrb_get_args(mrb, "o", &other);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
-  if (mrb_obj_is_kind_of(mrb, other, mrb_class_get(mrb, "Vector"))) {
+  if (mrb_obj_is_kind_of(mrb, other, mrb_gsl_vector_class)) {
     mrb_vector_get_data(mrb, other, &p_vec_other);
     if (p_vec->size != p_vec_other->size) {
       mrb_raise(mrb, E_VECTOR_ERROR, "Vector indexes don't match!");
     }
     gsl_vector_mul(p_vec, p_vec_other);
-  } else if (mrb_obj_is_kind_of(mrb, other, mrb_class_get(mrb, "Numeric"))) {
+  } else if ((mrb_float_p(other) || mrb_fixnum_p(other))) {
     gsl_vector_scale(p_vec, mrb_to_flo(mrb, other));
   }
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
@@ -306,13 +420,14 @@ static mrb_value mrb_vector_div(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec, *p_vec_other;
   mrb_get_args(mrb, "o", &other);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   mrb_vector_get_data(mrb, other, &p_vec_other);
   if (p_vec->size != p_vec_other->size) {
     mrb_raise(mrb, E_VECTOR_ERROR, "Vector indexes don't match!");
   }
   gsl_vector_div(p_vec, p_vec_other);
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
@@ -322,10 +437,10 @@ static mrb_value mrb_vector_prod(mrb_state *mrb, mrb_value self) {
   mrb_float res;
   mrb_get_args(mrb, "o", &other);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   mrb_vector_get_data(mrb, other, &p_vec_other);
-  if (!mrb_obj_is_kind_of(mrb, other, mrb_class_get(mrb, "Vector"))) {
+  if (!mrb_obj_is_kind_of(mrb, other, mrb_gsl_vector_class)) {
     mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Vector!");
   }
   if (p_vec->size != p_vec_other->size) {
@@ -340,7 +455,7 @@ static mrb_value mrb_vector_prod(mrb_state *mrb, mrb_value self) {
 static mrb_value mrb_vector_norm(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec;
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   return mrb_float_value(mrb, gsl_blas_dnrm2(p_vec));
 }
@@ -348,7 +463,7 @@ static mrb_value mrb_vector_norm(mrb_state *mrb, mrb_value self) {
 static mrb_value mrb_vector_sum(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec;
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   return mrb_float_value(mrb, gsl_blas_dasum(p_vec));
 }
@@ -358,33 +473,171 @@ static mrb_value mrb_vector_swap(mrb_state *mrb, mrb_value self) {
   mrb_int i, j;
   mrb_get_args(mrb, "ii", &i, &j);
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   if (gsl_vector_swap_elements(p_vec, i, j)) {
     mrb_raise(mrb, E_VECTOR_ERROR, "Cannot swap");
   }
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
 static mrb_value mrb_vector_reverse(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec;
 
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   if (gsl_vector_reverse(p_vec)) {
     mrb_raise(mrb, E_VECTOR_ERROR, "Cannot reverse");
   }
+  mrb_gsl_touch(mrb, self);
   return self;
 }
 
 
+// Non-destructive and output-argument versions of add!, sub!, mul!, div!
+
+void mrb_gsl_elementwise(char op, size_t n, double *out, size_t so,
+                         const double *a, size_t sa, const double *b,
+                         size_t sb) {
+  size_t i;
+  switch (op) {
+  case '+':
+    for (i = 0; i < n; i++)
+      out[i * so] = a[i * sa] + b[i * sb];
+    break;
+  case '-':
+    for (i = 0; i < n; i++)
+      out[i * so] = a[i * sa] - b[i * sb];
+    break;
+  case '*':
+    for (i = 0; i < n; i++)
+      out[i * so] = a[i * sa] * b[i * sb];
+    break;
+  case '/':
+    for (i = 0; i < n; i++)
+      out[i * so] = a[i * sa] / b[i * sb];
+    break;
+  }
+}
+
+// out = self <op> other, other being a Vector or a Numeric
+static void mrb_vector_elementwise(mrb_state *mrb, char op, mrb_value self,
+                                   mrb_value other, gsl_vector *p_out) {
+  gsl_vector *p_vec, *p_vec_other;
+  double k;
+
+  mrb_vector_get_data(mrb, self, &p_vec);
+  if (p_out->size != p_vec->size) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Vector dimensions don't match!");
+  }
+  if (mrb_float_p(other) || mrb_fixnum_p(other)) {
+    k = mrb_to_flo(mrb, other);
+    mrb_gsl_elementwise(op, p_vec->size, p_out->data, p_out->stride,
+                        p_vec->data, p_vec->stride, &k, 0);
+  } else {
+    if (!mrb_obj_is_kind_of(mrb, other, mrb_gsl_vector_class)) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a Vector or a Numeric!");
+    }
+    mrb_vector_get_data(mrb, other, &p_vec_other);
+    if (p_vec->size != p_vec_other->size) {
+      mrb_raise(mrb, E_VECTOR_ERROR, "Vector dimensions don't match!");
+    }
+    mrb_gsl_elementwise(op, p_vec->size, p_out->data, p_out->stride,
+                        p_vec->data, p_vec->stride, p_vec_other->data,
+                        p_vec_other->stride);
+  }
+}
+
+static mrb_value mrb_vector_op_new(mrb_state *mrb, mrb_value self, char op) {
+  mrb_value other, res;
+  gsl_vector *p_vec, *p_res;
+  mrb_get_args(mrb, "o", &other);
+
+  mrb_vector_get_data(mrb, self, &p_vec);
+  res = mrb_gsl_vector_new_uninit(mrb, p_vec->size);
+  mrb_vector_get_data(mrb, res, &p_res);
+  mrb_vector_elementwise(mrb, op, self, other, p_res);
+  return res;
+}
+
+static mrb_value mrb_vector_op_into(mrb_state *mrb, mrb_value self, char op) {
+  mrb_value other, out;
+  gsl_vector *p_out;
+  mrb_get_args(mrb, "oo", &other, &out);
+
+  mrb_vector_get_data(mrb, out, &p_out);
+  mrb_vector_elementwise(mrb, op, self, other, p_out);
+  mrb_gsl_touch(mrb, out);
+  return out;
+}
+
+static mrb_value mrb_vector_plus(mrb_state *mrb, mrb_value self) {
+  return mrb_vector_op_new(mrb, self, '+');
+}
+
+static mrb_value mrb_vector_minus(mrb_state *mrb, mrb_value self) {
+  return mrb_vector_op_new(mrb, self, '-');
+}
+
+static mrb_value mrb_vector_times(mrb_state *mrb, mrb_value self) {
+  return mrb_vector_op_new(mrb, self, '*');
+}
+
+static mrb_value mrb_vector_over(mrb_state *mrb, mrb_value self) {
+  return mrb_vector_op_new(mrb, self, '/');
+}
+
+static mrb_value mrb_vector_add_into(mrb_state *mrb, mrb_value self) {
+  return mrb_vector_op_into(mrb, self, '+');
+}
+
+static mrb_value mrb_vector_sub_into(mrb_state *mrb, mrb_value self) {
+  return mrb_vector_op_into(mrb, self, '-');
+}
+
+static mrb_value mrb_vector_mul_into(mrb_state *mrb, mrb_value self) {
+  return mrb_vector_op_into(mrb, self, '*');
+}
+
+static mrb_value mrb_vector_div_into(mrb_state *mrb, mrb_value self) {
+  return mrb_vector_op_into(mrb, self, '/');
+}
+
+#pragma mark -
+#pragma mark • Iterators
+
+// Yields the elements in order. The struct is fetched again at each step,
+// as the block could reinitialize self
+static mrb_value mrb_vector_each(mrb_state *mrb, mrb_value self) {
+  mrb_value blk;
+  gsl_vector *p_vec = NULL;
+  size_t i;
+  int ai;
+
+  mrb_get_args(mrb, "&", &blk);
+  if (mrb_nil_p(blk)) {
+    mrb_raise(mrb, E_ARGUMENT_ERROR, "Need a block");
+  }
+  ai = mrb_gc_arena_save(mrb);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  for (i = 0; i < p_vec->size; i++) {
+    mrb_yield(mrb, blk, mrb_float_value(mrb, p_vec->data[i * p_vec->stride]));
+    mrb_gc_arena_restore(mrb, ai);
+    mrb_vector_get_data(mrb, self, &p_vec);
+    if (i >= p_vec->size)
+      break;
+  }
+  return self;
+}
+
 #pragma mark -
 #pragma mark • Statistics
 
 static mrb_value mrb_vector_mean(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec;
   mrb_float result;
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   result = gsl_stats_mean(p_vec->data, p_vec->stride, p_vec->size);
   return mrb_float_value(mrb, result);
@@ -394,7 +647,7 @@ static mrb_value mrb_vector_variance(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec;
   mrb_float result;
   mrb_float m;
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   if (mrb_get_args(mrb, "|f", &m) == 1) {
     result = gsl_stats_variance_m(p_vec->data, p_vec->stride, p_vec->size, m);
@@ -408,7 +661,7 @@ static mrb_value mrb_vector_sd(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec;
   mrb_float result;
   mrb_float m;
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   if (mrb_get_args(mrb, "|f", &m) == 1) {
     result = gsl_stats_sd_m(p_vec->data, p_vec->stride, p_vec->size, m);
@@ -422,7 +675,7 @@ static mrb_value mrb_vector_absdev(mrb_state *mrb, mrb_value self) {
   gsl_vector *p_vec;
   mrb_float result;
   mrb_float m;
-  // call utility for unwrapping @data into p_data:
+  // call utility for unwrapping data into p_vec:
   mrb_vector_get_data(mrb, self, &p_vec);
   if (mrb_get_args(mrb, "|f", &m) == 1) {
     result = gsl_stats_absdev_m(p_vec->data, p_vec->stride, p_vec->size, m);
@@ -432,32 +685,190 @@ static mrb_value mrb_vector_absdev(mrb_state *mrb, mrb_value self) {
   return mrb_float_value(mrb, result);
 }
 
-static mrb_value mrb_vector_quantile(mrb_state *mrb, mrb_value self) {
-  gsl_vector *p_vec = NULL, *p_sort_vec = NULL;
-  mrb_float result;
-  mrb_float f;
-  mrb_int n;
-  // call utility for unwrapping @data into p_data:
-  mrb_vector_get_data(mrb, self, &p_vec);
-  n = mrb_get_args(mrb, "|f", &f);
-  if (f < 0 || f > 1) {
-    mrb_raise(mrb, E_VECTOR_ERROR, "Quantile must be in [0,1]");
+// Selection of order statistics, in O(n) on average instead of a full
+// sort. select_kth partially orders x[lo, hi) so that x[k] is the element
+// that would be there if the range was sorted, with no larger element
+// before it and no smaller one after it. Quickselect with median-of-three
+// pivots, falling back to qsort after depth bad partitions (introselect)
+
+static int select_cmp(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static void select_kth(double *x, size_t lo, size_t hi, size_t k,
+                       int depth) {
+  ptrdiff_t i, j;
+  size_t mid;
+  double t, pivot;
+
+  while (hi - lo > 16) {
+    if (depth-- == 0) {
+      qsort(x + lo, hi - lo, sizeof(double), select_cmp);
+      return;
+    }
+    mid = lo + (hi - lo) / 2;
+    if (x[mid] < x[lo]) { t = x[mid]; x[mid] = x[lo]; x[lo] = t; }
+    if (x[hi - 1] < x[lo]) { t = x[hi - 1]; x[hi - 1] = x[lo]; x[lo] = t; }
+    if (x[hi - 1] < x[mid]) { t = x[hi - 1]; x[hi - 1] = x[mid]; x[mid] = t; }
+    pivot = x[mid];
+    // Hoare partition: afterwards x[lo, j] <= pivot <= x[j + 1, hi)
+    i = (ptrdiff_t)lo - 1;
+    j = (ptrdiff_t)hi;
+    for (;;) {
+      do i++; while (x[i] < pivot);
+      do j--; while (x[j] > pivot);
+      if (i >= j)
+        break;
+      t = x[i]; x[i] = x[j]; x[j] = t;
+    }
+    if (k <= (size_t)j)
+      hi = j + 1;
+    else
+      lo = j + 1;
   }
-  p_sort_vec = gsl_vector_calloc(p_vec->size);
-  if (gsl_vector_memcpy(p_sort_vec, p_vec)) {
-    mrb_raise(mrb, E_VECTOR_ERROR, "Cannot copy vector");
+  // insertion sort of the last few elements
+  for (mid = lo + 1; mid < hi; mid++) {
+    t = x[mid];
+    for (i = mid; i > (ptrdiff_t)lo && x[i - 1] > t; i--)
+      x[i] = x[i - 1];
+    x[i] = t;
   }
-  gsl_sort_vector(p_sort_vec);
-  if (n == 1) {
-    result = gsl_stats_quantile_from_sorted_data(
-        p_sort_vec->data, p_sort_vec->stride, p_sort_vec->size, f);
-  } else {
-    result = gsl_stats_quantile_from_sorted_data(
-        p_sort_vec->data, p_sort_vec->stride, p_sort_vec->size, 0.5);
+}
+
+// Selects all the (sorted, distinct) ranks in x[lo, hi): each selection
+// splits the range, and the ranks on either side are searched in their
+// half only
+static void select_ranks(double *x, size_t lo, size_t hi, const size_t *ranks,
+                         size_t nr, int depth) {
+  size_t m, k;
+  if (nr == 0)
+    return;
+  m = nr / 2;
+  k = ranks[m];
+  select_kth(x, lo, hi, k, depth);
+  select_ranks(x, lo, k, ranks, m, depth);
+  select_ranks(x, k + 1, hi, ranks + m + 1, nr - m - 1, depth);
+}
+
+static int rank_cmp(const void *a, const void *b) {
+  size_t x = *(const size_t *)a, y = *(const size_t *)b;
+  return (x > y) - (x < y);
+}
+
+// Computes nq quantiles of p_vec into res, interpolating as
+// gsl_stats_quantile_from_sorted_data. The data are copied into scratch (a
+// contiguous Vector with at least as many elements), or into a temporary
+// buffer if scratch is nil
+static void vector_quantiles(mrb_state *mrb, gsl_vector *p_vec,
+                             const double *f, size_t nq, mrb_value scratch,
+                             double *res) {
+  gsl_vector *p_scratch = NULL;
+  double *x, delta;
+  size_t *ranks, nr = 0, i, n = p_vec->size, lhs;
+  int depth = 0;
+
+  if (n == 0) {
+    mrb_raise(mrb, E_VECTOR_ERROR, "Empty Vector");
+  }
+  for (i = 0; i < nq; i++) {
+    if (!(f[i] >= 0 && f[i] <= 1)) {
+      mrb_raise(mrb, E_VECTOR_ERROR, "Quantile must be in [0,1]");
+    }
+  }
+  if (!mrb_nil_p(scratch)) {
+    if (!mrb_obj_is_kind_of(mrb, scratch, mrb_gsl_vector_class)) {
+      mrb_raise(mrb, E_ARGUMENT_ERROR, "Scratch must be a Vector");
+    }
+    mrb_vector_get_data(mrb, scratch, &p_scratch);
+    if (p_scratch->stride != 1 || p_scratch->size < n) {
+      mrb_raise(mrb, E_VECTOR_ERROR,
+                "Scratch must be contiguous and at least as long as self");
+    }
+    if (mrb_gsl_overlap(p_scratch->data, n, p_vec->data,
+                        mrb_gsl_vector_span(p_vec))) {
+      mrb_raise(mrb, E_VECTOR_ERROR, "Scratch must not alias self");
+    }
+    mrb_gsl_touch(mrb, scratch);
+  }
+
+  // nothing can raise from here on
+  ranks = (size_t *)mrb_malloc(mrb, 2 * nq * sizeof(size_t));
+  x = p_scratch ? p_scratch->data
+                : (double *)mrb_malloc(mrb, n * sizeof(double));
+  for (i = 0; i < n; i++)
+    x[i] = p_vec->data[i * p_vec->stride];
+  for (i = 0; i < nq; i++) {
+    lhs = (size_t)(f[i] * (n - 1));
+    ranks[nr++] = lhs;
+    if (lhs + 1 < n)
+      ranks[nr++] = lhs + 1;
+  }
+  qsort(ranks, nr, sizeof(size_t), rank_cmp);
+  for (lhs = 0, i = 1; i < nr; i++) {
+    if (ranks[i] != ranks[lhs])
+      ranks[++lhs] = ranks[i];
   }
+  nr = nr ? lhs + 1 : 0;
+  for (i = n; i > 1; i >>= 1)
+    depth += 2;
+  select_ranks(x, 0, n, ranks, nr, depth);
+
+  for (i = 0; i < nq; i++) {
+    delta = f[i] * (n - 1);
+    lhs = (size_t)delta;
+    delta -= lhs;
+    res[i] = (lhs + 1 < n && delta > 0)
+                 ? (1 - delta) * x[lhs] + delta * x[lhs + 1]
+                 : x[lhs];
+  }
+  mrb_free(mrb, ranks);
+  if (!p_scratch)
+    mrb_free(mrb, x);
+}
+
+// quantile(f = 0.5, scratch = nil)
+static mrb_value mrb_vector_quantile(mrb_state *mrb, mrb_value self) {
+  gsl_vector *p_vec = NULL;
+  mrb_value scratch = mrb_nil_value();
+  mrb_float f = 0.5;
+  double result;
+
+  mrb_get_args(mrb, "|fo", &f, &scratch);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  vector_quantiles(mrb, p_vec, &f, 1, scratch, &result);
   return mrb_float_value(mrb, result);
 }
 
+// quantiles([f1, f2, ...], scratch = nil), selecting all of them in a
+// single pass over the data
+static mrb_value mrb_vector_quantiles(mrb_state *mrb, mrb_value self) {
+  gsl_vector *p_vec = NULL;
+  mrb_value fs, scratch = mrb_nil_value(), res;
+  mrb_int nq, i;
+  double *buf;
+  int ai;
+
+  mrb_get_args(mrb, "A|o", &fs, &scratch);
+  mrb_vector_get_data(mrb, self, &p_vec);
+  nq = RARRAY_LEN(fs);
+  res = mrb_ary_new_capa(mrb, nq);
+  if (nq == 0)
+    return res;
+  // f in the first half, results in the second one; the buffer is kept by
+  // a String, so that it is collected if a conversion raises
+  buf = (double *)RSTRING_PTR(
+      mrb_str_new(mrb, NULL, 2 * nq * sizeof(double)));
+  for (i = 0; i < nq; i++)
+    buf[i] = mrb_gsl_to_f(mrb, mrb_ary_ref(mrb, fs, i));
+  vector_quantiles(mrb, p_vec, buf, nq, scratch, buf + nq);
+  ai = mrb_gc_arena_save(mrb);
+  for (i = 0; i < nq; i++) {
+    mrb_ary_push(mrb, res, mrb_float_value(mrb, buf[nq + i]));
+    mrb_gc_arena_restore(mrb, ai);
+  }
+  return res;
+}
 
 #pragma mark -
 #pragma mark • Gem setup
@@ -466,16 +877,24 @@ void mrb_gsl_vector_init(mrb_state *mrb) {
   struct RClass *gsl;
 
   mrb_load_string(mrb, "class VectorError < Exception; end");
+  sym_lu = mrb_intern_lit(mrb, "@lu");
+  sym_parent = mrb_intern_lit(mrb, "@parent");
 
   gsl = mrb_define_class(mrb, "Vector", mrb->object_class);
+  MRB_SET_INSTANCE_TT(gsl, MRB_TT_DATA);
+  mrb_gsl_vector_class = gsl;
   mrb_define_method(mrb, gsl, "all", mrb_vector_all, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, gsl, "zero", mrb_vector_zero, MRB_ARGS_NONE());
   mrb_define_method(mrb, gsl, "basis", mrb_vector_basis, MRB_ARGS_REQ(1));
 
   mrb_define_method(mrb, gsl, "initialize", mrb_vector_initialize,
                     MRB_ARGS_NONE());
+  mrb_define_class_method(mrb, gsl, "[]", mrb_vector_s_new_from,
+                          MRB_ARGS_ANY());
+  mrb_define_method(mrb, gsl, "length", mrb_vector_length, MRB_ARGS_NONE());
+  mrb_define_method(mrb, gsl, "size", mrb_vector_length, MRB_ARGS_NONE());
   mrb_define_method(mrb, gsl, "rnd_fill", mrb_vector_rnd_fill,
-                    MRB_ARGS_NONE());
+                    MRB_ARGS_OPT(1));
   mrb_define_method(mrb, gsl, "dup", mrb_vector_dup, MRB_ARGS_NONE());
   mrb_define_method(mrb, gsl, "===", mrb_vector_equal, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, gsl, "[]", mrb_vector_get_i, MRB_ARGS_REQ(1));
@@ -491,6 +910,18 @@ void mrb_gsl_vector_init(mrb_state *mrb) {
   mrb_define_method(mrb, gsl, "sub!", mrb_vector_sub, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, gsl, "mul!", mrb_vector_mul, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, gsl, "div!", mrb_vector_div, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "+", mrb_vector_plus, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "-", mrb_vector_minus, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "*", mrb_vector_times, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "/", mrb_vector_over, MRB_ARGS_REQ(1));
+  mrb_define_method(mrb, gsl, "add_into", mrb_vector_add_into,
+                    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, gsl, "sub_into", mrb_vector_sub_into,
+                    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, gsl, "mul_into", mrb_vector_mul_into,
+                    MRB_ARGS_REQ(2));
+  mrb_define_method(mrb, gsl, "div_into", mrb_vector_div_into,
+                    MRB_ARGS_REQ(2));
   mrb_define_method(mrb, gsl, "^", mrb_vector_prod, MRB_ARGS_REQ(1));
   mrb_define_method(mrb, gsl, "norm", mrb_vector_norm, MRB_ARGS_NONE());
   mrb_define_method(mrb, gsl, "sum", mrb_vector_sum, MRB_ARGS_NONE());
@@ -501,5 +932,19 @@ void mrb_gsl_vector_init(mrb_state *mrb) {
   mrb_define_method(mrb, gsl, "variance", mrb_vector_variance, MRB_ARGS_OPT(1));
   mrb_define_method(mrb, gsl, "sd", mrb_vector_sd, MRB_ARGS_OPT(1));
   mrb_define_method(mrb, gsl, "absdev", mrb_vector_absdev, MRB_ARGS_OPT(1));
-  mrb_define_method(mrb, gsl, "quantile", mrb_vector_quantile, MRB_ARGS_OPT(1));
+  mrb_define_method(mrb, gsl, "quantile", mrb_vector_quantile, MRB_ARGS_OPT(2));
+  mrb_define_method(mrb, gsl, "quantiles", mrb_vector_quantiles,
+                    MRB_ARGS_ARG(1, 1));
+
+  mrb_define_method(mrb, gsl, "subvector", mrb_vector_subvector,
+                    MRB_ARGS_ARG(2, 1));
+
+  mrb_define_method(mrb, gsl, "each", mrb_vector_each, MRB_ARGS_BLOCK());
+
+
+  // Views alias the storage of a parent Vector or Matrix
+  mrb_gsl_vector_view_class =
+      mrb_define_class(mrb, "VectorView", mrb_gsl_vector_class);
+  MRB_SET_INSTANCE_TT(mrb_gsl_vector_view_class, MRB_TT_DATA);
+  mrb_undef_class_method(mrb, mrb_gsl_vector_view_class, "new");
 }
@@ -43,6 +43,11 @@
 
 #define E_VECTOR_ERROR (mrb_class_get(mrb, "VectorError"))
 
+// Vector and VectorView classes, cached at gem init
+extern const struct mrb_data_type vector_data_type;
+extern struct RClass *mrb_gsl_vector_class;
+extern struct RClass *mrb_gsl_vector_view_class;
+
 /***********************************************\
  VECTORS
 \***********************************************/
@@ -52,9 +57,44 @@
 // Check it with GC.start
 void vector_destructor(mrb_state *mrb, void *p_);
 
-// Utility function for getting the struct out of the wrapping IV @data
+// Utility function for getting the struct out of self (an MRB_TT_DATA object)
 void mrb_vector_get_data(mrb_state *mrb, mrb_value self, gsl_vector **data);
 
+// Fast allocation of a new Vector of size n, bypassing #initialize.
+// Content is NOT zeroed: the caller must fill it up.
+mrb_value mrb_gsl_vector_new_uninit(mrb_state *mrb, mrb_int n);
+
+// Wrap a gsl_vector_view into a new VectorView, aliasing the storage of
+// parent. The parent object is kept alive for as long as the view is.
+mrb_value mrb_gsl_vector_view_new(mrb_state *mrb, mrb_value parent,
+                                  gsl_vector_view view);
+
+// Numeric value of v as a double: Floats and Fixnums are read directly,
+// anything else is converted with #to_f
+double mrb_gsl_to_f(mrb_state *mrb, mrb_value v);
+
+// Must be called by every method that writes into a Vector or a Matrix: it
+// drops the cached LU factorization (@lu) of self and, for views, of each
+// parent up the chain, since they share the written storage.
+void mrb_gsl_touch(mrb_state *mrb, mrb_value self);
+
+// Whether the doubles [a, a + na) and [b, b + nb) overlap. With the spans
+// below, it tells whether an output shares storage with an operand, views
+// at any offset or stride included
+mrb_bool mrb_gsl_overlap(const double *a, size_t na, const double *b,
+                         size_t nb);
+
+// Number of doubles from the first element of v (or m) to its last one
+size_t mrb_gsl_vector_span(const gsl_vector *v);
+size_t mrb_gsl_matrix_span(const gsl_matrix *m);
+
+// Element-wise kernel shared by Vector and Matrix: for i in 0...n,
+// out[i*so] = a[i*sa] <op> b[i*sb], with op one of '+', '-', '*', '/'.
+// A scalar operand is passed as b = &k and sb = 0. out may alias a or b.
+void mrb_gsl_elementwise(char op, size_t n, double *out, size_t so,
+                         const double *a, size_t sa, const double *b,
+                         size_t sb);
+
 void mrb_gsl_vector_init(mrb_state *mrb);
 
 #endif // VECTOR_H
\ No newline at end of file
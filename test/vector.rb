@@ -4,6 +4,13 @@ assert('Vector#to_a') do
   assert_equal(ary) { vec.to_a }
 end
 
+assert('Vector#size') do
+  vec = Vector.new(4)
+  assert_equal(4) { vec.size }
+  assert_equal(4) { vec.length }
+  assert_equal([]) { vec.instance_variables }
+end
+
 assert('Vector#[]') do
   vec = Vector[1,2,3]
   assert_equal(2) { vec[1] }
@@ -34,6 +41,25 @@ assert('Vector#*') do
   assert_equal(Vector[3,4,3]) {v1 * v2}
 end
 
+assert('Vector#dup') do
+  v1 = Vector[1,2,3]
+  v2 = v1.dup
+  v2[0] = 5
+  assert_equal([1,2,3]) { v1.to_a }
+  assert_equal([5,2,3]) { v2.to_a }
+end
+
+assert('Vector#add_into') do
+  v1 = Vector[1,2,3]
+  v2 = Vector[3,2,1]
+  out = Vector.new(3)
+  assert_true(v1.add_into(v2, out).equal?(out))
+  assert_equal([4,4,4]) { out.to_a }
+  v1.sub_into(1, out)
+  assert_equal([0,1,2]) { out.to_a }
+  assert_raise(VectorError) { v1.add_into(v2, Vector.new(2)) }
+end
+
 assert('Vector#each_with_index') do
   ary = [1,2,3]
   vec = Vector[*ary]
@@ -43,6 +69,12 @@ assert('Vector#each_with_index') do
 end
 
 
+assert('Matrix#size') do
+  m = Matrix.new(2, 3)
+  assert_equal([2, 3]) { m.size }
+  assert_equal("%10.3f") { m.format }
+end
+
 assert('Matrix#^') do
   m1 = Matrix[[1,2,3],[4,5,6]]
   m2 = Matrix[[1,2],[3,4],[5,6]]
@@ -51,6 +83,67 @@ assert('Matrix#^') do
   assert_true((m1 ^ m2) === Matrix[[22, 28], [49, 64]])
 end
 
+assert('Matrix#mmul_into') do
+  m1 = Matrix[[1,2,3],[4,5,6]]
+  m2 = Matrix[[1,2],[3,4],[5,6]]
+  out = Matrix.new(2, 2)
+  m1.mmul_into(m2, out)
+  assert_true(out === Matrix[[22, 28], [49, 64]])
+  vout = Vector.new(2)
+  m1.mmul_into(Vector[1,2,3], vout)
+  assert_equal([14, 32]) { vout.to_a }
+  assert_raise(MatrixError) { m1.mmul_into(m2, Matrix.new(3, 3)) }
+  sq = Matrix[[1,2],[3,4]]
+  assert_raise(MatrixError) { sq.mmul_into(Vector[1,1], sq.row_view(1)) }
+  big = Matrix.new(4, 4)
+  a = big.submatrix(0, 0, 2, 2)
+  assert_raise(MatrixError) { a.mmul_into(sq, big.submatrix(1, 1, 2, 2)) }
+  t = Matrix.new(3, 2)
+  m1.transpose_into(t)
+  assert_true(t === m1.t)
+end
+
+assert('Matrix * Vector') do
+  m = Matrix[[1,2],[-3,1]]
+  assert_equal([11, -5]) { (m * Vector[3,4]).to_a }
+  assert_equal([2, 2]) { (m * 2).size }
+end
+
+assert('Matrix#t') do
+  m = Matrix[[1,2,3],[4,5,6]]
+  assert_true(m.t === Matrix[[1,4],[2,5],[3,6]])
+end
+
+assert('Matrix views') do
+  m = Matrix[[1,2,3],[4,5,6],[7,8,9]]
+  assert_equal([4,5,6]) { m.row_view(1).to_a }
+  assert_equal([2,5,8]) { m.col_view(1).to_a }
+  assert_equal([1,5,9]) { m.diagonal.to_a }
+  assert_equal([2,6]) { m.diagonal(1).to_a }
+  m.row_view(0).mul! 10
+  assert_equal(20) { m[0,1] }
+  s = m.submatrix(1, 1, 2, 2)
+  assert_true(s === Matrix[[5,6],[8,9]])
+  s.add! 1
+  assert_equal(10) { m[2,2] }
+  assert_equal(-3) { LUDecomp.new(s).det.round }
+end
+
+assert('Vector#subvector') do
+  v = Vector[0,1,2,3,4,5]
+  sv = v.subvector(1, 3, 2)
+  assert_equal([1,3,5]) { sv.to_a }
+  sv.all 0
+  assert_equal([0,0,2,0,4,0]) { v.to_a }
+end
+
+assert('LUDecomp#solve_into') do
+  lu = Matrix[[1,2],[-3,1]].lu
+  x = Vector.new(2)
+  lu.solve_into(Vector[3,-7], x)
+  assert_true((x - lu.solve(Vector[3,-7])).norm < 1E-12)
+end
+
 assert('LUDecomp#inv') do
   m1 = Matrix[[1,2],[4,5]]
   a = [-5/3,2/3,4/3,-1/3]
@@ -59,3 +152,472 @@ assert('LUDecomp#inv') do
     assert_true((a[i] - e) < 1E-9)
   end
 end
+
+assert('BLAS level 1-2') do
+  y = Vector[1,2,3]
+  y.axpy!(2, Vector[1,1,1])
+  assert_equal([3,4,5]) { y.to_a }
+  assert_equal([6,8,10]) { y.scal!(2).to_a }
+  y = Vector[0,0]
+  y.gemv!(1, Matrix[[1,2],[3,4]], Vector[1,1], 0, trans: true)
+  assert_equal([4,6]) { y.to_a }
+  m = Matrix[[1,2],[3,4]]
+  assert_raise(VectorError) { m.row_view(0).gemv!(1, m, Vector[1,1], 0) }
+  x = Vector[1,1]
+  x.trsv!(Matrix[[2,0],[1,1]], uplo: :lower)
+  assert_equal([0.5,0.5]) { x.to_a }
+end
+
+assert('BLAS level 3') do
+  a = Matrix[[1,2],[3,4]]
+  c = Matrix.new(2,2)
+  c.gemm!(1, a, a, 0, trans_b: true)
+  assert_true(c === Matrix[[5,11],[11,25]])
+  c.gemm!(2, a, a, 1)
+  assert_true(c === Matrix[[19,31],[41,69]])
+  assert_raise(MatrixError) { c.gemm!(1, c, a, 0) }
+  big = Matrix.new(3, 3)
+  out = big.submatrix(1, 1, 2, 2)
+  assert_raise(MatrixError) { out.gemm!(1, big.submatrix(0, 0, 2, 2), a, 0) }
+  c.ger!(1, Vector[1,0], Vector[1,1])
+  assert_true(c === Matrix[[20,32],[41,69]])
+end
+
+assert('GSL.blas_backend') do
+  assert_kind_of(String, GSL.blas_backend)
+  assert_true(GSL.blas_threads >= 1)
+end
+
+assert('CholeskyDecomp') do
+  ch = Matrix[[4,2],[2,3]].chol
+  assert_equal(8) { ch.det.round }
+  assert_true((ch.solve(Vector[2,1]) - Vector[0.5,0]).norm < 1E-12)
+  assert_raise(CholeskyDecompError) { Matrix[[1,2],[2,1]].chol }
+end
+
+assert('LAPACK dispatch') do
+  m = Matrix[[2,1,1],[4,-6,0],[-2,7,2]]
+  b = Vector[5,-2,9]
+  threshold = GSL.lapack_threshold
+  GSL.lapack_threshold = 1000
+  x_gsl = m.lu.solve(b)
+  qr_gsl = m.qr.matrix
+  GSL.lapack_threshold = 0
+  lu = m.lu
+  assert_true((lu.solve(b) - x_gsl).norm < 1E-12)
+  assert_equal(-16) { lu.det.round }
+  assert_true((m.qr.matrix - qr_gsl).to_a.flatten.all? { |e| e.abs < 1E-12 })
+  GSL.lapack_threshold = threshold
+  assert_raise(ArgumentError) { GSL.lapack_threshold = -1 }
+end
+
+assert('LUDecomp#update!') do
+  lu = Matrix[[1,2],[-3,1]].lu
+  assert_true(lu.update!(Matrix[[2,0],[0,4]]).equal?(lu))
+  assert_equal(8) { lu.det.round }
+  lu.update!(Matrix[[1,0,0],[0,2,0],[0,0,3]])
+  assert_equal(3) { lu.size }
+  qr = Matrix[[1,2],[3,1],[5,9]].qr
+  qr.update!(Matrix[[1,2],[-3,1]])
+  assert_true((qr.solve(Vector[3,-7]) - lu.update!(Matrix[[1,2],[-3,1]]).solve(Vector[3,-7])).norm < 1E-12)
+  ch = Matrix[[4,2],[2,3]].chol
+  assert_raise(CholeskyDecompError) { ch.update!(Matrix[[1,2],[2,1]]) }
+  assert_raise(RuntimeError) { ch.solve(Vector[1,1]) }
+  ch.update!(Matrix[[4,2],[2,3]])
+  assert_true((ch.solve(Vector[8,7]) - Vector[1.25,1.5]).norm < 1E-12)
+end
+
+assert('Decompositions with multiple right hand sides') do
+  m = Matrix[[2,1,1],[4,-6,0],[-2,7,2]]
+  b = Matrix[[5,1],[-2,0],[9,3]]
+  lu = m.lu
+  x = lu.solve(b)
+  2.times do |j|
+    assert_true((x.col(j) - lu.solve(b.col(j))).norm < 1E-12)
+  end
+  assert_true((m.qr.solve(b) - x).to_a.flatten.all? { |e| e.abs < 1E-12 })
+  lu.solve!(b)
+  assert_true((b - x).to_a.flatten.all? { |e| e.abs < 1E-12 })
+  tall = Matrix[[1,2],[3,1],[5,9]]
+  qr = tall.qr
+  xs = qr.lssolve(Matrix[[7,1],[-3,0],[8,2]])
+  assert_true((xs.col(0) - qr.lssolve(Vector[7,-3,8])).norm < 1E-12)
+  ch = Matrix[[4,2],[2,3]].chol
+  assert_true((ch.solve(Matrix[[2,4],[1,2]]).col(1) - Vector[1,0]).norm < 1E-12)
+end
+
+assert('Matrix LU cache') do
+  m = Matrix[[1,2],[-3,1]]
+  assert_equal(7) { m.det.round }
+  assert_true((m.inv - m.lu.inv).to_a.flatten.all? { |e| e.abs < 1E-12 })
+  assert_true((m.solve(Vector[3,-7]) - m.lu.solve(Vector[3,-7])).norm < 1E-12)
+  m[0,0] = 2
+  assert_equal(8) { m.det.round }
+  m.row_view(1).mul! 2
+  assert_equal(16) { m.det.round }
+  m.swap_rows(0, 1)
+  assert_equal(-16) { m.det.round }
+  m.map! { |e| e * 2 }
+  assert_equal(-64) { m.det.round }
+end
+
+assert('Native conversions') do
+  v = Vector[1, 2.5, 3]
+  assert_equal([1, 2.5, 3]) { v.to_a }
+  m = Matrix.from_rows([v, [4, 5, 6]])
+  assert_equal([[1, 2.5, 3], [4, 5, 6]]) { m.to_a }
+  assert_equal([3, 1]) { v.to_mat.size }
+  assert_equal([4, 5, 6]) { m.submatrix(1, 0, 1, 3).to_a[0] }
+  assert_raise(ArgumentError) { Matrix[[1, 2], [3]] }
+  assert_raise(ArgumentError) { Matrix.from_rows([1, 2]) }
+end
+
+assert('Binary strings') do
+  v = Vector[1, -2.5, 3]
+  s = v.to_bytes
+  assert_equal(24) { s.size }
+  assert_true(Vector.from_bytes(s) === v)
+  assert_true(Vector.from_bytes(v.to_bytes(:f32), :f32) === v)
+  m = Matrix[[1,2,3],[4,5,6],[7,8,9]]
+  sub = m.submatrix(1, 1, 2, 2)
+  assert_true(Matrix.from_bytes(sub.to_bytes, 2, 2) === Matrix[[5,6],[8,9]])
+  sub.load_bytes!(Matrix[[0,0],[0,1]].to_bytes)
+  assert_equal([[1,2,3],[4,0,0],[7,0,1]]) { m.to_a }
+  assert_raise(ArgumentError) { Matrix.from_bytes(s, 2, 2) }
+  # (2**61 + 1) * 1 * 8 wraps around to 8 bytes in 64 bits
+  assert_raise(ArgumentError) { Matrix.from_bytes("\0" * 8, (1 << 61) + 1, 1) }
+end
+
+assert('Memory-mapped Matrix and Vector') do
+  path = "/tmp/mruby-gsl-test.mat"
+  m = Matrix.mmap(path, 2, 3, "w")
+  assert_kind_of(MatrixView, m)
+  m.set_row(1, Vector[4,5,6])
+  m.parent.sync
+  r = Matrix.mmap(path)
+  assert_equal([2, 3]) { r.size }
+  assert_equal([[0,0,0],[4,5,6]]) { r.to_a }
+  r[0,0] = 1
+  assert_equal(0) { Matrix.mmap(path, "r+")[0,0] }
+  assert_raise(MmapError) { Matrix.mmap(path, 3, 3) }
+  assert_raise(MmapError) { Vector.mmap(path) }
+  assert_raise(MmapError) { Matrix.mmap(path, 0, 3, "w") }
+  assert_raise(MmapError) { Matrix.mmap(path, 1 << 40, 1 << 40, "w") }
+  assert_equal([[0,0,0],[4,5,6]]) { Matrix.mmap(path).to_a }
+  File.delete(path)
+end
+
+assert('Shared memory seqlock') do
+  name = "/mruby-gsl-test"
+  w = Vector.shm(name, 3)
+  r = Vector.shm(name)
+  seq = w.seq
+  w.publish! { |v| v.all 2 }
+  assert_equal(seq + 1) { r.seq }
+  assert_equal([2,2,2]) { r.read_consistent { |v| v.to_a } }
+  assert_raise(RuntimeError) { w.publish! { raise "fail" } }
+  assert_equal(seq + 2) { r.seq }
+  GSL.shm_unlink(name)
+  assert_raise(MmapError) { Vector[1,2].publish! { } }
+end
+
+assert('Native iterators') do
+  m = Matrix[[1,2],[3,4]]
+  idx = []
+  m.each_with_indexes { |e, i, j| idx << [e, i, j] }
+  assert_equal([[1,0,0],[2,0,1],[3,1,0],[4,1,1]]) { idx }
+  assert_equal([2,4,6,8]) { m.dup.map! { |e| e * 2 }.to_a.flatten }
+  g = m.dup
+  assert_raise(MatrixError) { g.map! { |e| g.send(:initialize, 1, 1); e } }
+  n = 0
+  g = m.dup
+  g.each { |e| n += 1; g.send(:initialize, 1, 1) }
+  assert_equal(1) { n }
+  rows = []
+  m.each_row { |r, i| rows << r.dup }
+  assert_equal([[1,2],[3,4]]) { rows.map { |r| r.to_a } }
+  cols = []
+  m.each_col { |c, j| cols << c.to_a }
+  assert_equal([[1,3],[2,4]]) { cols }
+  b = Buffer.new(3)
+  b << 1; b << 2; b << 3; b << 4
+  assert_equal([2,3,4]) { b.map { |e| e } }
+  assert_raise(ArgumentError) { Vector[1].each }
+end
+
+assert('Elementwise math') do
+  v = Vector[-2, 0.25, 4]
+  assert_equal([2, 0.25, 4]) { v.abs.to_a }
+  assert_equal([-2, 0.25, 4]) { v.to_a }
+  assert_equal([-1, 1, 1]) { v.sign.to_a }
+  assert_equal([0, 0.25, 1]) { v.clamp(0, 1).to_a }
+  assert_equal([4, 0.0625, 16]) { v.dup.pow!(2).to_a }
+  assert_equal([-1, 1.25, 9]) { v.fma(Vector[1, 1, 2], 1).to_a }
+  m = Matrix[[1, 4], [9, 16]]
+  assert_equal([3, 4]) { m.sqrt.col(1).to_a.map { |e| e.round } }
+  m.submatrix(0, 0, 2, 1).sqrt!
+  assert_equal([1, 4, 3, 16]) { m.to_a.flatten }
+  assert_raise(VectorError) { v.atan2!(Vector[1, 2]) }
+  assert_raise(ArgumentError) { v.hypot!("1") }
+end
+
+assert('Matrix axis reductions') do
+  m = Matrix[[1, 5], [3, 2], [-1, 7]]
+  assert_equal(17) { m.sum }
+  assert_equal([3, 14]) { m.sum(axis: 0).to_a }
+  assert_equal([3, 2.5, 3]) { m.mean(axis: 1).to_a }
+  assert_equal([4]) { m.variance(axis: 0).to_a[0, 1] }
+  assert_equal([5]) { Matrix[[3, 4]].norm(axis: 1).to_a }
+  assert_equal([3, 7]) { m.max(axis: 0).to_a }
+  assert_equal([-1, 2]) { m.min(axis: 0).to_a }
+  assert_equal(7) { m.max }
+  assert_equal([1, 2]) { m.argmax(axis: 0) }
+  assert_equal([0, 1, 0]) { m.argmin(axis: 1) }
+  assert_equal([2, 1]) { m.argmax }
+  assert_equal([3, 2]) { m.submatrix(0, 0, 2, 2).max(axis: 0).to_a }
+  assert_raise(ArgumentError) { m.sum(axis: 2) }
+end
+
+assert('RNG') do
+  a = RNG.new(seed: 42)
+  b = RNG.new(type: a.name, seed: 42)
+  v, w = Vector.new(5), Vector.new(5)
+  assert_equal(a.uniform!(v).to_a) { b.uniform!(w).to_a }
+  s = a.state
+  x = a.gaussian!(Vector.new(3), 2, 10).to_a
+  a.state = s
+  assert_equal(x) { a.gaussian!(Vector.new(3), 2, 10).to_a }
+  assert_equal(x) { b.dup.gaussian!(Vector.new(3), 2, 10).to_a }
+  m = a.bernoulli!(Matrix.new(4, 4), 0.5)
+  assert_true(m.to_a.flatten.all? { |e| e == 0 || e == 1 })
+  assert_true(a.uniform!(v, 2, 3).to_a.all? { |e| e >= 2 && e < 3 })
+  assert_not_equal(Vector.new(3).rnd_fill.to_a) { Vector.new(3).rnd_fill.to_a }
+  assert_raise(RNGError) { RNG.new(type: :nope) }
+  assert_raise(RNGError) { RNG.new(type: :taus2).state = s }
+end
+
+assert('Vector quantiles by selection') do
+  v = Vector[9, 1, 8, 2, 7, 3, 6, 4, 5, 0]
+  assert_equal(4.5) { v.median }
+  assert_equal(0.9) { v.quantile(0.1) }
+  assert_equal([0, 4.5, 9]) { v.quantiles([0, 0.5, 1]) }
+  assert_equal([9, 1, 8, 2, 7, 3, 6, 4, 5, 0]) { v.to_a }
+  w = Vector.new(200).rnd_fill
+  s = Vector.new(300)
+  sorted = w.to_a.sort
+  assert_equal(sorted[0]) { w.quantile(0, s) }
+  assert_equal([sorted[0], sorted[199]]) { w.quantiles([0, 1], s) }
+  assert_raise(VectorError) { v.quantile(1.5) }
+  assert_raise(VectorError) { v.median(Vector.new(3)) }
+  big = Vector.new(20)
+  assert_raise(VectorError) { big.subvector(0, 10).median(big.subvector(5, 15)) }
+end
+
+assert('Buffer') do
+  b = Buffer.new(4)
+  assert_equal(0) { b.max }
+  [3, 1, 4, 1, 5].each { |e| b << e }
+  assert_equal([1, 4, 1, 5]) { b.to_a }
+  assert_equal([1, 4, 1, 5]) { b.to_vector.to_a }
+  assert_equal(1) { b.head }
+  assert_equal(5) { b[-1] }
+  assert_equal(11) { b.sum }
+  assert_equal(2.75) { b.mean }
+  assert_equal(Vector[1, 4, 1, 5].variance) { b.variance }
+  assert_equal([5, 1]) { [b.max, b.min] }
+  b.push_many(Vector[9, 2])
+  assert_equal([1, 5, 9, 2]) { b.to_a }
+  assert_equal([9, 1]) { [b.max, b.min] }
+  b.push_many(Vector[6, 5, 3, 5, 8])
+  assert_equal([5, 3, 5, 8]) { b.to_a }
+  assert_equal(3) { b.min }
+  b.mul!(2)
+  assert_equal([16, 6]) { [b.max, b.min] }
+  b[0] = -1
+  assert_equal([-1, 6, 10, 16]) { b.to_a }
+  assert_equal(31) { b.sum }
+  assert_raise(VectorError) { b[4] }
+  b << 3
+  assert_equal([6, 10, 16, 3]) { b.dup.to_a }
+  assert_equal(2) { b.max_index }
+  assert_equal([7, 12, 19, 7]) { (b + Vector[1, 2, 3, 4]).to_a }
+  assert_equal(Vector[6, 10, 16, 3].to_bytes) { b.to_bytes }
+  assert_equal(0) { b.head }
+  b << 1
+  assert_equal([10, 16, 3, 1]) { b.to_a }
+  assert_equal(30) { b.sum }
+  assert_equal([16, 1]) { [b.max, b.min] }
+end
+
+assert('RunningStats') do
+  v = Vector[2, 4, 4, 4, 5, 5, 7, 9]
+  rs = RunningStats.new
+  rs.push_vector(v)
+  assert_equal(8) { rs.count }
+  assert_equal(5) { rs.mean }
+  assert_true((rs.variance - v.variance).abs < 1e-12)
+  assert_equal([2, 9]) { [rs.min, rs.max] }
+  a = RunningStats.new << 2 << 4 << 4 << 4
+  b = RunningStats.new
+  b.push_vector([5, 5, 7, 9])
+  a.merge(b)
+  assert_equal(8) { a.count }
+  assert_true((a.variance - v.variance).abs < 1e-12)
+  assert_true((a.sd - rs.sd).abs < 1e-12)
+  assert_equal(2) { RunningStats.new.push_vector([3, 1, 2]).median }
+  q = RunningStats.new(quantiles: [0.1, 0.9])
+  q.push_vector(Vector.new(10000).rnd_fill)
+  assert_true((q.quantile(0.9) - 0.9).abs < 0.02)
+  assert_equal(2) { q.quantiles.size }
+  assert_raise(ArgumentError) { q.median }
+  assert_raise(ArgumentError) { a.merge(q) }
+  assert_equal(0) { a.reset.count }
+end
+
+assert('MovingWindow') do
+  v = Vector[1, 9, 2, 3, 8, 4, 5]
+  assert_equal([1, 2, 3, 3, 4, 5, 5]) { v.moving_median(3).to_a }
+  assert_equal([1, 1, 2, 2, 3, 4, 4]) { v.moving_min(3).to_a }
+  min, max = v.moving_minmax(3)
+  assert_equal(v.moving_max(3).to_a) { max.to_a }
+  assert_equal(v.moving_min(3).to_a) { min.to_a }
+  w = MovingWindow.new(3)
+  assert_equal([10, 12, 14, 13, 15, 17, 9]) { v.moving_sum(w, ends: :pad_zero).to_a }
+  m = v.moving_mean(w, ends: :truncate) - Vector[5, 4, 14.0 / 3, 13.0 / 3, 5, 17.0 / 3, 4.5]
+  assert_true(m.to_a.all? { |e| e.abs < 1e-12 })
+  b = Buffer.new(3)
+  b.push_many([7, 1, 9, 2])
+  assert_equal([1, 2, 2]) { b.moving_median(3).to_a }
+  f = MovingWindow.new(3, stat: :median)
+  assert_equal([2, 3, 3, 4, 5]) { v.to_a.map { |x| f << x }[2..-1] }
+  assert_equal(3) { f.count }
+  f = MovingWindow.new(2, stat: :minmax)
+  assert_equal([1, 9]) { (f << 1; f << 9) }
+  assert_equal([2, 9]) { f << 2 }
+  assert_equal(0) { f.reset.count }
+  assert_raise(ArgumentError) { w << 1 }
+  assert_raise(ArgumentError) { v.moving_mean(3, ends: :wrap) }
+end
+
+assert('Filter') do
+  fir = Filter.new([0.5, 0.5])
+  assert_equal([0.5, 1.5, 2.5, 3.5]) { fir.filter!(Vector[1, 2, 3, 4]).to_a }
+  assert_equal(5) { fir.step(6) }
+  assert_equal(1) { fir.order }
+  r = Vector[1, 2, 3, 4, 5, 6, 7, 8]
+  assert_true((fir.filtfilt(r) - r).to_a.all? { |e| e.abs < 1e-12 })
+  assert_raise(ArgumentError) { fir.filtfilt(Vector[1, 2, 3, 4, 5, 6]) }
+  assert_equal(0.5) { fir.reset.step(1) }
+  b = Buffer.new(3)
+  [1, 2, 3, 4].each { |e| b << e }
+  assert_equal([1, 2.5, 3.5]) { fir.reset.filter(b).to_a }
+  assert_raise(ArgumentError) { fir.filter!(b) }
+  sos = Matrix[[1, 0, 0, 2, -1, 0], [0.5, 0, 0, 1, -0.5, 0]]
+  iir = Filter.new(sos: sos)
+  assert_equal(2) { Filter.new(sos: Matrix[[1, 0, 0, 2, -1, 0]]).order }
+  v = Vector[1, 1]
+  assert_equal([0.25, 0.5]) { iir.filter(v).to_a }
+  assert_equal([1, 1]) { v.to_a }
+  assert_equal(0.25) { iir.reset.step(1) }
+  c = iir.filtfilt(Vector.new(16).all(2))
+  assert_raise(ArgumentError) { iir.filtfilt(Vector.new(15).all(2)) }
+  assert_true(c.to_a.all? { |e| (e - 2).abs < 1e-12 })
+  assert_raise(ArgumentError) { Filter.new(sos: Matrix.new(2, 5)) }
+  assert_raise(ArgumentError) { Filter.new([]) }
+end
+
+assert('FFT') do
+  x = Vector[1, 2, 3, 4, 0, -1, 2, 5]
+  [8, 6].each do |n|
+    v = Vector.new(n)
+    n.times { |i| v[i] = x[i] }
+    fft = FFT.new(n)
+    assert_equal(n == 8) { fft.radix2? }
+    hc = fft.forward(v)
+    assert_true((hc[0] - v.to_a.inject(:+)).abs < 1e-12)
+    assert_true((fft.inverse(hc) - v).to_a.all? { |e| e.abs < 1e-12 })
+    alt = 0
+    n.times { |i| alt += i.even? ? v[i] : -v[i] }
+    assert_true((hc[n - 1] - alt).abs < 1e-12)
+    u = fft.unpack(hc)
+    assert_equal(2 * n) { u.size }
+    assert_true((u[2] - u[2 * n - 2]).abs < 1e-12)
+    assert_true((u[3] + u[2 * n - 1]).abs < 1e-12)
+    ps = fft.power_spectrum(v)
+    assert_equal(n / 2 + 1) { ps.size }
+    assert_true((ps[1] - (u[2] ** 2 + u[3] ** 2)).abs < 1e-9)
+    fft.forward_into(v, v)
+    assert_true((v - hc).to_a.all? { |e| e.abs < 1e-12 })
+  end
+  assert_raise(FFTError) { FFT.new(4).forward(Vector.new(5)) }
+  b = Buffer.new(4)
+  [9, 1, 2, 3, 4].each { |e| b << e }
+  fft = FFT.new(4)
+  assert_true((fft.forward(b) - fft.forward(Vector[1, 2, 3, 4])).norm < 1e-12)
+  assert_raise(ArgumentError) { fft.forward_into(b, b) }
+end
+
+assert('Vector#convolve') do
+  a = Vector[1, 2, 3, 4, 5]
+  b = Vector[1, 0, -1]
+  assert_equal([1, 2, 2, 2, 2, -4, -5]) { a.convolve(b).to_a }
+  assert_equal([-1, -2, -2, -2, -2, 4, 5]) { a.correlate(b).to_a }
+  c = a.convolve(b, method: :fft) - a.convolve(b)
+  assert_true(c.to_a.all? { |e| e.abs < 1e-12 })
+  x = Vector.new(200).rnd_fill
+  y = Vector.new(100).rnd_fill
+  c = x.correlate(y) - x.correlate(y, method: :direct)
+  assert_true(c.to_a.all? { |e| e.abs < 1e-9 })
+  assert_raise(ArgumentError) { a.convolve(b, method: :fast) }
+  r = Buffer.new(3)
+  [7, 1, 0, -1].each { |e| r << e }
+  assert_equal([1, 2, 2, 2, 2, -4, -5]) { a.convolve(r).to_a }
+end
+
+assert('ComplexVector') do
+  z = ComplexVector[[1, 2], [3, -1], 2]
+  assert_equal(3) { z.size }
+  assert_equal([3, -1]) { z[1] }
+  assert_equal([[1, -2], [3, 1], [2, 0]]) { z.conj.to_a }
+  assert_equal([[-2, 1], [1, 3], [0, 2]]) { (z * [0, 1]).to_a }
+  assert_equal([[1, 0], [1, 0], [1, 0]]) { (z / z).to_a }
+  assert_equal([[2, 2], [5, -1], [5, 0]]) { (z + Vector[1, 2, 3]).to_a }
+  assert_true((z.abs[1] - Math.sqrt(10)).abs < 1e-12)
+  assert_equal(Math::PI / 2) { ComplexVector[[0, 1]].arg[0] }
+  assert_equal([19, 0]) { z.dotc(z) }
+  assert_equal([9, -2]) { z.dotu(z) }
+  z.real[0] = 7
+  assert_equal([7, 2]) { z[0] }
+  assert_equal([2, -1, 0]) { z.imag.to_a }
+  assert_true(ComplexVector.from_bytes(z.to_bytes) === z)
+  assert_equal([[1, 3], [2, 4]]) { Vector[1, 2].to_complex(Vector[3, 4]).to_a }
+  assert_raise(VectorError) { z + ComplexVector.new(2) }
+  assert_raise(ArgumentError) { z.add!("1") }
+end
+
+assert('ComplexMatrix') do
+  a = Matrix[[1, 2], [3, 4]].to_complex(Matrix[[0, 1], [1, 0]])
+  assert_equal([2, 2]) { a.size }
+  b = ComplexMatrix.new(2, 2).identity.mul!([0, 1])
+  assert_true((a ^ b) === a * [0, 1])
+  assert_equal([3, -1]) { a.h[0, 1] }
+  assert_equal([3, 1]) { a.t[0, 1] }
+  assert_equal([[0, 2], [3, 5]]) { (a ^ ComplexVector[1, [0, 1]]).to_a }
+  c = ComplexMatrix.new(2, 2)
+  c.gemm!(1, a, a, 0, trans_a: :conj)
+  assert_true((c - (a.h ^ a)).abs.to_a.flatten.all? { |e| e < 1e-12 })
+  assert_raise(MatrixError) { c.gemm!(1, c, a, 0) }
+  assert_true(a.real === Matrix[[1, 2], [3, 4]])
+  assert_true(ComplexMatrix.from_bytes(a.to_bytes, 2, 2) === a)
+  assert_raise(ArgumentError) { ComplexMatrix.from_bytes("\0" * 16, (1 << 60) + 1, 1) }
+  assert_raise(MatrixError) { a ^ ComplexMatrix.new(3, 1) }
+end
+
+assert('FFT#forward_complex') do
+  v = Vector[1, 2, 3, 4, 0, -1]
+  fft = FFT.new(6)
+  z = fft.forward_complex(v)
+  assert_equal([9, 0]) { z[0] }
+  assert_true((z[1][1] + z[5][1]).abs < 1e-12)
+  assert_true((fft.inverse_complex(z) - v).to_a.all? { |e| e.abs < 1e-12 })
+end